@@ -0,0 +1,137 @@
+// 子进程启动延迟和输出吞吐量的微基准：ProcessManager（posix_spawn +
+// 64 KiB读取）对比fork + execvp + 128字节读取的朴素实现。
+//
+//   spawn_bench [--iterations N] [--ballast-mb M] [--output-mb S]
+//
+// --ballast-mb让父进程先占用M MiB常驻内存：fork的开销随父进程的页表增长，
+// posix_spawn（vfork）则不受影响
+#define main sln2code_main
+#include "main.cpp"
+#undef main
+
+namespace {
+
+struct Options {
+  int iterations = 200;
+  size_t ballast_mb = 512;
+  size_t output_mb = 64;
+};
+
+// 朴素实现：fork + execvp，管道每次读128字节
+std::string fork_exec(const std::vector<std::string> &args) {
+  std::vector<char *> argv;
+  for (const auto &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  int fds[2];
+  if (pipe(fds) != 0) {
+    throw std::runtime_error("pipe failed");
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  close(fds[1]);
+  std::string out;
+  char buffer[128];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    out.append(buffer, static_cast<size_t>(n));
+  }
+  close(fds[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return out;
+}
+
+std::string process_manager(const std::vector<std::string> &args) {
+  return ProcessManager::instance().run(args).out;
+}
+
+// 每次调用的平均毫秒数
+template <typename F> double measure(int iterations, F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    f();
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         iterations;
+}
+
+Options parse_options(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string flag = argv[i];
+    unsigned long value = std::stoul(argv[i + 1]);
+    if (flag == "--iterations") {
+      options.iterations = static_cast<int>(std::max(1ul, value));
+    } else if (flag == "--ballast-mb") {
+      options.ballast_mb = value;
+    } else if (flag == "--output-mb") {
+      options.output_mb = std::max(1ul, value);
+    } else {
+      throw std::invalid_argument("unknown option " + flag);
+    }
+  }
+  return options;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\nusage: spawn_bench [--iterations N] "
+                             "[--ballast-mb M] [--output-mb S]\n";
+    return 2;
+  }
+
+  // 写满页面，确保内存真正常驻
+  std::vector<char> ballast(options.ballast_mb << 20, 1);
+
+  const fs::path data = fs::temp_directory_path() /
+                        ("spawn-bench-" + std::to_string(getpid()) + ".bin");
+  {
+    std::ofstream file(data, std::ios::binary);
+    std::string block(1 << 20, 'x');
+    for (size_t i = 0; i < options.output_mb; i++) {
+      file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+  }
+
+  const std::vector<std::string> spawn_args = {"true"};
+  const std::vector<std::string> cat_args = {"cat", data.string()};
+  const int cat_iterations = std::max(1, options.iterations / 40);
+  std::cout << std::fixed << std::setprecision(3)
+            << "parent resident ballast: " << options.ballast_mb << " MiB\n";
+
+  double fork_spawn = measure(options.iterations, [&] { fork_exec(spawn_args); });
+  double pm_spawn =
+      measure(options.iterations, [&] { process_manager(spawn_args); });
+  std::cout << "spawn latency (true, " << options.iterations << " runs):\n"
+            << "  fork+execvp      " << fork_spawn << " ms\n"
+            << "  ProcessManager   " << pm_spawn << " ms\n";
+
+  double fork_cat = measure(cat_iterations, [&] { fork_exec(cat_args); });
+  double pm_cat = measure(cat_iterations, [&] { process_manager(cat_args); });
+  auto throughput = [&](double ms) {
+    return static_cast<double>(options.output_mb) / (ms / 1000.0);
+  };
+  std::cout << std::setprecision(1) << "output throughput (cat "
+            << options.output_mb << " MiB, " << cat_iterations << " runs):\n"
+            << "  fork+execvp      " << throughput(fork_cat) << " MiB/s\n"
+            << "  ProcessManager   " << throughput(pm_cat) << " MiB/s\n";
+
+  std::error_code ec;
+  fs::remove(data, ec);
+  return ballast[ballast.size() / 2] == 1 ? 0 : 1;
+}
@@ -4,18 +4,21 @@
 #include <array>
 #include <atomic>
 #include <cctype>
+#include <charconv>
 #include <cerrno>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <future>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -24,6 +27,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unistd.h>
 #include <unordered_map>
@@ -36,9 +40,43 @@
 #include <process.h>
 #include <windows.h>
 #else
+#include <arpa/inet.h>
 #include <cstdio>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <spawn.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#ifdef SLN2CODE_HAVE_LIBCURL
+#include <curl/curl.h>
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SLN2CODE_JSON_SSE2
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#ifndef _WIN32
+extern char **environ;
+#endif
+#if defined(__linux__) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
 #endif
 
 namespace fs = std::filesystem;
@@ -56,6 +94,23 @@ public:
   std::vector<DirectoryNode> children;
 };
 
+// 编译器缓存配置（ccache/sccache），生成的CMake工程用它作为编译器启动器
+class CompilerCacheConfig {
+public:
+  std::string name = "auto"; // auto、ccache、sccache或none；检测后为找到的工具
+  std::string path;          // 检测到的可执行文件，未找到时为空
+  std::string dir;           // 缓存目录，为空时使用工具的默认目录
+  std::string max_size;      // 缓存大小上限，如"5G"，为空时使用工具的默认值
+};
+
+// 构建工具：找到CMake时生成的任务通过CMake增量并行构建（有Ninja时使用
+// Ninja生成器），否则直接调用编译器
+class BuildToolConfig {
+public:
+  std::string cmake; // 为空表示未找到
+  std::string ninja;
+};
+
 // 编译器配置结构
 class CompilerConfig {
 public:
@@ -65,6 +120,8 @@ public:
   std::string cStandard;
   CompilerType type = CompilerType::UNKNOWN;
   std::vector<std::string> extraArgs;
+  CompilerCacheConfig cache;
+  BuildToolConfig build_tools;
 };
 
 // 调试器配置结构
@@ -75,6 +132,13 @@ public:
   DebuggerType type = DebuggerType::UNKNOWN;
 };
 
+// 工作区配置：核心库、多个可执行程序、测试和基准程序分别作为独立目标
+class WorkspaceConfig {
+public:
+  bool enabled = false;
+  std::vector<std::string> apps; // 为空时只有一个与项目同名的程序
+};
+
 // 项目配置结构
 class ProjectConfig {
 public:
@@ -95,6 +159,104 @@ public:
   std::vector<std::string> dependencies;
   std::string configInstructions;
   std::string sha256;
+  std::vector<std::string> extractInclude; // 选择性解压时额外包含的glob
+  std::vector<std::string> extractExclude; // 选择性解压时排除的glob
+  std::vector<std::string> mirrorUrls;     // 同一压缩包的备用下载地址
+  std::string description;                 // 一句话简介，用于搜索
+  std::vector<std::string> tags;           // 分类标签，用于搜索
+  std::vector<std::string> primaryHeaders; // 主要头文件，用于指南和预编译头
+};
+
+// 编译期完美哈希表：键为string_view，构造时搜索一个使全部键落入不同槽位的
+// 种子；constexpr对象放在只读数据中，没有启动时的动态初始化。
+// 查找只做一次哈希、一次槽位读取和一次键比较
+template <typename Value, size_t N> class StaticMap {
+public:
+  struct Entry {
+    std::string_view key;
+    Value value;
+  };
+
+  constexpr explicit StaticMap(const Entry (&entries)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+      if (entries[i].key.empty()) {
+        throw std::logic_error("StaticMap: missing or empty key");
+      }
+      entries_[i] = entries[i];
+    }
+    while (!place(seed_)) {
+      ++seed_;
+    }
+  }
+
+  constexpr const Value *find(std::string_view key) const {
+    uint8_t slot = slots_[hash(key, seed_) & (kSlots - 1)];
+    return slot != 0 && entries_[slot - 1].key == key
+               ? &entries_[slot - 1].value
+               : nullptr;
+  }
+
+  constexpr const Entry *begin() const { return entries_.data(); }
+  constexpr const Entry *end() const { return entries_.data() + N; }
+  constexpr size_t size() const { return N; }
+
+private:
+  static_assert(N > 0 && N < 128, "StaticMap holds 1..127 entries");
+
+  // 不小于2N的2的幂
+  static constexpr size_t slot_count() {
+    size_t slots = 1;
+    while (slots < 2 * N) {
+      slots <<= 1;
+    }
+    return slots;
+  }
+  static constexpr size_t kSlots = slot_count();
+
+  std::array<Entry, N> entries_{};
+  std::array<uint8_t, kSlots> slots_{}; // 条目下标+1，0为空槽
+  uint32_t seed_ = 0;
+
+  // FNV-1a
+  static constexpr uint32_t hash(std::string_view key, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed * 16777619u;
+    for (char c : key) {
+      h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return h ^ (h >> 15);
+  }
+
+  constexpr bool place(uint32_t seed) {
+    slots_ = {};
+    for (size_t i = 0; i < N; ++i) {
+      uint8_t &slot = slots_[hash(entries_[i].key, seed) & (kSlots - 1)];
+      if (slot != 0) {
+        if (entries_[slot - 1].key == entries_[i].key) {
+          throw std::logic_error("StaticMap: duplicate key");
+        }
+        return false;
+      }
+      slot = static_cast<uint8_t>(i + 1);
+    }
+    return true;
+  }
+};
+
+// 内置库的编译期描述；列表字段以'\n'分隔
+struct BuiltinLibrary {
+  std::string_view name;
+  std::string_view downloadUrl;
+  std::string_view includePath;
+  std::string_view libPath;
+  std::string_view dependencies;
+  std::string_view configInstructions;
+  std::string_view sha256;
+  std::string_view extractInclude;
+  std::string_view extractExclude;
+  std::string_view mirrorUrls;
+  std::string_view description;
+  std::string_view tags;
+  std::string_view primaryHeaders;
 };
 
 // 全局常量
@@ -105,150 +267,1095 @@ const std::string DEFAULT_LIBRARY_MIRROR =
     "https://github.com/Macintosh-MaiSensei/SLN2Code";
 
 // 支持的编译器类型映射
-const std::unordered_map<std::string, CompilerType> COMPILER_TYPE_MAP = {
-    {"gcc", CompilerType::GCC},     {"g++", CompilerType::GXX},
-    {"clang", CompilerType::CLANG}, {"clang++", CompilerType::CLANGXX},
-    {"cl", CompilerType::MSVC},     {"msvc", CompilerType::MSVC}};
+constexpr StaticMap<CompilerType, 6> COMPILER_TYPE_MAP({
+    {"gcc", CompilerType::GCC},
+    {"g++", CompilerType::GXX},
+    {"clang", CompilerType::CLANG},
+    {"clang++", CompilerType::CLANGXX},
+    {"cl", CompilerType::MSVC},
+    {"msvc", CompilerType::MSVC},
+});
 
 // 支持的调试器类型映射
-const std::unordered_map<std::string, DebuggerType> DEBUGGER_TYPE_MAP = {
+constexpr StaticMap<DebuggerType, 3> DEBUGGER_TYPE_MAP({
     {"gdb", DebuggerType::GDB},
     {"lldb", DebuggerType::LLDB},
-    {"cppvsdbg", DebuggerType::CPPVSDBG}};
+    {"cppvsdbg", DebuggerType::CPPVSDBG},
+});
 
 // 内置支持的第三方库
-const std::unordered_map<std::string, ThirdPartyLibrary> BUILTIN_LIBRARIES = {
+constexpr StaticMap<BuiltinLibrary, 3> BUILTIN_LIBRARIES({
     {"glfw",
      {"GLFW",
       "https://github.com/glfw/glfw/releases/download/3.3.8/glfw-3.3.8.zip",
       "glfw-3.3.8/include",
       "glfw-3.3.8/lib",
-      {},
+      "",
       R"(在CMakeLists.txt中添加:
 target_include_directories(${PROJECT_NAME} PRIVATE "third_party/glfw-3.3.8/include")
 target_link_directories(${PROJECT_NAME} PRIVATE "third_party/glfw-3.3.8/lib")
 target_link_libraries(${PROJECT_NAME} glfw3)
 )",
-      "4d025083cc4a3dd1f91ab9b9ba4f5807193823e565a5bcf4be202669d9911ea6"}},
+      "4d025083cc4a3dd1f91ab9b9ba4f5807193823e565a5bcf4be202669d9911ea6",
+      "",
+      "",
+      "",
+      "Multi-platform library for OpenGL windows, contexts and input",
+      "graphics\nwindow\ninput\nopengl",
+      "GLFW/glfw3.h"}},
     {"boost",
      {"Boost",
       "https://archives.boost.io/release/1.89.0/source/boost_1_89_0.zip",
       "boost_1_89_0",
       "",
-      {},
+      "",
       R"(在CMakeLists.txt中添加:
 set(BOOST_ROOT "third_party/boost_1_89_0")
 find_package(Boost REQUIRED COMPONENTS system filesystem)
 target_include_directories(${PROJECT_NAME} PRIVATE ${Boost_INCLUDE_DIRS})
 target_link_libraries(${PROJECT_NAME} PRIVATE ${Boost_LIBRARIES})
 )",
-      "77bee48e32cabab96a3fd2589ec3ab9a17798d330220fdd8bde6ff5611b4ccde"}},
+      "77bee48e32cabab96a3fd2589ec3ab9a17798d330220fdd8bde6ff5611b4ccde",
+      "",
+      "boost_1_89_0/doc/**\n"
+      "boost_1_89_0/libs/**/doc/**\n"
+      "boost_1_89_0/libs/**/test/**\n"
+      "boost_1_89_0/libs/**/example/**\n"
+      "boost_1_89_0/libs/**/examples/**",
+      "",
+      "Peer-reviewed portable C++ source libraries",
+      "utility\ncontainers\nfilesystem\nnetworking",
+      "boost/filesystem.hpp"}},
     {"sdl2",
      {"SDL2",
       "https://github.com/libsdl-org/SDL/releases/download/release-2.28.5/"
       "SDL2-devel-2.28.5-VC.zip",
       "SDL2-2.28.5/include",
       "SDL2-2.28.5/lib/x64",
-      {},
+      "",
       R"(在CMakeLists.txt中添加:
 target_include_directories(${PROJECT_NAME} PRIVATE "third_party/SDL2-2.28.5/include")
 target_link_directories(${PROJECT_NAME} PRIVATE "third_party/SDL2-2.28.5/lib/x64")
 target_link_libraries(${PROJECT_NAME} SDL2 SDL2main)
 )",
-      "4ac4ba2208410b7b984759ee12e13e0606bd62032b5ddc36fb7d96b9ade78871"}}};
-} // namespace Constants
-
-// SHA256计算类
-class SHA256 {
-private:
-  static constexpr std::array<uint32_t, 64> K = {
-      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
-      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
-      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
-      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
-      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
-      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
-      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
-
-  std::array<uint32_t, 8> state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
-                                   0xa54ff53a, 0x510e527f, 0x9b05688c,
-                                   0x1f83d9ab, 0x5be0cd19};
-
-  static uint32_t rotr(uint32_t x, uint32_t n) {
-    return (x >> n) | (x << (32 - n));
-  }
-
-  static uint32_t ch(uint32_t x, uint32_t y, uint32_t z) {
-    return (x & y) ^ (~x & z);
-  }
-
-  static uint32_t maj(uint32_t x, uint32_t y, uint32_t z) {
-    return (x & y) ^ (x & z) ^ (y & z);
-  }
-
-  static uint32_t sigma0(uint32_t x) {
-    return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22);
-  }
-
-  static uint32_t sigma1(uint32_t x) {
-    return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25);
-  }
-
-  static uint32_t gamma0(uint32_t x) {
-    return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3);
-  }
-
-  static uint32_t gamma1(uint32_t x) {
-    return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10);
-  }
-
-  void transform(const uint8_t *data) {
-    std::array<uint32_t, 64> W = {0};
-
-    // 将数据分成16个32位字（大端序）
-    for (int i = 0; i < 16; i++) {
-      W[i] = (static_cast<uint32_t>(data[i * 4]) << 24) |
-             (static_cast<uint32_t>(data[i * 4 + 1]) << 16) |
-             (static_cast<uint32_t>(data[i * 4 + 2]) << 8) |
-             (static_cast<uint32_t>(data[i * 4 + 3]));
-    }
-
-    // 扩展消息
-    for (int i = 16; i < 64; i++) {
-      W[i] = gamma1(W[i - 2]) + W[i - 7] + gamma0(W[i - 15]) + W[i - 16];
-    }
+      "4ac4ba2208410b7b984759ee12e13e0606bd62032b5ddc36fb7d96b9ade78871",
+      "",
+      "",
+      "",
+      "Simple DirectMedia Layer for audio, input and graphics",
+      "graphics\naudio\ninput\ngame",
+      "SDL.h"}},
+});
+
+// 生成项目文件的内置模板，用户模板目录中的同名文件优先。
+// 语法：{{name}}插入值，{{#name}}...{{/name}}在值为真时展开（列表逐项展开，
+// {{.}}为当前项），{{^name}}...{{/name}}在值为假时展开，{{! ...}}为注释，
+// {{> name}}插入用同一组值渲染的另一个模板；独占一行的区块标签和插入标签
+// 连同换行一起去掉
+constexpr StaticMap<std::string_view, 18> PROJECT_TEMPLATES({
+    {"c_cpp_properties.json", R"tpl({
+    "configurations": [
+        {
+            "name": "Win32",
+            "includePath": [
+                "${workspaceFolder}/**",
+                "${workspaceFolder}/{{include_dir}}"
+            ],
+            "defines": [
+                "_DEBUG",
+                "UNICODE",
+                "_UNICODE"
+            ],
+            "compilerPath": "{{compiler_path}}",
+            "cStandard": "{{c_standard}}",
+            "cppStandard": "{{cpp_standard}}",
+            "intelliSenseMode": "{{intellisense_mode}}"
+        },
+        {
+            "name": "Linux",
+            "includePath": [
+                "${workspaceFolder}/**",
+                "${workspaceFolder}/{{include_dir}}"
+            ],
+            "defines": [],
+            "compilerPath": "{{compiler_path}}",
+            "cStandard": "{{c_standard}}",
+            "cppStandard": "{{cpp_standard}}",
+            "intelliSenseMode": "{{intellisense_mode}}"
+        }
+    ],
+    "version": 4
+})tpl"},
+    {"tasks.json", R"tpl({
+    "version": "2.0.0",
+    "tasks": [
+{{#use_cmake}}
+        {
+            "label": "Configure",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/debug",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Debug"
+            ],
+            "problemMatcher": []
+        },
+        {
+            "label": "Build",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/debug",
+                "--config",
+                "Debug",
+                "--parallel"
+            ],
+            "dependsOn": "Configure",
+            "group": {
+                "kind": "build",
+                "isDefault": true
+            },
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Incremental parallel build with {{compiler_name}}"
+        },
+{{> tasks/profiles.json}}
+        {
+            "label": "Clean",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/debug",
+                "--target",
+                "clean"
+            ]
+        }
+{{/use_cmake}}
+{{^use_cmake}}
+        {
+            "label": "Build",
+            "type": "shell",
+            "command": "{{compiler_path}}",
+            "args": [
+{{#msvc}}
+                "/std:{{cpp_standard_number}}",
+                "/I${workspaceFolder}/include",
+{{/msvc}}
+{{^msvc}}
+                "-std={{cpp_standard}}",
+                "-I${workspaceFolder}/include",
+{{/msvc}}
+{{#extra_args}}
+                "{{.}}",
+{{/extra_args}}
+                "${workspaceFolder}/src/*.cpp",
+                "-o",
+                "${workspaceFolder}/build/bin/Debug/{{project_name}}{{output_ext}}"
+            ],
+            "group": {
+                "kind": "build",
+                "isDefault": true
+            },
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Built with {{compiler_name}}"
+        },
+        {
+            "label": "Clean",
+            "type": "shell",
+            "command": "rm",
+            "args": [
+                "-rf",
+                "${workspaceFolder}/build/bin/Debug/*"
+            ]
+        }
+{{/use_cmake}}
+    ]
+})tpl"},
+    {"launch.json", R"tpl({
+    "version": "0.2.0",
+    "configurations": [
+        {
+            "name": "Debug Launch",
+            "type": "cppdbg",
+            "request": "launch",
+            "program": "${workspaceFolder}/build/bin/Debug/{{program_name}}{{output_ext}}",
+            "args": [],
+            "stopAtEntry": false,
+            "cwd": "${workspaceFolder}",
+            "environment": [],
+            "externalConsole": true,
+            "MIMode": "{{debugger_type}}",
+            "miDebuggerPath": "{{debugger_path}}",
+            "setupCommands": [
+                {
+                    "description": "Enable pretty-printing for gdb",
+                    "text": "-enable-pretty-printing",
+                    "ignoreFailures": true
+                }
+            ],
+            "preLaunchTask": "Build"
+        }
+    ]
+})tpl"},
+    {"settings.json", R"tpl({
+    "files.associations": {
+        "*.h": "c",
+        "*.hpp": "cpp",
+        "*.ipp": "cpp"
+    },
+    "editor.formatOnSave": true,
+    "C_Cpp.default.configurationProvider": "ms-vscode.cpptools",
+    "explorer.confirmDragAndDrop": false
+})tpl"},
+    {"CMakeLists.txt", R"tpl(cmake_minimum_required(VERSION 3.20)
+project({{project_name}} VERSION 1.0 LANGUAGES CXX)
+
+set(CMAKE_CXX_STANDARD {{cpp_standard_number}})
+set(CMAKE_C_STANDARD {{c_standard_number}})
+
+# Debug/Release/RelWithDebInfo/Native/PGO profiles, see cmake/BuildProfiles.cmake
+list(APPEND CMAKE_MODULE_PATH ${CMAKE_CURRENT_SOURCE_DIR}/cmake)
+include(BuildProfiles)
+include(PrecompiledHeaders)
+include(CompilerCache)
+
+include(FetchContent)
+include_directories(include)
+
+# Every source under src/ is its own translation unit, so an incremental
+# build only recompiles the files that changed
+file(GLOB_RECURSE project_sources CONFIGURE_DEPENDS src/*.cpp)
+add_executable({{project_name}} ${project_sources})
+target_include_directories({{project_name}} PUBLIC include)
+target_third_party_pch({{project_name}})
+install(TARGETS {{project_name}} DESTINATION bin)
+install(DIRECTORY include/ DESTINATION include)
+{{#has_extra_args}}
+
+# Additional compiler flags
+target_compile_options({{project_name}} PRIVATE{{#extra_args}} {{.}}{{/extra_args}})
+{{/has_extra_args}}
+)tpl"},
+    {"main.cpp", R"tpl(#include <iostream>
 
-    auto a = state[0];
-    auto b = state[1];
-    auto c = state[2];
-    auto d = state[3];
-    auto e = state[4];
-    auto f = state[5];
-    auto g = state[6];
-    auto h = state[7];
+int main() {
+    std::cout << "Hello, {{project_name}}!\n";
+    std::cout << "Project created successfully!\n";
+    return 0;
+}
+)tpl"},
+    {".gitignore", R"tpl(# Build artifacts
+build/
+*.exe
+*.out
+*.o
+*.obj
 
-    // 主循环
-    for (int i = 0; i < 64; i++) {
-      uint32_t T1 = h + sigma1(e) + ch(e, f, g) + K[i] + W[i];
-      uint32_t T2 = sigma0(a) + maj(a, b, c);
-      h = g;
-      g = f;
-      f = e;
-      e = d + T1;
-      d = c;
-      c = b;
-      b = a;
-      a = T1 + T2;
-    }
+# Editor files
+.vscode/
+!.vscode/tasks.json
+!.vscode/launch.json
+!.vscode/c_cpp_properties.json
+!.vscode/settings.json
 
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
+# System files
+.DS_Store
+Thumbs.db
+)tpl"},
+    {"cmake/BuildProfiles.cmake", R"tpl(# Build profiles for {{project_name}}. Each profile is configured into its own
+# build tree by the matching .vscode/tasks.json task and its executables go to
+# build/bin/<BUILD_PROFILE>, so the profiles never overwrite each other.
+#
+#   Debug           no optimization, full debug info (default)
+#   Release         optimized, with IPO/LTO when the toolchain supports it
+#   RelWithDebInfo  optimized with debug info and frame pointers, so sampling
+#                   profilers (perf, VTune, Instruments) get complete stacks
+#   NATIVE_ARCH=ON  tune for the building CPU (-march=native); the binaries
+#                   may not run on other machines
+#   PGO=GENERATE    instrumented build; running it records a profile
+#   PGO=USE         rebuild using the recorded profile
+#   UNITY_BUILD=ON  compile the sources of each target in batches of
+#                   UNITY_BUILD_BATCH_SIZE files as one translation unit;
+#                   faster clean builds, slower incremental ones
+#
+# Profile-guided optimization is a two-stage workflow: build with
+# PGO=GENERATE, run the program on a representative workload, then reconfigure
+# the same build tree with PGO=USE and rebuild. The "Build PGO" task does all
+# three steps.
+
+include(CheckCXXCompilerFlag)
+include(CheckIPOSupported)
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+  set(CMAKE_BUILD_TYPE Debug CACHE STRING "Build type" FORCE)
+endif()
+
+set(BUILD_PROFILE "$<CONFIG>" CACHE STRING
+    "Output directory under build/bin")
+# $<1:...> stops multi-config generators from appending another <config>
+set(CMAKE_RUNTIME_OUTPUT_DIRECTORY
+    $<1:${PROJECT_SOURCE_DIR}/build/bin/${BUILD_PROFILE}>)
+
+option(ENABLE_IPO "Use IPO/LTO in Release builds" ON)
+if(ENABLE_IPO AND (CMAKE_CONFIGURATION_TYPES OR
+                   CMAKE_BUILD_TYPE STREQUAL "Release"))
+  check_ipo_supported(RESULT ipo_supported OUTPUT ipo_output LANGUAGES CXX)
+  if(ipo_supported)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELEASE ON)
+  else()
+    message(STATUS "IPO/LTO is not supported: ${ipo_output}")
+  endif()
+endif()
+
+# MSVC x64 unwinds through tables, only GCC and Clang omit frame pointers
+if(NOT MSVC)
+  check_cxx_compiler_flag(-fno-omit-frame-pointer HAVE_NO_OMIT_FRAME_POINTER)
+  if(HAVE_NO_OMIT_FRAME_POINTER)
+    add_compile_options(
+        $<$<CONFIG:RelWithDebInfo>:-fno-omit-frame-pointer>)
+  endif()
+endif()
+
+option(UNITY_BUILD "Compile sources in unity batches" OFF)
+set(UNITY_BUILD_BATCH_SIZE 8 CACHE STRING
+    "Sources per unity translation unit (0: all sources of a target)")
+set(CMAKE_UNITY_BUILD ${UNITY_BUILD})
+set(CMAKE_UNITY_BUILD_BATCH_SIZE ${UNITY_BUILD_BATCH_SIZE})
+
+option(NATIVE_ARCH "Tune for the building CPU (-march=native)" OFF)
+if(NATIVE_ARCH)
+  check_cxx_compiler_flag(-march=native HAVE_MARCH_NATIVE)
+  if(HAVE_MARCH_NATIVE)
+    add_compile_options(-march=native)
+  else()
+    message(WARNING "${CMAKE_CXX_COMPILER_ID} does not support -march=native")
+  endif()
+endif()
+
+set(PGO OFF CACHE STRING "Profile-guided optimization: OFF, GENERATE or USE")
+set_property(CACHE PGO PROPERTY STRINGS OFF GENERATE USE)
+set(PGO_DIR ${PROJECT_SOURCE_DIR}/build/pgo-data CACHE PATH
+    "Where the instrumented build writes its profile")
+if(PGO STREQUAL "GENERATE" OR PGO STREQUAL "USE")
+  if(NOT CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+    message(FATAL_ERROR "PGO needs GCC or Clang, not ${CMAKE_CXX_COMPILER_ID}")
+  endif()
+endif()
+if(PGO STREQUAL "GENERATE")
+  # Every training run starts from an empty profile
+  file(REMOVE_RECURSE ${PGO_DIR})
+  add_compile_options(-fprofile-generate=${PGO_DIR})
+  add_link_options(-fprofile-generate=${PGO_DIR})
+elseif(PGO STREQUAL "USE")
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    # Clang writes raw profiles that have to be merged first
+    file(GLOB pgo_raw_profiles ${PGO_DIR}/*.profraw)
+    if(NOT pgo_raw_profiles)
+      message(FATAL_ERROR "No profile in ${PGO_DIR}; build with PGO=GENERATE "
+                          "and run the program first")
+    endif()
+    get_filename_component(compiler_dir ${CMAKE_CXX_COMPILER} DIRECTORY)
+    find_program(LLVM_PROFDATA llvm-profdata HINTS ${compiler_dir} REQUIRED)
+    execute_process(
+        COMMAND ${LLVM_PROFDATA} merge -o ${PGO_DIR}/default.profdata
+                ${pgo_raw_profiles}
+        COMMAND_ERROR_IS_FATAL ANY)
+    set(pgo_use_flag -fprofile-use=${PGO_DIR}/default.profdata)
+  else()
+    # GCC finds the profile of each object by its path, so PGO=GENERATE and
+    # PGO=USE have to share one build tree
+    set(pgo_use_flag -fprofile-use=${PGO_DIR} -Wno-missing-profile)
+  endif()
+  add_compile_options(${pgo_use_flag})
+  add_link_options(${pgo_use_flag})
+elseif(NOT PGO STREQUAL "OFF")
+  message(FATAL_ERROR "PGO must be OFF, GENERATE or USE, not ${PGO}")
+endif()
+)tpl"},
+    {"cmake/CompilerCache.cmake", R"tpl(# Compile through ccache or sccache so rebuilds after wiping the build tree or
+# switching branches reuse earlier results. Works with the Makefile and Ninja
+# generators; Visual Studio generators ignore compiler launchers.
+#
+#   COMPILER_CACHE           ccache, sccache, AUTO (first one found) or OFF
+#   COMPILER_CACHE_DIR       cache location, e.g. a directory CI persists
+#   COMPILER_CACHE_MAX_SIZE  cache size limit, e.g. 5G
+#
+# Leave COMPILER_CACHE_DIR and COMPILER_CACHE_MAX_SIZE empty to use the tool's
+# own configuration (CCACHE_DIR, SCCACHE_DIR, ccache.conf, ...).
+#
+# Include this after PrecompiledHeaders: with precompiled headers enabled,
+# ccache needs extra settings to get cache hits (see below).
+
+set(COMPILER_CACHE "{{compiler_cache}}" CACHE STRING
+    "Compiler cache: ccache, sccache, AUTO or OFF")
+set(COMPILER_CACHE_DIR "{{compiler_cache_dir}}" CACHE PATH
+    "Compiler cache directory (empty: the tool's default)")
+set(COMPILER_CACHE_MAX_SIZE "{{compiler_cache_max_size}}" CACHE STRING
+    "Compiler cache size limit, e.g. 5G (empty: the tool's default)")
+
+if(COMPILER_CACHE STREQUAL "AUTO")
+  set(compiler_cache_names ccache sccache)
+elseif(COMPILER_CACHE)
+  set(compiler_cache_names ${COMPILER_CACHE})
+endif()
+
+if(compiler_cache_names)
+  unset(COMPILER_CACHE_PROGRAM CACHE)
+  find_program(COMPILER_CACHE_PROGRAM NAMES ${compiler_cache_names}
+{{#compiler_cache_hint}}
+               HINTS "{{compiler_cache_hint}}"
+{{/compiler_cache_hint}}
+               )
+  if(COMPILER_CACHE_PROGRAM)
+    get_filename_component(compiler_cache_tool ${COMPILER_CACHE_PROGRAM} NAME_WE)
+    if(compiler_cache_tool STREQUAL "sccache")
+      set(compiler_cache_dir_env SCCACHE_DIR)
+      set(compiler_cache_size_env SCCACHE_CACHE_SIZE)
+    else()
+      set(compiler_cache_dir_env CCACHE_DIR)
+      set(compiler_cache_size_env CCACHE_MAXSIZE)
+    endif()
+    set(compiler_cache_env)
+    if(COMPILER_CACHE_DIR)
+      list(APPEND compiler_cache_env ${compiler_cache_dir_env}=${COMPILER_CACHE_DIR})
+    endif()
+    if(COMPILER_CACHE_MAX_SIZE)
+      list(APPEND compiler_cache_env ${compiler_cache_size_env}=${COMPILER_CACHE_MAX_SIZE})
+    endif()
+
+    # Without these ccache can't hash the precompiled header and every
+    # translation unit that uses it is a cache miss ("Precompiled headers" in
+    # the ccache manual). sccache doesn't cache PCH builds either way.
+    if(compiler_cache_tool STREQUAL "ccache" AND ENABLE_PCH AND PCH_HEADERS)
+      list(APPEND compiler_cache_env CCACHE_SLOPPINESS=pch_defines,time_macros)
+      if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        add_compile_options(-fpch-preprocess)
+      elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang" AND NOT MSVC)
+        add_compile_options("SHELL:-Xclang -fno-pch-timestamp")
+      endif()
+    endif()
+
+    # Settings are passed through the environment, which costs one extra
+    # process per compile, so only do it when they are given
+    if(compiler_cache_env)
+      set(compiler_launcher ${CMAKE_COMMAND} -E env ${compiler_cache_env}
+          ${COMPILER_CACHE_PROGRAM})
+    else()
+      set(compiler_launcher ${COMPILER_CACHE_PROGRAM})
+    endif()
+    set(CMAKE_C_COMPILER_LAUNCHER ${compiler_launcher})
+    set(CMAKE_CXX_COMPILER_LAUNCHER ${compiler_launcher})
+    message(STATUS "Compiler cache: ${COMPILER_CACHE_PROGRAM}")
+
+    # /Zi writes one shared PDB per target, which compiler caches can't
+    # store; /Z7 keeps the debug info in each object file instead
+    if(MSVC)
+      foreach(flags_var CMAKE_C_FLAGS_DEBUG CMAKE_CXX_FLAGS_DEBUG
+                        CMAKE_C_FLAGS_RELWITHDEBINFO
+                        CMAKE_CXX_FLAGS_RELWITHDEBINFO)
+        string(REPLACE "/Zi" "/Z7" ${flags_var} "${${flags_var}}")
+      endforeach()
+    endif()
+  elseif(NOT COMPILER_CACHE STREQUAL "AUTO")
+    message(WARNING "Compiler cache ${COMPILER_CACHE} not found")
+  endif()
+endif()
+)tpl"},
+    {"cmake/PrecompiledHeaders.cmake", R"tpl(# Precompiled headers for the third-party libraries installed into
+# third_party/. Their primary headers are parsed once per target instead of
+# once per translation unit. Set ENABLE_PCH=OFF to compile without them; the
+# include directories are added either way.
+
+option(ENABLE_PCH "Precompile the primary headers of third-party libraries" ON)
+
+set(PCH_INCLUDE_DIRS
+{{#pch_include_dirs}}
+    "${PROJECT_SOURCE_DIR}/{{.}}"
+{{/pch_include_dirs}}
+    )
+set(PCH_HEADERS
+{{#pch_headers}}
+    <{{.}}>
+{{/pch_headers}}
+    )
+
+# Precompile PCH_HEADERS for target
+function(target_third_party_pch target)
+  target_include_directories(${target} PRIVATE ${PCH_INCLUDE_DIRS})
+  if(ENABLE_PCH AND PCH_HEADERS)
+    target_precompile_headers(${target} PRIVATE ${PCH_HEADERS})
+  endif()
+endfunction()
+
+# Use the headers precompiled for source instead of compiling them again;
+# both targets need the same compile options
+function(target_reuse_third_party_pch target source)
+  target_include_directories(${target} PRIVATE ${PCH_INCLUDE_DIRS})
+  if(ENABLE_PCH AND PCH_HEADERS)
+    target_precompile_headers(${target} REUSE_FROM ${source})
+  endif()
+endfunction()
+)tpl"},
+    {"tasks/profiles.json", R"tpl(        {
+            "label": "Configure Release",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/release",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Release",
+                "-DBUILD_PROFILE=Release"
+            ],
+            "hide": true,
+            "problemMatcher": []
+        },
+        {
+            "label": "Build Release",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/release",
+                "--config",
+                "Release",
+                "--parallel"
+            ],
+            "dependsOn": "Configure Release",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Optimized with IPO/LTO into build/bin/Release"
+        },
+        {
+            "label": "Configure RelWithDebInfo",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/relwithdebinfo",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=RelWithDebInfo",
+                "-DBUILD_PROFILE=RelWithDebInfo"
+            ],
+            "hide": true,
+            "problemMatcher": []
+        },
+        {
+            "label": "Build RelWithDebInfo",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/relwithdebinfo",
+                "--config",
+                "RelWithDebInfo",
+                "--parallel"
+            ],
+            "dependsOn": "Configure RelWithDebInfo",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Optimized with frame pointers for profiling into build/bin/RelWithDebInfo"
+        },
+        {
+            "label": "Configure Native",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/native",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Release",
+                "-DBUILD_PROFILE=Native",
+                "-DNATIVE_ARCH=ON"
+            ],
+            "hide": true,
+            "problemMatcher": []
+        },
+        {
+            "label": "Build Native",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/native",
+                "--config",
+                "Release",
+                "--parallel"
+            ],
+            "dependsOn": "Configure Native",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Release tuned for this CPU (-march=native) into build/bin/Native"
+        },
+        {
+            "label": "Configure PGO Instrument",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/pgo",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Release",
+                "-DBUILD_PROFILE=PgoInstrument",
+                "-DPGO=GENERATE"
+            ],
+            "hide": true,
+            "problemMatcher": []
+        },
+        {
+            "label": "Build PGO Instrument",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/pgo",
+                "--config",
+                "Release",
+                "--parallel"
+            ],
+            "dependsOn": "Configure PGO Instrument",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "PGO stage 1: instrumented build into build/bin/PgoInstrument"
+        },
+        {
+            "label": "PGO Train",
+            "type": "shell",
+            "command": "${workspaceFolder}/build/bin/PgoInstrument/{{program_name}}{{output_ext}}",
+            "args": [],
+            "options": {
+                "cwd": "${workspaceFolder}"
+            },
+            "dependsOn": "Build PGO Instrument",
+            "problemMatcher": [],
+            "detail": "PGO stage 2: run a representative workload (edit args to match)"
+        },
+        {
+            "label": "Configure PGO",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/pgo",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Release",
+                "-DBUILD_PROFILE=Pgo",
+                "-DPGO=USE"
+            ],
+            "dependsOn": "PGO Train",
+            "hide": true,
+            "problemMatcher": []
+        },
+        {
+            "label": "Build PGO",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/pgo",
+                "--config",
+                "Release",
+                "--parallel"
+            ],
+            "dependsOn": "Configure PGO",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "PGO stage 3: instrument, train and rebuild into build/bin/Pgo"
+        },
+{{#compiler_cache_path}}
+        {
+            "label": "Compiler Cache Statistics",
+            "type": "shell",
+            "command": "{{compiler_cache_path}}",
+            "args": [
+                "--show-stats"
+            ],
+{{#compiler_cache_dir}}
+            "options": {
+                "env": {
+                    "{{compiler_cache_dir_env}}": "{{compiler_cache_dir}}"
+                }
+            },
+{{/compiler_cache_dir}}
+            "problemMatcher": [],
+            "detail": "Hits and misses of {{compiler_cache}}"
+        },
+{{/compiler_cache_path}}
+)tpl"},
+    {"workspace/CMakeLists.txt", R"tpl(cmake_minimum_required(VERSION 3.20)
+project({{project_name}} VERSION 1.0 LANGUAGES CXX)
+
+set(CMAKE_CXX_STANDARD {{cpp_standard_number}})
+set(CMAKE_C_STANDARD {{c_standard_number}})
+
+option({{option_prefix}}_BUILD_TESTS "Build the {{project_name}} tests" ON)
+option({{option_prefix}}_BUILD_BENCHES "Build the {{project_name}} benchmarks" ON)
+
+# Debug/Release/RelWithDebInfo/Native/PGO profiles, see cmake/BuildProfiles.cmake.
+# Executables go to build/bin/<profile>, where .vscode/launch.json expects them
+list(APPEND CMAKE_MODULE_PATH ${CMAKE_CURRENT_SOURCE_DIR}/cmake)
+include(BuildProfiles)
+include(PrecompiledHeaders)
+include(CompilerCache)
+
+include(FetchContent)
+
+# Core sources are compiled once as an object library. The static library,
+# the apps, the tests and the benchmarks all link the same object files, so
+# editing one app only recompiles and relinks that app.
+add_library({{project_name}}_objects OBJECT core/src/core.cpp)
+target_include_directories({{project_name}}_objects PUBLIC
+    $<BUILD_INTERFACE:${CMAKE_CURRENT_SOURCE_DIR}/core/include>
+    $<INSTALL_INTERFACE:include>)
+# Third-party headers are precompiled once here and reused by every target
+target_third_party_pch({{project_name}}_objects)
+{{#has_extra_args}}
+target_compile_options({{project_name}}_objects PUBLIC{{#extra_args}} {{.}}{{/extra_args}})
+{{/has_extra_args}}
+
+add_library({{project_name}}_core STATIC)
+target_link_libraries({{project_name}}_core PUBLIC {{project_name}}_objects)
+
+{{#apps}}
+add_executable({{.}} apps/{{.}}/main.cpp)
+target_link_libraries({{.}} PRIVATE {{project_name}}_objects)
+target_reuse_third_party_pch({{.}} {{project_name}}_objects)
+
+{{/apps}}
+if({{option_prefix}}_BUILD_TESTS)
+  enable_testing()
+  add_executable({{project_name}}_tests tests/test_core.cpp)
+  target_link_libraries({{project_name}}_tests PRIVATE {{project_name}}_objects)
+  target_reuse_third_party_pch({{project_name}}_tests {{project_name}}_objects)
+  add_test(NAME {{project_name}}_tests COMMAND {{project_name}}_tests)
+endif()
+
+if({{option_prefix}}_BUILD_BENCHES)
+  add_executable({{project_name}}_bench bench/bench_core.cpp)
+  target_link_libraries({{project_name}}_bench PRIVATE {{project_name}}_objects)
+  target_reuse_third_party_pch({{project_name}}_bench {{project_name}}_objects)
+endif()
+
+install(TARGETS {{project_name}}_core{{#apps}} {{.}}{{/apps}}
+        RUNTIME DESTINATION bin
+        ARCHIVE DESTINATION lib)
+install(DIRECTORY core/include/ DESTINATION include)
+)tpl"},
+    {"workspace/tasks.json", R"tpl({
+    "version": "2.0.0",
+    "tasks": [
+        {
+            "label": "Configure",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "-S",
+                "${workspaceFolder}",
+                "-B",
+                "${workspaceFolder}/build/debug",
+{{#cmake_generator}}
+                "-G",
+                "{{cmake_generator}}",
+{{/cmake_generator}}
+{{#cmake_cxx_compiler}}
+                "-DCMAKE_CXX_COMPILER={{cmake_cxx_compiler}}",
+{{/cmake_cxx_compiler}}
+                "-DCMAKE_BUILD_TYPE=Debug"
+            ],
+            "problemMatcher": []
+        },
+        {
+            "label": "Build",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/debug",
+                "--config",
+                "Debug",
+                "--parallel"
+            ],
+            "dependsOn": "Configure",
+            "group": {
+                "kind": "build",
+                "isDefault": true
+            },
+            "problemMatcher": ["{{problem_matcher}}"],
+            "detail": "Build all targets with {{compiler_name}}"
+        },
+{{#targets}}
+        {
+            "label": "Build {{.}}",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/debug",
+                "--config",
+                "Debug",
+                "--parallel",
+                "--target",
+                "{{.}}"
+            ],
+            "dependsOn": "Configure",
+            "group": "build",
+            "problemMatcher": ["{{problem_matcher}}"]
+        },
+{{/targets}}
+{{> tasks/profiles.json}}
+        {
+            "label": "Test",
+            "type": "shell",
+            "command": "{{ctest}}",
+            "args": [
+                "--test-dir",
+                "${workspaceFolder}/build/debug",
+                "-C",
+                "Debug",
+                "--output-on-failure"
+            ],
+            "dependsOn": "Build {{project_name}}_tests",
+            "group": "test",
+            "problemMatcher": []
+        },
+        {
+            "label": "Clean",
+            "type": "shell",
+            "command": "{{cmake}}",
+            "args": [
+                "--build",
+                "${workspaceFolder}/build/debug",
+                "--target",
+                "clean"
+            ]
+        }
+    ]
+})tpl"},
+    {"workspace/core.hpp", R"tpl(#pragma once
+
+#include <string>
+
+namespace {{namespace}} {
+
+// Returns a greeting for name.
+std::string greeting(const std::string &name);
+
+} // namespace {{namespace}}
+)tpl"},
+    {"workspace/core.cpp", R"tpl(#include "{{project_name}}/core.hpp"
+
+namespace {{namespace}} {
+
+std::string greeting(const std::string &name) {
+    return "Hello, " + name + "!";
+}
+
+} // namespace {{namespace}}
+)tpl"},
+    {"workspace/app.cpp", R"tpl(#include <iostream>
+
+#include "{{project_name}}/core.hpp"
+
+int main() {
+    std::cout << {{namespace}}::greeting("{{app_name}}") << "\n";
+    return 0;
+}
+)tpl"},
+    {"workspace/test.cpp", R"tpl(#include <cstdlib>
+#include <iostream>
+
+#include "{{project_name}}/core.hpp"
+
+int main() {
+    if ({{namespace}}::greeting("test") != "Hello, test!") {
+        std::cerr << "greeting() returned an unexpected value\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All tests passed\n";
+    return EXIT_SUCCESS;
+}
+)tpl"},
+    {"workspace/bench.cpp", R"tpl(#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#include "{{project_name}}/core.hpp"
+
+int main() {
+    constexpr int kIterations = 100000;
+    std::size_t total = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        total += {{namespace}}::greeting("bench").size();
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "greeting: " << elapsed.count() / kIterations << " ns/op ("
+              << total << " bytes)\n";
+    return 0;
+}
+)tpl"},
+});
+
+// C++关键字和替代记号（含C++20），不能用作生成代码中的命名空间
+constexpr std::string_view CPP_KEYWORDS[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor",
+    "bool", "break", "case", "catch", "char", "char8_t", "char16_t", "char32_t",
+    "class", "compl", "concept", "const", "consteval", "constexpr", "constinit",
+    "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype",
+    "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+    "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+    "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private",
+    "protected", "public", "register", "reinterpret_cast", "requires", "return",
+    "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+    "struct", "switch", "template", "this", "thread_local", "throw", "true",
+    "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"};
+} // namespace Constants
+
+// SHA256计算类
+class SHA256 {
+private:
+  static constexpr std::array<uint32_t, 64> K = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+      0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+      0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+      0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+      0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+      0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+  std::array<uint32_t, 8> state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                   0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                   0x1f83d9ab, 0x5be0cd19};
+
+  static uint32_t rotr(uint32_t x, uint32_t n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  static uint32_t ch(uint32_t x, uint32_t y, uint32_t z) {
+    return (x & y) ^ (~x & z);
+  }
+
+  static uint32_t maj(uint32_t x, uint32_t y, uint32_t z) {
+    return (x & y) ^ (x & z) ^ (y & z);
+  }
+
+  static uint32_t sigma0(uint32_t x) {
+    return rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22);
+  }
+
+  static uint32_t sigma1(uint32_t x) {
+    return rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25);
+  }
+
+  static uint32_t gamma0(uint32_t x) {
+    return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3);
+  }
+
+  static uint32_t gamma1(uint32_t x) {
+    return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10);
+  }
+
+  void transform(const uint8_t *data) {
+    std::array<uint32_t, 64> W = {0};
+
+    // 将数据分成16个32位字（大端序）
+    for (int i = 0; i < 16; i++) {
+      W[i] = (static_cast<uint32_t>(data[i * 4]) << 24) |
+             (static_cast<uint32_t>(data[i * 4 + 1]) << 16) |
+             (static_cast<uint32_t>(data[i * 4 + 2]) << 8) |
+             (static_cast<uint32_t>(data[i * 4 + 3]));
+    }
+
+    // 扩展消息
+    for (int i = 16; i < 64; i++) {
+      W[i] = gamma1(W[i - 2]) + W[i - 7] + gamma0(W[i - 15]) + W[i - 16];
+    }
+
+    auto a = state[0];
+    auto b = state[1];
+    auto c = state[2];
+    auto d = state[3];
+    auto e = state[4];
+    auto f = state[5];
+    auto g = state[6];
+    auto h = state[7];
+
+    // 主循环
+    for (int i = 0; i < 64; i++) {
+      uint32_t T1 = h + sigma1(e) + ch(e, f, g) + K[i] + W[i];
+      uint32_t T2 = sigma0(a) + maj(a, b, c);
+      h = g;
+      g = f;
+      f = e;
+      e = d + T1;
+      d = c;
+      c = b;
+      b = a;
+      a = T1 + T2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
     state[4] += e;
     state[5] += f;
     state[6] += g;
@@ -322,838 +1429,6239 @@ public:
   }
 };
 
-// 安全命令执行类
-class SafeCommandExecutor {
+// CRC32计算类（ZIP/GZIP完整性校验，slicing-by-8）
+class CRC32 {
 public:
-  // 安全执行命令并获取输出
-  static std::string execute(const std::vector<std::string> &args) {
-    if (args.empty()) {
-      throw std::invalid_argument("Command arguments cannot be empty");
+  static uint32_t update(uint32_t crc, const uint8_t *data, size_t len) {
+    const auto &t = tables();
+    crc = ~crc;
+    while (len >= 8) {
+      uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) |
+                           static_cast<uint32_t>(data[1]) << 8 |
+                           static_cast<uint32_t>(data[2]) << 16 |
+                           static_cast<uint32_t>(data[3]) << 24);
+      crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+            t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^ t[3][data[4]] ^
+            t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+      data += 8;
+      len -= 8;
     }
+    while (len--) {
+      crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
 
-    // Validate each argument
-    for (const auto &arg : args) {
-      if (!is_safe_argument(arg)) {
-        throw std::runtime_error("Unsafe argument detected: " + arg);
+private:
+  using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+  static const Tables &tables() {
+    static const Tables t = [] {
+      Tables result{};
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        result[0][i] = c;
       }
-    }
+      for (uint32_t i = 0; i < 256; i++) {
+        for (size_t k = 1; k < 8; k++) {
+          result[k][i] =
+              result[0][result[k - 1][i] & 0xff] ^ (result[k - 1][i] >> 8);
+        }
+      }
+      return result;
+    }();
+    return t;
+  }
+};
 
-    // Build the command string for logging
-    std::string command_str;
-    for (const auto &arg : args) {
-      command_str += arg + " ";
+// DEFLATE解码类（RFC 1951，输出到已知大小的缓冲区）
+class Inflater {
+public:
+  // 解压原始DEFLATE流，成功时返回写入dst的字节数
+  static std::optional<size_t> inflate(const uint8_t *src, size_t src_len,
+                                       uint8_t *dst, size_t dst_len) {
+    Inflater state(src, src_len, dst, dst_len);
+    if (!state.run()) {
+      return std::nullopt;
     }
-    std::cout << "Executing safe command: " << command_str << std::endl;
+    return state.out_pos_;
+  }
 
-    // Return the constructed command string (trim trailing space)
-    if (!command_str.empty()) {
-      command_str.pop_back(); // Remove the trailing space
+  // 解压gzip数据（RFC 1952），校验CRC32和长度
+  static std::optional<std::string> gunzip(std::string_view data) {
+    auto byte = [&](size_t i) { return static_cast<uint8_t>(data[i]); };
+    auto le32 = [&](size_t i) {
+      return static_cast<uint32_t>(byte(i)) | byte(i + 1) << 8 |
+             byte(i + 2) << 16 | static_cast<uint32_t>(byte(i + 3)) << 24;
+    };
+    if (data.size() < 18 || byte(0) != 0x1f || byte(1) != 0x8b ||
+        byte(2) != 8) {
+      return std::nullopt;
     }
-    return command_str;
-  }
-  // 安全下载文件
-  static bool download_file(const std::string &url,
-                            const fs::path &output_path) {
-    // 验证URL
-    if (!is_valid_url(url)) {
-      throw std::invalid_argument("Invalid URL format: " + url);
+    const uint8_t flags = byte(3);
+    size_t pos = 10;
+    if (flags & 0x04) { // FEXTRA
+      pos += 2 + (byte(pos) | byte(pos + 1) << 8);
     }
-
-    // 验证输出路径
-    if (output_path.empty() || output_path.is_relative()) {
-      throw std::invalid_argument("Output path must be absolute");
+    for (uint8_t flag : {0x08, 0x10}) { // FNAME, FCOMMENT
+      if ((flags & flag) && pos < data.size()) {
+        pos = data.find('\0', pos);
+        if (pos == std::string_view::npos) {
+          return std::nullopt;
+        }
+        pos++;
+      }
     }
-
-    // 安全路径检查
-    if (output_path.string().find("..") != std::string::npos) {
-      throw std::invalid_argument(
-          "Output path contains parent directory traversal");
+    if (flags & 0x02) { // FHCRC
+      pos += 2;
+    }
+    if (pos + 8 > data.size()) {
+      return std::nullopt;
     }
 
-    // 创建输出目录
-    if (!safe_create_directory(output_path.parent_path())) {
-      throw std::runtime_error("Failed to create output directory");
+    const size_t trailer = data.size() - 8;
+    const uint32_t crc = le32(trailer);
+    const uint32_t size = le32(trailer + 4);
+    // ISIZE来自不可信的数据：DEFLATE的压缩比不超过1032:1，超出即为损坏
+    // 或恶意数据，不按其分配内存
+    const uint64_t compressed = trailer - pos;
+    if (size > compressed * kMaxDeflateRatio + 64 || size > kMaxGunzipBytes) {
+      return std::nullopt;
+    }
+    std::string out(size, '\0');
+    auto written = inflate(reinterpret_cast<const uint8_t *>(data.data()) + pos,
+                           trailer - pos,
+                           reinterpret_cast<uint8_t *>(out.data()), out.size());
+    if (!written || *written != size ||
+        CRC32::update(0, reinterpret_cast<const uint8_t *>(out.data()),
+                      out.size()) != crc) {
+      return std::nullopt;
     }
+    return out;
+  }
 
-#ifdef _WIN32
-    std::vector<std::string> args = {"curl",
-                                     "-L", // 跟随重定向
-                                     "-o", output_path.string(), url};
-#else
-    std::vector<std::string> args = {"curl",
-                                     "-L", // 跟随重定向
-                                     "-o", output_path.string(), url};
-#endif
+private:
+  static constexpr int kMaxBits = 15;
+  static constexpr int kFastBits = 10;
+  static constexpr uint64_t kMaxDeflateRatio = 1032;
+  static constexpr uint64_t kMaxGunzipBytes = 1ull << 30;
+
+  // 规范哈夫曼表：短码查表，长码逐位回退
+  struct Huffman {
+    std::array<uint16_t, kMaxBits + 1> counts{};
+    std::array<uint16_t, 288> symbols{};
+    std::array<uint16_t, 1 << kFastBits> fast{};
+  };
 
-    try {
-      std::string result = execute(args);
-      // 检查curl是否成功
-      if (result.find("curl:") != std::string::npos) {
-        std::cerr << "Curl error: " << result << std::endl;
-        return false;
+  const uint8_t *in_;
+  const uint8_t *in_end_;
+  uint8_t *out_;
+  size_t out_len_;
+  size_t out_pos_ = 0;
+  uint64_t bit_buf_ = 0;
+  int bit_cnt_ = 0;
+  int overrun_ = 0;
+
+  Inflater(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_len)
+      : in_(src), in_end_(src + src_len), out_(dst), out_len_(dst_len) {}
+
+  void refill() {
+    while (bit_cnt_ <= 56) {
+      if (in_ < in_end_) {
+        bit_buf_ |= static_cast<uint64_t>(*in_++) << bit_cnt_;
+      } else {
+        overrun_++;
       }
-      return true;
-    } catch (const std::exception &e) {
-      std::cerr << "Download failed: " << e.what() << std::endl;
-      return false;
+      bit_cnt_ += 8;
     }
   }
 
-  // 安全解压文件
-  static bool unzip_file(const fs::path &zip_file, const fs::path &output_dir) {
-    // 验证输入文件
-    if (!fs::exists(zip_file) || !fs::is_regular_file(zip_file)) {
-      throw std::invalid_argument("Invalid zip file: " + zip_file.string());
+  uint32_t bits(int n) {
+    if (bit_cnt_ < n) {
+      refill();
     }
+    uint32_t value = static_cast<uint32_t>(bit_buf_ & ((1ull << n) - 1));
+    bit_buf_ >>= n;
+    bit_cnt_ -= n;
+    return value;
+  }
 
-    // 验证输出目录
-    if (!fs::exists(output_dir) || !fs::is_directory(output_dir)) {
-      throw std::invalid_argument("Invalid output directory: " +
-                                  output_dir.string());
+  static bool build(Huffman &h, const uint8_t *lengths, int n) {
+    h.counts.fill(0);
+    h.fast.fill(0);
+    for (int i = 0; i < n; i++) {
+      h.counts[lengths[i]]++;
     }
-
-    // 安全路径检查
-    if (zip_file.string().find("..") != std::string::npos ||
-        output_dir.string().find("..") != std::string::npos) {
-      throw std::invalid_argument("Path contains parent directory traversal");
+    if (h.counts[0] == n) {
+      return true; // 空表（例如没有距离码）
     }
 
-#ifdef _WIN32
-    std::vector<std::string> args = {
-        "powershell",      "-Command",         "Expand-Archive",   "-Path",
-        zip_file.string(), "-DestinationPath", output_dir.string()};
-#else
-    std::vector<std::string> args = {"unzip", "-o", zip_file.string(), "-d",
-                                     output_dir.string()};
-#endif
+    // 检查码长是否超额
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; len++) {
+      left <<= 1;
+      left -= h.counts[len];
+      if (left < 0) {
+        return false;
+      }
+    }
 
-    try {
-      std::string result = execute(args);
-      return true;
-    } catch (const std::exception &e) {
-      std::cerr << "Unzip failed: " << e.what() << std::endl;
-      return false;
+    std::array<uint16_t, kMaxBits + 1> offsets{};
+    for (int len = 1; len < kMaxBits; len++) {
+      offsets[len + 1] = offsets[len] + h.counts[len];
+    }
+    for (int sym = 0; sym < n; sym++) {
+      if (lengths[sym] != 0) {
+        h.symbols[offsets[lengths[sym]]++] = static_cast<uint16_t>(sym);
+      }
     }
-  }
 
-  // 安全创建目录
-  static bool safe_create_directory(const fs::path &path) {
-    try {
-      if (!fs::exists(path)) {
-        return fs::create_directories(path);
+    // 填充快速查找表（DEFLATE的哈夫曼码按位反序存储）
+    uint32_t code = 0;
+    int index = 0;
+    for (int len = 1; len <= kFastBits; len++) {
+      for (int i = 0; i < h.counts[len]; i++, index++, code++) {
+        uint32_t reversed = 0;
+        for (int b = 0; b < len; b++) {
+          reversed |= ((code >> b) & 1) << (len - 1 - b);
+        }
+        uint16_t entry =
+            static_cast<uint16_t>((len << 9) | h.symbols[index]);
+        for (uint32_t slot = reversed; slot < h.fast.size();
+             slot += 1u << len) {
+          h.fast[slot] = entry;
+        }
       }
-      return true;
-    } catch (const fs::filesystem_error &e) {
-      std::cerr << "Error creating directory: " << e.what() << std::endl;
-      return false;
+      code <<= 1;
     }
+    return true;
   }
 
-private:
-  // POSIX命令执行
-  static std::string execute_posix(const std::vector<std::string> &args) {
-#ifdef _WIN32
-    // Windows版本使用_popen
-    std::string command;
-    for (const auto &arg : args) {
-      if (!command.empty())
-        command += " ";
-      command += arg;
+  int decode(const Huffman &h) {
+    if (bit_cnt_ < kMaxBits) {
+      refill();
     }
-
-    std::array<char, 128> buffer;
-    std::string result;
-    std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(command.c_str(), "r"),
-                                                   _pclose);
-
-    if (!pipe) {
-      throw std::runtime_error("_popen() failed!");
+    uint16_t entry = h.fast[bit_buf_ & ((1u << kFastBits) - 1)];
+    if (entry != 0) {
+      bit_buf_ >>= entry >> 9;
+      bit_cnt_ -= entry >> 9;
+      return entry & 0x1ff;
     }
 
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-      result += buffer.data();
+    uint64_t buf = bit_buf_;
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= kMaxBits; len++) {
+      code |= static_cast<int>(buf & 1);
+      buf >>= 1;
+      int count = h.counts[len];
+      if (code - first < count) {
+        bit_buf_ >>= len;
+        bit_cnt_ -= len;
+        return h.symbols[index + (code - first)];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
     }
+    return -1;
+  }
 
-    return result;
-#else
-    // 原有的POSIX实现
-    // 准备参数数组
-    std::vector<char *> argv;
-    for (const auto &arg : args) {
-      argv.push_back(const_cast<char *>(arg.c_str()));
+  bool stored() {
+    // 丢弃到字节边界，并把预读的字节退回输入流
+    bit_buf_ >>= bit_cnt_ & 7;
+    bit_cnt_ -= bit_cnt_ & 7;
+    int buffered = bit_cnt_ / 8;
+    if (overrun_ > buffered) {
+      return false;
     }
-    argv.push_back(nullptr);
+    in_ -= buffered - overrun_;
+    overrun_ = 0;
+    bit_buf_ = 0;
+    bit_cnt_ = 0;
 
-    // 创建管道
-    int pipefd[2];
-    if (pipe(pipefd) == -1) {
-      throw std::runtime_error("Failed to create pipe");
+    if (in_end_ - in_ < 4) {
+      return false;
     }
-
-    pid_t pid = fork();
-    if (pid == -1) {
-      close(pipefd[0]);
-      close(pipefd[1]);
-      throw std::runtime_error("Failed to fork process");
+    size_t len = in_[0] | (in_[1] << 8);
+    size_t nlen = in_[2] | (in_[3] << 8);
+    in_ += 4;
+    if (len != (~nlen & 0xffff) ||
+        static_cast<size_t>(in_end_ - in_) < len || out_len_ - out_pos_ < len) {
+      return false;
     }
+    std::memcpy(out_ + out_pos_, in_, len);
+    in_ += len;
+    out_pos_ += len;
+    return true;
+  }
 
-    if (pid == 0) { // 子进程
-      // 关闭读端
-      close(pipefd[0]);
+  bool codes(const Huffman &lencode, const Huffman &distcode) {
+    static constexpr uint16_t kLenBase[29] = {
+        3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr uint8_t kLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                              1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                              4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr uint16_t kDistBase[30] = {
+        1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+        33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static constexpr uint8_t kDistExtra[30] = {0, 0, 0,  0,  1,  1,  2,  2,
+                                               3, 3, 4,  4,  5,  5,  6,  6,
+                                               7, 7, 8,  8,  9,  9,  10, 10,
+                                               11, 11, 12, 12, 13, 13};
 
-      // 重定向标准输出到管道
-      if (dup2(pipefd[1], STDOUT_FILENO) == -1) {
-        perror("dup2");
-        exit(EXIT_FAILURE);
+    while (true) {
+      int sym = decode(lencode);
+      if (sym < 0 || overrun_ > 8) {
+        return false;
       }
-      close(pipefd[1]);
-
-      // 降低权限（仅在Unix系统上）
-      if (setgid(getgid()) != 0 || setuid(getuid()) != 0) {
-        perror("setgid/setuid");
-        exit(EXIT_FAILURE);
+      if (sym < 256) {
+        if (out_pos_ >= out_len_) {
+          return false;
+        }
+        out_[out_pos_++] = static_cast<uint8_t>(sym);
+        continue;
+      }
+      if (sym == 256) {
+        return true;
       }
 
-      // 执行命令
-      execvp(argv[0], argv.data());
-      perror("execvp");
-      exit(EXIT_FAILURE);
-    }
-
-    // 父进程
-    close(pipefd[1]); // 关闭写端
-
-    std::string result;
-    char buffer[128];
-    ssize_t count;
+      sym -= 257;
+      if (sym >= 29) {
+        return false;
+      }
+      size_t len = kLenBase[sym] + bits(kLenExtra[sym]);
+      int dsym = decode(distcode);
+      if (dsym < 0 || dsym >= 30) {
+        return false;
+      }
+      size_t dist = kDistBase[dsym] + bits(kDistExtra[dsym]);
+      if (dist > out_pos_ || out_len_ - out_pos_ < len) {
+        return false;
+      }
 
-    while ((count = read(pipefd[0], buffer, sizeof(buffer)))) {
-      if (count == -1) {
-        if (errno == EINTR)
-          continue;
-        perror("read");
-        break;
+      uint8_t *dst = out_ + out_pos_;
+      const uint8_t *src = dst - dist;
+      if (dist >= len) {
+        std::memcpy(dst, src, len);
+      } else {
+        for (size_t i = 0; i < len; i++) {
+          dst[i] = src[i];
+        }
       }
-      result.append(buffer, count);
+      out_pos_ += len;
     }
+  }
 
-    close(pipefd[0]);
-
-    // 等待子进程结束
-    int status;
-    waitpid(pid, &status, 0);
+  bool fixed() {
+    static const std::pair<Huffman, Huffman> tables = [] {
+      std::pair<Huffman, Huffman> result;
+      std::array<uint8_t, 288> lengths{};
+      for (int i = 0; i < 144; i++)
+        lengths[i] = 8;
+      for (int i = 144; i < 256; i++)
+        lengths[i] = 9;
+      for (int i = 256; i < 280; i++)
+        lengths[i] = 7;
+      for (int i = 280; i < 288; i++)
+        lengths[i] = 8;
+      build(result.first, lengths.data(), 288);
+      lengths.fill(5);
+      build(result.second, lengths.data(), 30);
+      return result;
+    }();
+    return codes(tables.first, tables.second);
+  }
 
-    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
-      throw std::runtime_error("Command exited with non-zero status: " +
-                               std::to_string(WEXITSTATUS(status)));
+  bool dynamic() {
+    static constexpr uint8_t kOrder[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                           11, 4,  12, 3, 13, 2, 14, 1, 15};
+    int nlen = bits(5) + 257;
+    int ndist = bits(5) + 1;
+    int ncode = bits(4) + 4;
+    if (nlen > 286 || ndist > 30) {
+      return false;
     }
 
-    return result;
-#endif
-  }
-
-  // Windows参数转义
-  static std::string escape_windows_arg(const std::string &arg) {
-    std::string escaped;
-    for (char c : arg) {
-      if (c == '"') {
-        escaped += "\\\"";
-      } else if (c == '\\') {
-        escaped += "\\\\";
-      } else {
-        escaped += c;
-      }
+    std::array<uint8_t, 320> lengths{};
+    for (int i = 0; i < ncode; i++) {
+      lengths[kOrder[i]] = static_cast<uint8_t>(bits(3));
+    }
+    Huffman lencode, distcode;
+    if (!build(lencode, lengths.data(), 19)) {
+      return false;
     }
-    return escaped;
-  }
 
-  // 验证URL格式
-  // 在 SafeCommandExecutor 类中修改 is_valid_url 函数
-  static bool is_valid_url(const std::string &url) {
-    // 更简单但更健壮的URL验证
-    try {
-      // 基本检查：URL必须以http://或https://开头
-      if (url.find("http://") != 0 && url.find("https://") != 0) {
+    int index = 0;
+    while (index < nlen + ndist) {
+      int sym = decode(lencode);
+      if (sym < 0 || overrun_ > 8) {
         return false;
       }
-
-      // 检查是否包含空格或控制字符
-      for (char c : url) {
-        if (std::isspace(c) || c < 0x20) {
+      if (sym < 16) {
+        lengths[index++] = static_cast<uint8_t>(sym);
+        continue;
+      }
+      uint8_t len = 0;
+      int repeat;
+      if (sym == 16) {
+        if (index == 0) {
           return false;
         }
+        len = lengths[index - 1];
+        repeat = 3 + bits(2);
+      } else if (sym == 17) {
+        repeat = 3 + bits(3);
+      } else {
+        repeat = 11 + bits(7);
       }
-
-      // 检查是否包含可疑字符
-      if (url.find("..") != std::string::npos ||
-          url.find(";") != std::string::npos ||
-          url.find("|") != std::string::npos ||
-          url.find("`") != std::string::npos ||
-          url.find("$") != std::string::npos ||
-          url.find("(") != std::string::npos ||
-          url.find(")") != std::string::npos) {
+      if (index + repeat > nlen + ndist) {
         return false;
       }
-
-      // 对于已知的安全URL模式，直接放行
-      if (url.find("https://github.com/") == 0 ||
-          url.find("https://archives.boost.io/") == 0 ||
-          url.find("https://www.libsdl.org/") == 0) {
-        return true;
+      while (repeat--) {
+        lengths[index++] = len;
       }
-
-      // 其他URL需要更严格的检查
-      static const std::regex domain_regex(
-          R"([a-zA-Z0-9][a-zA-Z0-9-]{1,61}[a-zA-Z0-9]\.[a-zA-Z]{2,})");
-
-      // 提取域名部分
-      size_t start = url.find("://") + 3;
-      size_t end = url.find('/', start);
-      if (end == std::string::npos)
-        end = url.length();
-
-      std::string domain = url.substr(start, end - start);
-
-      // 验证域名格式
-      return std::regex_match(domain, domain_regex);
-    } catch (const std::exception &e) {
-      std::cerr << "URL validation error: " << e.what() << "\n";
-      return false;
     }
-  }
-
-  // 验证参数安全性
-  static bool is_safe_argument(const std::string &arg) {
-    // 禁止命令分隔符
-    if (arg.find(';') != std::string::npos ||
-        arg.find('|') != std::string::npos ||
-        arg.find('&') != std::string::npos ||
-        arg.find('$') != std::string::npos ||
-        arg.find('`') != std::string::npos ||
-        arg.find('>') != std::string::npos ||
-        arg.find('<') != std::string::npos) {
-      return false;
+    if (lengths[256] == 0) {
+      return false; // 缺少块结束码
     }
 
-    // 禁止目录遍历
-    if (arg.find("..") != std::string::npos) {
+    if (!build(lencode, lengths.data(), nlen) ||
+        !build(distcode, lengths.data() + nlen, ndist)) {
       return false;
     }
+    return codes(lencode, distcode);
+  }
 
+  bool run() {
+    bool last = false;
+    while (!last) {
+      last = bits(1) != 0;
+      uint32_t type = bits(2);
+      bool ok = false;
+      if (type == 0) {
+        ok = stored();
+      } else if (type == 1) {
+        ok = fixed();
+      } else if (type == 2) {
+        ok = dynamic();
+      }
+      if (!ok || overrun_ > 8) {
+        return false;
+      }
+    }
     return true;
   }
 };
 
-// 实用工具类
-class Utils {
+// 只读内存映射文件
+class MappedFile {
 public:
-  // 清理路径输入
-  static std::string clean_path(const std::string &input) {
-    std::string cleaned = input;
+  explicit MappedFile(const fs::path &path) {
+#ifdef _WIN32
+    file_ = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("Can't open the file: " + path.string());
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ > 0) {
+      mapping_ =
+          CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping_ != nullptr) {
+        data_ = static_cast<const uint8_t *>(
+            MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+      }
+      if (data_ == nullptr) {
+        close();
+        throw std::runtime_error("Can't map the file: " + path.string());
+      }
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      throw std::runtime_error("Can't open the file: " + path.string());
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+      close();
+      throw std::runtime_error("Can't stat the file: " + path.string());
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+      if (addr == MAP_FAILED) {
+        close();
+        throw std::runtime_error("Can't map the file: " + path.string());
+      }
+      data_ = static_cast<const uint8_t *>(addr);
+    }
+#endif
+  }
 
-    // 替换反斜杠为正斜杠
-    std::replace(cleaned.begin(), cleaned.end(), '\\', '/');
+  ~MappedFile() { close(); }
 
-    // 移除末尾的斜杠
-    if (!cleaned.empty() && cleaned.back() == '/' && cleaned.size() > 1) {
-      cleaned.pop_back();
-    }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
 
-    return cleaned;
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+
+  void close() {
+    if (data_ != nullptr)
+      UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+      CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+      CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+  }
+#else
+  int fd_ = -1;
+
+  void close() {
+    if (data_ != nullptr)
+      munmap(const_cast<uint8_t *>(data_), size_);
+    if (fd_ >= 0)
+      ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
   }
+#endif
+};
 
-  // 获取有效项目名称
-  static std::string get_valid_name(const std::string &input) {
-    if (input.find_first_of(";&|<>`$()") != std::string::npos) {
-      throw std::invalid_argument("Invalid characters in project name");
+// 进程级任务调度器。CPU任务（生成、校验、解压、清理）在固定数量的工作线程上
+// 执行：每个工作线程有自己的双端队列，本线程从队尾取（后进先出），空闲线程
+// 从其他队列队首窃取。会阻塞在网络或外部事件上的任务用submit_blocking交给
+// 按需增长、可复用的阻塞线程，不占用CPU工作线程。
+// 在工作线程中等待任务结果时会帮忙执行其他任务，嵌套并行不会死锁
+class TaskScheduler {
+public:
+  using Job = std::function<void()>;
+
+  // 任务状态（不透明）：完成标志、异常和完成后执行的回调
+  class TaskState {
+  public:
+    bool ready() const {
+      std::lock_guard<std::mutex> lock(mtx_);
+      return ready_;
     }
-    std::string name = input;
 
-    // 移除非字母数字字符（允许连字符和下划线）
-    name.erase(std::remove_if(name.begin(), name.end(),
-                              [](char c) {
-                                return !(std::isalnum(c) || c == '-' ||
-                                         c == '_' || c == ' ');
-                              }),
-               name.end());
+  private:
+    friend class TaskScheduler;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    bool ready_ = false;
+    std::exception_ptr error_;
+    std::vector<Job> continuations_;
+
+    void complete() {
+      std::vector<Job> pending;
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ready_ = true;
+        pending.swap(continuations_);
+      }
+      cv_.notify_all();
+      for (auto &job : pending) {
+        job();
+      }
+    }
 
-    // 替换空格为连字符
-    std::replace(name.begin(), name.end(), ' ', '-');
+    // 完成时执行job；已完成则立即执行
+    void on_ready(Job job) {
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!ready_) {
+          continuations_.push_back(std::move(job));
+          return;
+        }
+      }
+      job();
+    }
+  };
+  using Handle = std::shared_ptr<TaskState>;
 
-    // 转换为小写
-    std::transform(name.begin(), name.end(), name.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+  template <typename T> class Future {
+  public:
+    Future() = default;
 
-    return name;
+    bool valid() const { return state_ != nullptr; }
+    bool ready() const { return state_->ready(); }
+    Handle handle() const { return state_; }
+
+    void wait() const { TaskScheduler::instance().wait_for(*state_); }
+
+    // 等待并取得结果；任务抛出的异常在这里重新抛出
+    T get() const {
+      wait();
+      if (state_->error_) {
+        std::rethrow_exception(state_->error_);
+      }
+      if constexpr (!std::is_void_v<T>) {
+        return *state_->value;
+      }
+    }
+
+    // 完成后在工作线程上执行f(*this)
+    template <typename F> auto then(F f) const {
+      Future self = *this;
+      return TaskScheduler::instance().submit_after(
+          {state_}, [self, f = std::move(f)]() mutable { return f(self); });
+    }
+
+  private:
+    friend class TaskScheduler;
+    struct State : TaskState {
+      std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+    };
+    std::shared_ptr<State> state_;
+  };
+
+  // 在首次使用前设置CPU工作线程数，0表示按CPU核数
+  static void configure(unsigned threads) { configured_threads_ = threads; }
+
+  static TaskScheduler &instance() {
+    static TaskScheduler scheduler(configured_threads_ > 0
+                                       ? configured_threads_
+                                       : std::thread::hardware_concurrency());
+    return scheduler;
   }
 
-  // 检查编译器是否支持指定标准
-  static bool is_standard_supported(const CompilerConfig &compiler,
-                                    const std::string &standard) {
-    // 简化实现：实际项目中应调用编译器获取支持的标准列表
-    return true;
+  ~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mtx_);
+      stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+    {
+      std::lock_guard<std::mutex> lock(blocking_mtx_);
+      blocking_stopping_ = true;
+    }
+    blocking_cv_.notify_all();
+    for (auto &thread : blocking_threads_) {
+      thread.join();
+    }
   }
 
-  // 安全执行系统命令
-  static int execute_command(const std::string &command) {
-    std::cout << "Executing: " << command << std::endl;
-    return std::system(command.c_str());
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  size_t worker_count() const { return workers_.size(); }
+
+  // 提交CPU任务
+  template <typename F> auto submit(F f) {
+    auto [future, job] = package(std::move(f));
+    push(std::move(job));
+    return future;
   }
 
-  // 安全执行命令（使用SafeCommandExecutor）
-  static std::string
-  safe_execute_command(const std::vector<std::string> &args) {
-    return SafeCommandExecutor::execute(args);
+  // 提交可能长时间阻塞的任务（网络、等待其他进程）
+  template <typename F> auto submit_blocking(F f) {
+    auto [future, job] = package(std::move(f));
+    {
+      std::lock_guard<std::mutex> lock(blocking_mtx_);
+      blocking_jobs_.push_back(std::move(job));
+      if (blocking_jobs_.size() > blocking_idle_) {
+        blocking_threads_.emplace_back([this] { blocking_loop(); });
+        return future;
+      }
+    }
+    blocking_cv_.notify_one();
+    return future;
   }
 
-  // 安全下载文件
-  static bool safe_download_file(const std::string &url,
-                                 const fs::path &output_path) {
-    return SafeCommandExecutor::download_file(url, output_path);
+  // 所有前置任务完成后提交CPU任务（前置任务失败也会执行，由f自行检查）
+  template <typename F>
+  auto submit_after(const std::vector<Handle> &prerequisites, F f) {
+    auto [future, job] = package(std::move(f));
+    auto shared_job = std::make_shared<Job>(std::move(job));
+    auto remaining = std::make_shared<std::atomic<size_t>>(
+        prerequisites.size() + 1);
+    auto release = [this, shared_job, remaining] {
+      if (--*remaining == 0) {
+        push(std::move(*shared_job));
+      }
+    };
+    for (const auto &prerequisite : prerequisites) {
+      prerequisite->on_ready(release);
+    }
+    release();
+    return future;
   }
 
-  // 安全解压文件
-  static bool safe_unzip_file(const fs::path &zip_file,
-                              const fs::path &output_dir) {
-    return SafeCommandExecutor::unzip_file(zip_file, output_dir);
+private:
+  // 工作线程的任务队列
+  struct Queue {
+    std::mutex mtx;
+    std::deque<Job> jobs;
+  };
+
+  static unsigned configured_threads_;
+  // 当前线程所属的调度器和队列下标（非工作线程为-1）
+  static thread_local TaskScheduler *current_scheduler_;
+  static thread_local int current_index_;
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  Queue injection_; // 非工作线程提交的任务
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> pending_{0};
+  std::mutex sleep_mtx_;
+  std::condition_variable sleep_cv_;
+  bool stopping_ = false;
+
+  std::mutex blocking_mtx_;
+  std::condition_variable blocking_cv_;
+  std::deque<Job> blocking_jobs_;
+  std::vector<std::thread> blocking_threads_;
+  size_t blocking_idle_ = 0;
+  bool blocking_stopping_ = false;
+
+  explicit TaskScheduler(unsigned threads) {
+    threads = std::max(1u, threads);
+    for (unsigned i = 0; i < threads; i++) {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+      workers_.emplace_back([this, i] { worker_loop(static_cast<int>(i)); });
+    }
   }
 
-  // 安全创建目录
-  static bool safe_create_directory(const fs::path &path) {
-    return SafeCommandExecutor::safe_create_directory(path);
+  // 把f包装为写入任务状态的Job
+  template <typename F> static auto package(F f) {
+    using T = std::invoke_result_t<F &>;
+    Future<T> future;
+    future.state_ = std::make_shared<typename Future<T>::State>();
+    Job job = [state = future.state_, f = std::move(f)]() mutable {
+      try {
+        if constexpr (std::is_void_v<T>) {
+          f();
+          state->value = true;
+        } else {
+          state->value = f();
+        }
+      } catch (...) {
+        state->error_ = std::current_exception();
+      }
+      state->complete();
+    };
+    return std::make_pair(std::move(future), std::move(job));
   }
 
-  // 跨平台路径拼接
-  static fs::path join_paths(const fs::path &base, const std::string &part) {
-    return base / part;
+  bool on_worker() const {
+    return current_scheduler_ == this && current_index_ >= 0;
   }
 
-  // 安全写入文件
-  static bool safe_write_file(const fs::path &path,
-                              const std::string &content) {
-    try {
-      std::ofstream file(path);
-      if (!file)
+  void push(Job job) {
+    Queue &queue = on_worker() ? *queues_[current_index_] : injection_;
+    pending_++;
+    {
+      std::lock_guard<std::mutex> lock(queue.mtx);
+      queue.jobs.push_back(std::move(job));
+    }
+    { std::lock_guard<std::mutex> lock(sleep_mtx_); }
+    sleep_cv_.notify_one();
+  }
+
+  // 依次尝试：自己队列的队尾、注入队列、窃取其他队列的队首
+  bool take(int index, Job &job) {
+    auto pop = [&job](Queue &queue, bool back) {
+      std::lock_guard<std::mutex> lock(queue.mtx);
+      if (queue.jobs.empty()) {
         return false;
-      file << content;
+      }
+      if (back) {
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+      } else {
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+      }
       return true;
-    } catch (const std::exception &e) {
-      std::cerr << "Error writing file: " << e.what() << std::endl;
-      return false;
+    };
+    const size_t count = queues_.size();
+    bool found = pop(*queues_[index], true) || pop(injection_, false);
+    for (size_t i = 1; !found && i < count; i++) {
+      found = pop(*queues_[(index + i) % count], false);
     }
+    if (found) {
+      pending_--;
+    }
+    return found;
   }
 
-  // 安全读取文件
-  static std::string safe_read_file(const fs::path &path) {
-    try {
-      std::ifstream file(path);
-      if (!file)
-        return "";
-      std::string content((std::istreambuf_iterator<char>(file)),
-                          std::istreambuf_iterator<char>());
-      return content;
-    } catch (const std::exception &e) {
-      std::cerr << "Error reading file: " << e.what() << std::endl;
-      return "";
+  void worker_loop(int index) {
+    current_scheduler_ = this;
+    current_index_ = index;
+    Job job;
+    while (true) {
+      if (take(index, job)) {
+        job();
+        job = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mtx_);
+      sleep_cv_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+      if (stopping_ && pending_ == 0) {
+        return;
+      }
     }
   }
 
-  // 简单字符串修剪
-  static std::string trim(const std::string &str) {
-    auto start = std::find_if_not(str.begin(), str.end(),
-                                  [](int c) { return std::isspace(c); });
-    auto end = std::find_if_not(str.rbegin(), str.rend(), [](int c) {
-                 return std::isspace(c);
-               }).base();
-    return (start < end) ? std::string(start, end) : std::string();
+  // 工作线程等待时帮忙执行任务；其他线程直接阻塞等待
+  void wait_for(TaskState &state) {
+    if (!on_worker()) {
+      std::unique_lock<std::mutex> lock(state.mtx_);
+      state.cv_.wait(lock, [&state] { return state.ready_; });
+      return;
+    }
+    Job job;
+    while (!state.ready()) {
+      if (take(current_index_, job)) {
+        job();
+        job = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(state.mtx_);
+      state.cv_.wait_for(lock, std::chrono::milliseconds(1),
+                         [&state] { return state.ready_; });
+    }
   }
 
-  // 解析简单JSON
-  static std::unordered_map<std::string, std::string>
-  parse_simple_json(const std::string &json) {
-    try {
-      // 简化实现，实际项目中应使用完整JSON解析器
-      std::unordered_map<std::string, std::string> result;
-      std::istringstream stream(json);
-      std::string line;
-
-      while (std::getline(stream, line)) {
-        line = trim(line);
-        if (line.empty() || line == "{" || line == "}")
-          continue;
-
-        // 移除逗号和引号
-        line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-        line.erase(std::remove(line.begin(), line.end(), ','), line.end());
-
-        // 分割键值对
-        size_t colon_pos = line.find(':');
-        if (colon_pos != std::string::npos) {
-          std::string key = trim(line.substr(0, colon_pos));
-          std::string value = trim(line.substr(colon_pos + 1));
-          result[key] = value;
-        }
+  void blocking_loop() {
+    std::unique_lock<std::mutex> lock(blocking_mtx_);
+    while (true) {
+      blocking_idle_++;
+      blocking_cv_.wait(lock, [this] {
+        return !blocking_jobs_.empty() || blocking_stopping_;
+      });
+      blocking_idle_--;
+      if (blocking_jobs_.empty()) {
+        return;
       }
-
-      return result;
-    } catch (const std::exception &e) {
-      std::cerr << "JSON parse error: " << e.what() << std::endl;
-      return {};
+      Job job = std::move(blocking_jobs_.front());
+      blocking_jobs_.pop_front();
+      lock.unlock();
+      job();
+      job = nullptr;
+      lock.lock();
     }
   }
 };
 
-// 库信息提供者接口
-class ILibraryInfoProvider {
+unsigned TaskScheduler::configured_threads_ = 0;
+thread_local TaskScheduler *TaskScheduler::current_scheduler_ = nullptr;
+thread_local int TaskScheduler::current_index_ = -1;
+
+// 内置ZIP解压类（中央目录 + 多线程并行解压）
+class ZipExtractor {
 public:
-  virtual ~ILibraryInfoProvider() = default;
+  struct Entry {
+    std::string name;
+    uint16_t method = 0;
+    uint16_t flags = 0;
+    uint32_t crc32 = 0;
+    uint64_t compressed_size = 0;
+    uint64_t uncompressed_size = 0;
+    uint64_t local_header_offset = 0;
+    uint32_t unix_mode = 0;
+    bool is_directory = false;
+  };
 
-  // 获取所有可用库的名称列表
-  virtual std::vector<std::string> get_available_libraries() = 0;
+  // 选择性解压过滤器（glob：* 不跨目录，** 跨目录，? 单个字符）
+  struct Filter {
+    std::vector<std::string> include; // 为空表示全部包含
+    std::vector<std::string> exclude;
+
+    // 目录名不带末尾斜杠；目录同时按"name/"匹配，使"prefix/**"也选中目录本身
+    bool accepts(const std::string &name, bool is_directory = false) const {
+      const std::string dir = is_directory ? name + "/" : std::string();
+      auto matches = [&](const std::string &pattern) {
+        return glob_match(pattern.c_str(), name.c_str()) ||
+               (is_directory && glob_match(pattern.c_str(), dir.c_str()));
+      };
+      if (!include.empty() &&
+          std::none_of(include.begin(), include.end(), matches)) {
+        return false;
+      }
+      return std::none_of(exclude.begin(), exclude.end(), matches);
+    }
 
-  // 获取指定库的详细信息
-  virtual std::optional<ThirdPartyLibrary>
-  get_library_info(const std::string &lib_name) = 0;
+    bool empty() const { return include.empty() && exclude.empty(); }
 
-  // 刷新库信息（从远程源更新）
-  virtual bool refresh_library_info() = 0;
+    // 过滤规则的稳定标识（用于区分共享存储中的不同解压结果）
+    std::string signature() const {
+      std::string joined;
+      for (const auto &pattern : include) {
+        joined += "+" + pattern + "\n";
+      }
+      for (const auto &pattern : exclude) {
+        joined += "-" + pattern + "\n";
+      }
+      std::ostringstream hex;
+      hex << std::hex << std::setfill('0') << std::setw(8)
+          << CRC32::update(0, reinterpret_cast<const uint8_t *>(joined.data()),
+                           joined.size());
+      return hex.str();
+    }
 
-  // 获取提供者名称
-  virtual std::string get_provider_name() const = 0;
-};
+    static bool glob_match(const char *p, const char *s) {
+      while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+          p += 2;
+          if (*p == '/') {
+            // "**/" 匹配零个或多个完整目录
+            p++;
+            for (const char *t = s;; t++) {
+              if (glob_match(p, t))
+                return true;
+              t = std::strchr(t, '/');
+              if (t == nullptr)
+                return false;
+            }
+          }
+          for (const char *t = s;; t++) {
+            if (glob_match(p, t))
+              return true;
+            if (*t == '\0')
+              return false;
+          }
+        }
+        if (*p == '*') {
+          p++;
+          for (const char *t = s;; t++) {
+            if (glob_match(p, t))
+              return true;
+            if (*t == '\0' || *t == '/')
+              return false;
+          }
+        }
+        if (*s == '\0' || (*p == '?' ? *s == '/' : *p != *s)) {
+          return false;
+        }
+        p++;
+        s++;
+      }
+      return *s == '\0';
+    }
+  };
 
-// 内置库信息提供者
-class BuiltinLibraryProvider : public ILibraryInfoProvider {
-public:
-  std::vector<std::string> get_available_libraries() override {
-    std::vector<std::string> libs;
-    for (const auto &pair : Constants::BUILTIN_LIBRARIES) {
-      libs.push_back(pair.first);
+  struct Result {
+    size_t files = 0;
+    size_t directories = 0;
+    size_t skipped = 0;
+    uint64_t bytes = 0;
+    size_t unsupported = 0;
+    std::vector<std::string> failures;
+
+    bool ok() const { return failures.empty() && unsupported == 0; }
+  };
+
+  // 解析中央目录（不读取文件数据）
+  static std::vector<Entry> list_entries(const MappedFile &zip) {
+    const uint8_t *data = zip.data();
+    const size_t size = zip.size();
+    if (size < 22) {
+      throw std::runtime_error("File too small to be a zip archive");
     }
-    return libs;
-  }
 
-  std::optional<ThirdPartyLibrary>
-  get_library_info(const std::string &lib_name) override {
-    auto it = Constants::BUILTIN_LIBRARIES.find(lib_name);
-    if (it != Constants::BUILTIN_LIBRARIES.end()) {
-      return it->second;
+    // 从文件尾部反向查找中央目录结束记录
+    size_t eocd = std::string::npos;
+    size_t lower = size > 22 + 0xFFFF ? size - 22 - 0xFFFF : 0;
+    for (size_t pos = size - 22 + 1; pos-- > lower;) {
+      if (read32(data + pos) == 0x06054b50) {
+        eocd = pos;
+        break;
+      }
+    }
+    if (eocd == std::string::npos) {
+      throw std::runtime_error("End of central directory not found");
     }
-    return std::nullopt;
-  }
 
-  bool refresh_library_info() override {
-    // 内置库不需要刷新
-    return true;
-  }
+    uint64_t count = read16(data + eocd + 10);
+    uint64_t cd_size = read32(data + eocd + 12);
+    uint64_t cd_offset = read32(data + eocd + 16);
+
+    // ZIP64扩展
+    if ((count == 0xFFFF || cd_size == 0xFFFFFFFF ||
+         cd_offset == 0xFFFFFFFF) &&
+        eocd >= 20 && read32(data + eocd - 20) == 0x07064b50) {
+      uint64_t z64 = read64(data + eocd - 20 + 8);
+      if (z64 + 56 > size || read32(data + z64) != 0x06064b50) {
+        throw std::runtime_error("Corrupt zip64 end of central directory");
+      }
+      count = read64(data + z64 + 32);
+      cd_size = read64(data + z64 + 40);
+      cd_offset = read64(data + z64 + 48);
+    }
+    if (cd_offset + cd_size > size) {
+      throw std::runtime_error("Central directory out of range");
+    }
 
-  std::string get_provider_name() const override {
-    return "Built-in Library Provider";
-  }
-};
+    std::vector<Entry> entries;
+    entries.reserve(static_cast<size_t>(count));
+    size_t pos = static_cast<size_t>(cd_offset);
+    const size_t cd_end = static_cast<size_t>(cd_offset + cd_size);
+    for (uint64_t i = 0; i < count; i++) {
+      if (pos + 46 > cd_end || read32(data + pos) != 0x02014b50) {
+        throw std::runtime_error("Corrupt central directory entry");
+      }
+      const uint8_t *h = data + pos;
+      uint16_t name_len = read16(h + 28);
+      uint16_t extra_len = read16(h + 30);
+      uint16_t comment_len = read16(h + 32);
+      if (pos + 46 + name_len + extra_len + comment_len > cd_end) {
+        throw std::runtime_error("Corrupt central directory entry");
+      }
 
-// 远程库信息提供者
-class RemoteLibraryProvider : public ILibraryInfoProvider {
-public:
-  RemoteLibraryProvider(const std::string &mirror_url)
-      : mirror_url_(ensure_trailing_slash(mirror_url)) {}
+      Entry entry;
+      entry.flags = read16(h + 8);
+      entry.method = read16(h + 10);
+      entry.crc32 = read32(h + 16);
+      entry.compressed_size = read32(h + 20);
+      entry.uncompressed_size = read32(h + 24);
+      entry.local_header_offset = read32(h + 42);
+      entry.name.assign(reinterpret_cast<const char *>(h + 46), name_len);
+      std::replace(entry.name.begin(), entry.name.end(), '\\', '/');
+      entry.is_directory = !entry.name.empty() && entry.name.back() == '/';
+      if ((read16(h + 4) >> 8) == 3) { // 由Unix创建，外部属性高16位为mode
+        entry.unix_mode = read32(h + 38) >> 16;
+      }
 
-  std::vector<std::string> get_available_libraries() override {
-    if (available_libraries_.empty()) {
-      refresh_library_info();
+      // ZIP64扩展字段
+      const uint8_t *extra = h + 46 + name_len;
+      for (size_t off = 0; off + 4 <= extra_len;) {
+        uint16_t id = read16(extra + off);
+        uint16_t len = read16(extra + off + 2);
+        if (off + 4 + len > extra_len) {
+          break;
+        }
+        if (id == 0x0001) {
+          const uint8_t *field = extra + off + 4;
+          const uint8_t *field_end = field + len;
+          if (entry.uncompressed_size == 0xFFFFFFFF && field + 8 <= field_end) {
+            entry.uncompressed_size = read64(field);
+            field += 8;
+          }
+          if (entry.compressed_size == 0xFFFFFFFF && field + 8 <= field_end) {
+            entry.compressed_size = read64(field);
+            field += 8;
+          }
+          if (entry.local_header_offset == 0xFFFFFFFF &&
+              field + 8 <= field_end) {
+            entry.local_header_offset = read64(field);
+          }
+        }
+        off += 4 + len;
+      }
+
+      entries.push_back(std::move(entry));
+      pos += 46 + name_len + extra_len + comment_len;
     }
-    return available_libraries_;
+    return entries;
   }
 
-  std::optional<ThirdPartyLibrary>
-  get_library_info(const std::string &lib_name) override {
-    // 首先检查缓存
-    auto it = library_cache_.find(lib_name);
-    if (it != library_cache_.end()) {
-      return it->second;
+  // 解压整个压缩包到输出目录
+  static Result extract(const fs::path &zip_file, const fs::path &output_dir,
+                        const Filter &filter = {}, unsigned thread_count = 0) {
+    MappedFile zip(zip_file);
+    std::vector<Entry> entries = list_entries(zip);
+    Result result;
+
+    // 校验条目路径，并批量收集需要创建的目录
+    std::set<std::string> directories;
+    std::vector<const Entry *> files;
+    files.reserve(entries.size());
+    for (const auto &entry : entries) {
+      if (!is_safe_entry_name(entry.name)) {
+        result.failures.push_back(entry.name + ": unsafe path in archive");
+        continue;
+      }
+      // 未选中的条目既不解压也不写入
+      if (!filter.empty() &&
+          !filter.accepts(entry.is_directory
+                              ? entry.name.substr(0, entry.name.size() - 1)
+                              : entry.name,
+                          entry.is_directory)) {
+        result.skipped++;
+        continue;
+      }
+      if (entry.is_directory) {
+        directories.insert(entry.name.substr(0, entry.name.size() - 1));
+        continue;
+      }
+      if (entry.flags & 0x1) {
+        result.failures.push_back(entry.name + ": encrypted entries are "
+                                               "not supported");
+        continue;
+      }
+      if (entry.method != 0 && entry.method != 8) {
+        result.unsupported++;
+        continue;
+      }
+      size_t slash = entry.name.rfind('/');
+      if (slash != std::string::npos) {
+        directories.insert(entry.name.substr(0, slash));
+      }
+      files.push_back(&entry);
     }
-
-    // 从远程获取库信息
-    std::string lib_info_url = mirror_url_ + lib_name + ".json";
-    fs::path temp_file = fs::temp_directory_path() / (lib_name + "_info.json");
-
-    if (!Utils::safe_download_file(lib_info_url, temp_file)) {
-      std::cerr << "Failed to download library info for " << lib_name
-                << std::endl;
-      return std::nullopt;
+    if (result.unsupported > 0) {
+      return result;
     }
 
-    std::string json_content = Utils::safe_read_file(temp_file);
-    if (json_content.empty()) {
-      std::cerr << "Failed to read library info for " << lib_name << std::endl;
-      return std::nullopt;
+    // 有序集合保证父目录先于子目录创建
+    for (const auto &dir : directories) {
+      std::error_code ec;
+      fs::create_directories(output_dir / dir, ec);
+      if (ec) {
+        result.failures.push_back(dir + "/: " + ec.message());
+      }
     }
+    result.directories = directories.size();
 
-    // 解析JSON
-    auto json_map = Utils::parse_simple_json(json_content);
-    ThirdPartyLibrary lib_info;
-    lib_info.name = json_map["name"];
-    lib_info.downloadUrl = json_map["downloadUrl"];
-    lib_info.includePath = json_map["includePath"];
-    lib_info.libPath = json_map["libPath"];
-    lib_info.configInstructions = json_map["configInstructions"];
-    lib_info.sha256 = json_map["sha256"];
+    // 大文件优先，使各线程负载均衡
+    std::sort(files.begin(), files.end(), [](const Entry *a, const Entry *b) {
+      return a->compressed_size > b->compressed_size;
+    });
+
+    auto &scheduler = TaskScheduler::instance();
+    if (thread_count == 0) {
+      thread_count = static_cast<unsigned>(scheduler.worker_count());
+    }
+    thread_count = static_cast<unsigned>(
+        std::min<size_t>(thread_count, std::max<size_t>(1, files.size())));
+
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> bytes{0};
+    std::mutex failures_mutex;
+    auto worker = [&]() {
+      std::vector<uint8_t> buffer;
+      for (size_t i = next++; i < files.size(); i = next++) {
+        std::string error;
+        if (extract_entry(zip, *files[i], output_dir, buffer, error)) {
+          bytes += files[i]->uncompressed_size;
+        } else {
+          std::lock_guard<std::mutex> lock(failures_mutex);
+          result.failures.push_back(files[i]->name + ": " + error);
+        }
+      }
+    };
 
-    // 解析依赖项
-    std::istringstream deps_stream(json_map["dependencies"]);
-    std::string dep;
-    while (std::getline(deps_stream, dep, ',')) {
-      lib_info.dependencies.push_back(Utils::trim(dep));
+    std::vector<TaskScheduler::Future<void>> workers;
+    for (unsigned i = 1; i < thread_count; i++) {
+      workers.push_back(scheduler.submit(worker));
+    }
+    worker();
+    for (auto &w : workers) {
+      w.wait();
     }
 
-    // 添加到缓存
-    library_cache_[lib_name] = lib_info;
+    result.files = files.size();
+    result.bytes = bytes;
+    return result;
+  }
 
-    // 删除临时文件
-    fs::remove(temp_file);
+private:
+  static uint16_t read16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
 
-    return lib_info;
+  static uint32_t read32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
   }
 
-  bool refresh_library_info() override {
-    // 下载库列表
-    std::string list_url = mirror_url_ + "libraries.json";
-    fs::path temp_file = fs::temp_directory_path() / "library_list.json";
+  static uint64_t read64(const uint8_t *p) {
+    return static_cast<uint64_t>(read32(p)) |
+           static_cast<uint64_t>(read32(p + 4)) << 32;
+  }
 
-    if (!Utils::safe_download_file(list_url, temp_file)) {
-      std::cerr << "Failed to download library list" << std::endl;
+  // 拒绝绝对路径和目录遍历（zip slip）
+  static bool is_safe_entry_name(const std::string &name) {
+    if (name.empty() || name[0] == '/' || name.find(':') != std::string::npos) {
       return false;
     }
-
-    std::string json_content = Utils::safe_read_file(temp_file);
-    if (json_content.empty()) {
-      std::cerr << "Failed to read library list" << std::endl;
-      return false;
+    std::istringstream stream(name);
+    std::string part;
+    while (std::getline(stream, part, '/')) {
+      if (part == "..") {
+        return false;
+      }
     }
+    return true;
+  }
 
-    // 解析库列表
-    available_libraries_.clear();
-    std::istringstream stream(json_content);
-    std::string line;
-
-    while (std::getline(stream, line)) {
-      line = Utils::trim(line);
-      if (line.empty() || line == "[" || line == "]")
-        continue;
-
-      // 移除引号和逗号
-      line.erase(std::remove(line.begin(), line.end(), '"'), line.end());
-      line.erase(std::remove(line.begin(), line.end(), ','), line.end());
+  static bool extract_entry(const MappedFile &zip, const Entry &entry,
+                            const fs::path &output_dir,
+                            std::vector<uint8_t> &buffer, std::string &error) {
+    const uint8_t *data = zip.data();
+    const uint64_t lh = entry.local_header_offset;
+    if (lh + 30 > zip.size() || read32(data + lh) != 0x04034b50) {
+      error = "corrupt local header";
+      return false;
+    }
+    const uint64_t start = lh + 30 + read16(data + lh + 26) +
+                           read16(data + lh + 28);
+    if (start + entry.compressed_size > zip.size()) {
+      error = "entry data out of range";
+      return false;
+    }
 
-      if (!line.empty()) {
-        available_libraries_.push_back(line);
+    const uint8_t *content = data + start;
+    const size_t size = static_cast<size_t>(entry.uncompressed_size);
+    if (entry.method == 0) {
+      if (entry.compressed_size != entry.uncompressed_size) {
+        error = "stored entry size mismatch";
+        return false;
+      }
+    } else {
+      buffer.resize(size);
+      auto produced = Inflater::inflate(
+          content, static_cast<size_t>(entry.compressed_size), buffer.data(),
+          size);
+      if (!produced || *produced != size) {
+        error = "corrupt deflate stream";
+        return false;
       }
+      content = buffer.data();
     }
 
-    // 删除临时文件
-    fs::remove(temp_file);
+    uint32_t crc = CRC32::update(0, content, size);
+    if (crc != entry.crc32) {
+      std::ostringstream msg;
+      msg << std::hex << std::setfill('0') << "CRC mismatch (expected "
+          << std::setw(8) << entry.crc32 << ", actual " << std::setw(8) << crc
+          << ")";
+      error = msg.str();
+      return false;
+    }
 
-    return true;
+    return write_output(output_dir, entry.name, content, size,
+                        entry.unix_mode, error);
   }
 
-  std::string get_provider_name() const override {
-    return "Remote Library Provider (" + mirror_url_ + ")";
+  // 符号链接目标相对于条目所在目录解析后不得越出解压根目录
+  static bool is_safe_link_target(const std::string &name,
+                                  const std::string &target) {
+    if (target.empty() || target[0] == '/' ||
+        target.find(':') != std::string::npos) {
+      return false;
+    }
+    int depth = static_cast<int>(std::count(name.begin(), name.end(), '/'));
+    std::istringstream stream(target);
+    std::string part;
+    while (std::getline(stream, part, '/')) {
+      if (part == "..") {
+        if (--depth < 0) {
+          return false;
+        }
+      } else if (!part.empty() && part != ".") {
+        depth++;
+      }
+    }
+    return true;
   }
 
-private:
-  std::string mirror_url_;
-  std::vector<std::string> available_libraries_;
-  std::unordered_map<std::string, ThirdPartyLibrary> library_cache_;
+  static bool write_output(const fs::path &output_dir, const std::string &name,
+                           const uint8_t *content, size_t size,
+                           uint32_t unix_mode, std::string &error) {
+    const fs::path path = output_dir / name;
+#ifdef _WIN32
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      error = "can't create file";
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(content),
+               static_cast<std::streamsize>(size));
+    if (!file) {
+      error = "write failed";
+      return false;
+    }
+    return true;
+#else
+    if ((unix_mode & S_IFMT) == S_IFLNK) {
+      // 符号链接：内容为链接目标，只允许指向压缩包内部
+      std::string target(reinterpret_cast<const char *>(content), size);
+      if (!is_safe_link_target(name, target)) {
+        error = "unsafe symlink target";
+        return false;
+      }
+      std::error_code ec;
+      fs::remove(path, ec);
+      fs::create_symlink(target, path, ec);
+      if (ec) {
+        error = ec.message();
+        return false;
+      }
+      return true;
+    }
 
-  static std::string ensure_trailing_slash(const std::string &url) {
-    if (url.empty() || url.back() != '/') {
-      return url + '/';
+    mode_t mode = (unix_mode & 0111) ? 0755 : 0644;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    mode);
+    if (fd < 0) {
+      error = std::strerror(errno);
+      return false;
     }
-    return url;
+#ifdef __linux__
+    // 预分配文件大小，减少碎片和元数据更新
+    if (size > 0) {
+      posix_fallocate(fd, 0, static_cast<off_t>(size));
+    }
+#endif
+    size_t written = 0;
+    while (written < size) {
+      ssize_t n = ::write(fd, content + written, size - written);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        error = std::strerror(errno);
+        ::close(fd);
+        return false;
+      }
+      written += static_cast<size_t>(n);
+    }
+    if (::close(fd) != 0) {
+      error = std::strerror(errno);
+      return false;
+    }
+    return true;
+#endif
   }
 };
 
-// 编译器服务类
-class CompilerService {
+#ifndef _WIN32
+// 取消令牌：竞速或对冲请求中落败的一方通过它中止进行中的连接和子进程。
+// 阻塞操作从当前线程的令牌（由Scope设置）登记中止动作
+class CancellationToken {
 public:
-  // 获取编译器配置
-  static CompilerConfig get_compiler_config() {
-    CompilerConfig config;
+  class Scope {
+  public:
+    explicit Scope(std::shared_ptr<CancellationToken> token)
+        : previous_(std::move(current_)) {
+      current_ = std::move(token);
+    }
+    ~Scope() { current_ = std::move(previous_); }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
 
-    std::cout << "\n=== Compiler Configuration ===\n";
+  private:
+    std::shared_ptr<CancellationToken> previous_;
+  };
 
-    // 选择编译器类型
-    std::cout << "Select compiler type:\n";
-    std::cout << "1. gcc\n";
-    std::cout << "2. g++\n";
-    std::cout << "3. clang\n";
-    std::cout << "4. clang++\n";
-    std::cout << "5. MSVC (Visual Studio)\n";
-    std::cout << "Enter choice (1-5, default 1): ";
+  static std::shared_ptr<CancellationToken> current() { return current_; }
 
-    std::string choice;
-    std::getline(std::cin, choice);
+  bool cancelled() const { return cancelled_; }
 
-    if (choice == "2") {
-      config.type = CompilerType::GXX;
-      config.name = "g++";
-    } else if (choice == "3") {
-      config.type = CompilerType::CLANG;
-      config.name = "clang";
-    } else if (choice == "4") {
-      config.type = CompilerType::CLANGXX;
-      config.name = "clang++";
-    } else if (choice == "5") {
-      config.type = CompilerType::MSVC;
-      config.name = "cl";
-    } else {
-      config.type = CompilerType::GXX;
-      config.name = "g++";
+  void cancel() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (cancelled_.exchange(true)) {
+      return;
+    }
+    for (auto &entry : actions_) {
+      entry.second();
     }
+  }
 
-    // 获取编译器路径
-    config.path = find_compiler_path(config);
+  // 登记中止动作；已取消时立即执行并返回0
+  uint64_t on_cancel(std::function<void()> action) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (cancelled_) {
+      action();
+      return 0;
+    }
+    actions_[++next_id_] = std::move(action);
+    return next_id_;
+  }
 
-    // 选择C++标准
-    config.cppStandard = select_cpp_standard(config);
+  // 注销后保证该动作不会再被执行（持有锁执行动作，避免作用在已复用的fd上）
+  void remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    actions_.erase(id);
+  }
 
-    // 选择C标准
-    config.cStandard = select_c_standard(config);
+private:
+  std::atomic<bool> cancelled_{false};
+  std::mutex mtx_;
+  uint64_t next_id_ = 0;
+  std::map<uint64_t, std::function<void()>> actions_;
+  static thread_local std::shared_ptr<CancellationToken> current_;
+};
 
-    // 添加额外编译选项
-    std::cout << "Enter any additional compiler flags (space separated, or "
-                 "press Enter for none): ";
-    std::string extra_flags;
-    std::getline(std::cin, extra_flags);
+thread_local std::shared_ptr<CancellationToken> CancellationToken::current_;
+#endif
 
-    if (!extra_flags.empty()) {
-      std::istringstream iss(extra_flags);
-      std::string flag;
-      while (iss >> flag) {
-        config.extraArgs.push_back(flag);
-      }
+#ifndef _WIN32
+// 事件驱动的子进程管理器：单个监督线程同时管理多个子进程，
+// 将stdout/stderr分别收集到各任务的缓冲区，并支持超时与取消
+class ProcessManager {
+public:
+  struct Result {
+    int exit_code = -1;
+    int signal = 0;
+    std::string out;
+    std::string err;
+    bool timed_out = false;
+    bool cancelled = false;
+
+    bool success() const {
+      return exit_code == 0 && signal == 0 && !timed_out && !cancelled;
     }
+  };
 
-    return config;
-  }
+  struct Handle {
+    uint64_t id = 0;
+    std::shared_future<Result> result;
+  };
 
-private:
-  // 查找编译器路径
-  static std::string find_compiler_path(CompilerConfig &config) {
-    std::vector<std::string> compiler_paths;
+  static ProcessManager &instance() {
+    static ProcessManager manager;
+    return manager;
+  }
 
-    if (config.type == CompilerType::MSVC) {
-      compiler_paths = find_msvc_paths();
-    } else {
-      compiler_paths = find_compiler_in_path(config.name);
+  // 启动子进程，timeout为0表示不限时。capture_stderr为false时子进程的
+  // stderr直接输出到终端（curl进度、unzip诊断），Result::err为空
+  Handle start(const std::vector<std::string> &args,
+               std::chrono::milliseconds timeout =
+                   std::chrono::milliseconds::zero(),
+               bool capture_stderr = true) {
+    auto job = std::make_unique<Job>();
+    job->pid = spawn(args, job->out_fd, job->err_fd, capture_stderr);
+#ifdef SYS_pidfd_open
+    job->pid_fd = static_cast<int>(syscall(SYS_pidfd_open, job->pid, 0));
+#endif
+    if (timeout > std::chrono::milliseconds::zero()) {
+      job->deadline = std::chrono::steady_clock::now() + timeout;
     }
 
-    // 处理找到的编译器路径
-    if (compiler_paths.empty()) {
-      std::cout << "No " << config.name << " compiler found.\n";
-      std::cout << "Enter " << config.name << " compiler path: ";
-      std::string path;
-      std::getline(std::cin, path);
-      return Utils::clean_path(path);
-      if (path.find_first_of(";&|<>`$()") != std::string::npos) {
-        throw std::invalid_argument("Invalid characters in compiler path");
+    Handle handle;
+    handle.result = job->promise.get_future().share();
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      job->id = handle.id = ++next_id_;
+      pending_.push_back(std::move(job));
+      if (!supervisor_.joinable()) {
+        supervisor_ = std::thread([this] { run_loop(); });
       }
-      return Utils::clean_path(path);
     }
+    wake();
+    return handle;
+  }
 
-    if (compiler_paths.size() == 1) {
-      std::cout << "Using " << config.name
-                << " compiler found at: " << compiler_paths[0] << "\n";
-      return compiler_paths[0];
+  // 取消任务：先SIGTERM，宽限期后SIGKILL
+  void cancel(uint64_t id) {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      cancel_requests_.push_back(id);
     }
+    wake();
+  }
 
-    std::cout << "Multiple " << config.name << " compilers found:\n";
-    for (size_t i = 0; i < compiler_paths.size(); ++i) {
-      std::cout << "  " << i + 1 << ". " << compiler_paths[i] << "\n";
+  // 阻塞执行（其他调用者的任务仍由监督线程并行处理）
+  Result run(const std::vector<std::string> &args,
+             std::chrono::milliseconds timeout =
+                 std::chrono::milliseconds::zero(),
+             bool capture_stderr = true) {
+    Handle handle = start(args, timeout, capture_stderr);
+    // 当前线程的取消令牌可中止该子进程
+    auto token = CancellationToken::current();
+    uint64_t registration =
+        token ? token->on_cancel([this, id = handle.id] { cancel(id); }) : 0;
+    Result result = handle.result.get();
+    if (token) {
+      token->remove(registration);
     }
-    std::cout << "Select compiler (1-" << compiler_paths.size() << "): ";
-    std::string selection;
-    std::getline(std::cin, selection);
+    return result;
+  }
 
-    try {
-      size_t idx = std::stoi(selection) - 1;
-      if (idx < compiler_paths.size()) {
-        return compiler_paths[idx];
-      }
-    } catch (...) {
-      // 无效选择，使用第一个
+  ~ProcessManager() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stopping_ = true;
     }
-
-    return compiler_paths[0];
+    wake();
+    if (supervisor_.joinable()) {
+      supervisor_.join();
+    }
+    close(wake_fds_[0]);
+    if (wake_fds_[1] != wake_fds_[0]) {
+      close(wake_fds_[1]);
+    }
+#ifdef __linux__
+    close(epoll_fd_);
+#endif
   }
 
-  // 在PATH环境变量中查找编译器
-  static std::vector<std::string>
-  find_compiler_in_path(const std::string &executable_name) {
-    std::vector<std::string> found_paths;
-
-    // 获取PATH环境变量
-    const char *path_env = std::getenv("PATH");
-    if (!path_env) {
-      return found_paths;
-    }
+  ProcessManager(const ProcessManager &) = delete;
+  ProcessManager &operator=(const ProcessManager &) = delete;
 
-    std::string path_str(path_env);
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    uint64_t id = 0;
+    pid_t pid = -1;
+    int out_fd = -1;
+    int err_fd = -1;
+    int pid_fd = -1;
+    bool reaped = false;
+    bool status_lost = false; // 退出状态已被其他waitpid取走
+    int status = 0;
+    Clock::time_point deadline = Clock::time_point::max();
+    Clock::time_point kill_at = Clock::time_point::max();
+    Clock::time_point reaped_at;
+    Result result;
+    std::promise<Result> promise;
+  };
 
-    // 分割PATH字符串
-#ifdef _WIN32
-    const char delimiter = ';';
-    std::string exe_name = executable_name + ".exe";
+  // 事件标识：高位为任务ID，低2位区分stdout/stderr/pidfd
+  enum Source : uint64_t { OUT = 0, ERR = 1, PID = 2, WAKE = 3 };
+
+  static constexpr auto kKillGrace = std::chrono::seconds(2);
+  static constexpr auto kPipeGrace = std::chrono::seconds(1);
+  static constexpr int kReapTickMs = 50;
+
+  std::mutex mtx_;
+  std::thread supervisor_;
+  std::vector<std::unique_ptr<Job>> pending_;
+  std::vector<uint64_t> cancel_requests_;
+  std::map<uint64_t, std::unique_ptr<Job>> jobs_;
+  uint64_t next_id_ = 0;
+  bool stopping_ = false;
+  int wake_fds_[2] = {-1, -1};
+#ifdef __linux__
+  int epoll_fd_ = -1;
 #else
-    const char delimiter = ':';
-    std::string exe_name = executable_name;
+  std::map<int, uint64_t> watched_;
 #endif
 
-    std::istringstream path_stream(path_str);
-    std::string directory;
-
-    while (std::getline(path_stream, directory, delimiter)) {
-      fs::path dir_path(directory);
-      if (fs::exists(dir_path) && fs::is_directory(dir_path)) {
-        fs::path executable_path = dir_path / exe_name;
-        if (fs::exists(executable_path) &&
-            fs::is_regular_file(executable_path)) {
-          found_paths.push_back(Utils::clean_path(executable_path.string()));
-        }
-      }
+  ProcessManager() {
+#ifdef __linux__
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fds_[0] = wake_fds_[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ < 0 || wake_fds_[0] < 0) {
+      throw std::runtime_error("Failed to initialise process manager");
+    }
+#else
+    if (pipe(wake_fds_) != 0) {
+      throw std::runtime_error("Failed to initialise process manager");
     }
+    for (int fd : wake_fds_) {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+#endif
+    watch(wake_fds_[0], WAKE);
+  }
 
-    return found_paths;
+  void wake() {
+#ifdef __linux__
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fds_[1], &one, sizeof(one));
+#else
+    char one = 1;
+    ssize_t ignored = ::write(wake_fds_[1], &one, 1);
+#endif
+    (void)ignored;
   }
 
-  // 查找MSVC路径
-  static std::vector<std::string> find_msvc_paths() {
-    std::vector<std::string> paths;
+  void watch(int fd, uint64_t token) {
+#ifdef __linux__
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = token;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+#else
+    watched_[fd] = token;
+#endif
+  }
 
-#ifdef _WIN32
-    // 常见的Visual Studio安装路径
-    std::vector<std::string> common_paths = {
-        "C:/Program Files/Microsoft Visual Studio/2022/Community/VC/Tools/MSVC",
-        "C:/Program Files/Microsoft Visual "
-        "Studio/2022/Professional/VC/Tools/MSVC",
-        "C:/Program Files/Microsoft Visual "
-        "Studio/2022/Enterprise/VC/Tools/MSVC",
-        "C:/Program Files (x86)/Microsoft Visual "
-        "Studio/2019/Community/VC/Tools/MSVC",
-        "C:/Program Files (x86)/Microsoft Visual "
-        "Studio/2019/Professional/VC/Tools/MSVC",
-        "C:/Program Files (x86)/Microsoft Visual "
-        "Studio/2019/Enterprise/VC/Tools/MSVC"};
+  void unwatch(int &fd) {
+    if (fd < 0) {
+      return;
+    }
+#ifdef __linux__
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    watched_.erase(fd);
+#endif
+    close(fd);
+    fd = -1;
+  }
 
-    for (const auto &base_path : common_paths) {
-      if (fs::exists(base_path)) {
-        for (const auto &entry : fs::directory_iterator(base_path)) {
-          if (entry.is_directory()) {
-            fs::path compiler_path = entry.path() / "bin/Hostx64/x64/cl.exe";
-            if (fs::exists(compiler_path)) {
-              paths.push_back(Utils::clean_path(compiler_path.string()));
-            }
-          }
+  std::vector<uint64_t> wait_events(int timeout_ms) {
+    std::vector<uint64_t> tokens;
+#ifdef __linux__
+    std::array<epoll_event, 64> events;
+    int n = epoll_wait(epoll_fd_, events.data(),
+                       static_cast<int>(events.size()), timeout_ms);
+    for (int i = 0; i < n; i++) {
+      tokens.push_back(events[i].data.u64);
+    }
+#else
+    std::vector<pollfd> fds;
+    for (const auto &entry : watched_) {
+      fds.push_back({entry.first, POLLIN, 0});
+    }
+    if (poll(fds.data(), fds.size(), timeout_ms) > 0) {
+      for (const auto &fd : fds) {
+        if (fd.revents != 0) {
+          tokens.push_back(watched_[fd.fd]);
+        }
+      }
+    }
+#endif
+    return tokens;
+  }
+
+  static pid_t spawn(const std::vector<std::string> &args, int &out_fd,
+                     int &err_fd, bool capture_stderr) {
+    std::vector<char *> argv;
+    for (const auto &arg : args) {
+      argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    int out_pipe[2], err_pipe[2] = {-1, -1};
+    if (!make_pipe(out_pipe)) {
+      throw std::runtime_error("Failed to create pipe");
+    }
+    if (capture_stderr && !make_pipe(err_pipe)) {
+      close(out_pipe[0]);
+      close(out_pipe[1]);
+      throw std::runtime_error("Failed to create pipe");
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    if (capture_stderr) {
+      posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+    }
+
+    // 降低权限：有效用户/组ID重置为真实ID
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    short flags = POSIX_SPAWN_RESETIDS;
+#ifdef POSIX_SPAWN_USEVFORK
+    flags |= POSIX_SPAWN_USEVFORK;
+#endif
+    posix_spawnattr_setflags(&attr, flags);
+
+    pid_t pid;
+    int spawn_error = posix_spawnp(&pid, argv[0], &actions, &attr,
+                                   argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(out_pipe[1]);
+    if (capture_stderr) {
+      close(err_pipe[1]);
+    }
+
+    if (spawn_error != 0) {
+      close(out_pipe[0]);
+      if (capture_stderr) {
+        close(err_pipe[0]);
+      }
+      throw std::runtime_error("Failed to spawn " + args[0] + ": " +
+                               std::strerror(spawn_error));
+    }
+    for (int fd : {out_pipe[0], err_pipe[0]}) {
+      if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      }
+    }
+    out_fd = out_pipe[0];
+    err_fd = err_pipe[0];
+    return pid;
+  }
+
+  static bool make_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC) == 0;
+#else
+    if (pipe(fds) != 0) {
+      return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+  }
+
+  // 读空管道（64 KiB一次），EOF时注销
+  void drain(int &fd, std::string &sink) {
+    char buffer[64 * 1024];
+    while (fd >= 0) {
+      ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n > 0) {
+        sink.append(buffer, static_cast<size_t>(n));
+      } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+        unwatch(fd);
+      } else if (errno == EAGAIN) {
+        break;
+      }
+    }
+  }
+
+  void reap(Job &job) {
+    if (job.reaped) {
+      return;
+    }
+    int status;
+    pid_t r = waitpid(job.pid, &status, WNOHANG);
+    if (r == job.pid || (r == -1 && errno == ECHILD)) {
+      // ECHILD：子进程已被别处回收，退出状态未知，按失败处理
+      job.reaped = true;
+      job.status_lost = r != job.pid;
+      job.status = r == job.pid ? status : 0;
+      job.reaped_at = Clock::now();
+      unwatch(job.pid_fd);
+    }
+  }
+
+  void terminate(Job &job, int signal) {
+    if (!job.reaped) {
+      kill(job.pid, signal);
+    }
+    if (signal == SIGTERM) {
+      job.kill_at = Clock::now() + kKillGrace;
+    } else {
+      job.kill_at = Clock::time_point::max();
+    }
+  }
+
+  void run_loop() {
+    while (true) {
+      std::vector<uint64_t> cancels;
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (auto &job : pending_) {
+          watch(job->out_fd, job->id << 2 | OUT);
+          if (job->err_fd >= 0) {
+            watch(job->err_fd, job->id << 2 | ERR);
+          }
+          if (job->pid_fd >= 0) {
+            watch(job->pid_fd, job->id << 2 | PID);
+          }
+          jobs_[job->id] = std::move(job);
+        }
+        pending_.clear();
+        cancels.swap(cancel_requests_);
+        if (stopping_) {
+          for (auto &entry : jobs_) {
+            cancels.push_back(entry.first);
+          }
+          if (jobs_.empty()) {
+            return;
+          }
+        }
+      }
+
+      for (uint64_t id : cancels) {
+        auto it = jobs_.find(id);
+        if (it != jobs_.end() && !it->second->result.cancelled) {
+          it->second->result.cancelled = true;
+          terminate(*it->second, SIGTERM);
+        }
+      }
+
+      // 等待时间取最近的截止时间；没有pidfd的任务需要定期回收
+      auto now = Clock::now();
+      auto next = Clock::time_point::max();
+      bool needs_tick = false;
+      for (const auto &entry : jobs_) {
+        const Job &job = *entry.second;
+        next = std::min({next, job.deadline, job.kill_at});
+        if (job.reaped) {
+          next = std::min(next, job.reaped_at + kPipeGrace);
+        } else if (job.pid_fd < 0) {
+          needs_tick = true;
+        }
+      }
+      int timeout_ms = -1;
+      if (next != Clock::time_point::max()) {
+        timeout_ms = static_cast<int>(std::max<int64_t>(
+            0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                   next - now)
+                       .count() +
+                   1));
+      }
+      if (needs_tick && (timeout_ms < 0 || timeout_ms > kReapTickMs)) {
+        timeout_ms = kReapTickMs;
+      }
+
+      for (uint64_t token : wait_events(timeout_ms)) {
+        if ((token & 3) == WAKE) {
+          char buffer[64];
+          while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {
+          }
+          continue;
+        }
+        auto it = jobs_.find(token >> 2);
+        if (it == jobs_.end()) {
+          continue;
+        }
+        Job &job = *it->second;
+        switch (token & 3) {
+        case OUT:
+          drain(job.out_fd, job.result.out);
+          break;
+        case ERR:
+          drain(job.err_fd, job.result.err);
+          break;
+        case PID:
+          reap(job);
+          break;
+        }
+      }
+
+      now = Clock::now();
+      for (auto it = jobs_.begin(); it != jobs_.end();) {
+        Job &job = *it->second;
+        if (job.pid_fd < 0) {
+          reap(job);
+        }
+        if (!job.reaped && now >= job.deadline) {
+          job.result.timed_out = true;
+          job.deadline = Clock::time_point::max();
+          terminate(job, SIGTERM);
+        }
+        if (!job.reaped && now >= job.kill_at) {
+          terminate(job, SIGKILL);
+        }
+        // 子进程已退出但管道被孙进程占用时，宽限期后放弃读取
+        if (job.reaped && now >= job.reaped_at + kPipeGrace) {
+          unwatch(job.out_fd);
+          unwatch(job.err_fd);
+        }
+
+        if (job.reaped && job.out_fd < 0 && job.err_fd < 0) {
+          if (job.status_lost) {
+            // exit_code保持-1
+            job.result.err += "exit status unavailable (waitpid: ECHILD)\n";
+          } else if (WIFEXITED(job.status)) {
+            job.result.exit_code = WEXITSTATUS(job.status);
+          } else if (WIFSIGNALED(job.status)) {
+            job.result.signal = WTERMSIG(job.status);
+          }
+          job.promise.set_value(std::move(job.result));
+          it = jobs_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+};
+#endif
+
+#ifndef _WIN32
+// 进程内HTTP客户端。http由内置的HTTP/1.1实现处理：按主机复用keep-alive
+// 连接，支持流水线请求。https（定义SLN2CODE_HAVE_LIBCURL时）经libcurl的
+// multi句柄传输，连接、DNS和TLS会话在请求之间复用，HTTP/2服务器上的并发
+// 请求多路复用同一连接；未链接libcurl时https仍由curl命令处理
+class HttpClient {
+public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+  using ProgressCallback = std::function<void(uint64_t, uint64_t)>;
+
+  struct Url {
+    std::string scheme;
+    std::string host;
+    std::string port;
+    std::string target;
+
+    static std::optional<Url> parse(const std::string &url) {
+      // 空白和控制字符会被拼进请求行（CR/LF可注入请求头）
+      if (std::any_of(url.begin(), url.end(), [](unsigned char c) {
+            return c <= 0x20 || c == 0x7f;
+          })) {
+        return std::nullopt;
+      }
+      size_t scheme_end = url.find("://");
+      if (scheme_end == std::string::npos) {
+        return std::nullopt;
+      }
+      Url result;
+      result.scheme = url.substr(0, scheme_end);
+      size_t host_start = scheme_end + 3;
+      size_t path_start = url.find_first_of("/?#", host_start);
+      std::string authority = url.substr(host_start, path_start - host_start);
+      result.target =
+          path_start == std::string::npos ? "/" : url.substr(path_start);
+      size_t hash = result.target.find('#');
+      if (hash != std::string::npos) {
+        result.target.erase(hash);
+      }
+      if (result.target.empty() || result.target[0] != '/') {
+        result.target.insert(0, "/");
+      }
+      size_t colon = authority.rfind(':');
+      if (colon != std::string::npos &&
+          authority.find(']', colon) == std::string::npos) {
+        result.host = authority.substr(0, colon);
+        result.port = authority.substr(colon + 1);
+      } else {
+        result.host = authority;
+        result.port = result.scheme == "https" ? "443" : "80";
+      }
+      if (result.host.empty() || result.port.empty()) {
+        return std::nullopt;
+      }
+      return result;
+    }
+
+    std::string authority() const { return host + ":" + port; }
+
+    // 解析相对重定向地址
+    std::string resolve(const std::string &location) const {
+      if (location.find("://") != std::string::npos) {
+        return location;
+      }
+      std::string base = scheme + "://" + authority();
+      if (!location.empty() && location[0] == '/') {
+        return base + location;
+      }
+      std::string dir = target.substr(0, target.rfind('/') + 1);
+      return base + dir + location;
+    }
+  };
+
+  struct Response {
+    int status = 0;
+    std::map<std::string, std::string> headers; // 键为小写
+    std::string body;
+    std::string error;
+    std::string final_url;
+
+    bool ok() const { return error.empty() && status >= 200 && status < 300; }
+
+    std::string header(const std::string &name) const {
+      auto it = headers.find(name);
+      return it == headers.end() ? std::string() : it->second;
+    }
+  };
+
+  static HttpClient &instance() {
+    static HttpClient client;
+    return client;
+  }
+
+  static bool supports(const std::string &url) {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    if (url.rfind("https://", 0) == 0) {
+      return true;
+    }
+#endif
+    return url.rfind("http://", 0) == 0;
+  }
+
+  // http也经libcurl传输（用于排查内置客户端的问题和测试libcurl路径）
+  static void use_libcurl_for_http(bool enabled) {
+    libcurl_for_http_ = enabled;
+  }
+
+  // 获取内容到内存
+  Response get(const std::string &url, const Headers &headers = {}) {
+    Response response;
+    follow(url, headers, response, [&response](const char *data, size_t n) {
+      response.body.append(data, n);
+      return true;
+    });
+    return response;
+  }
+
+  // 流式下载到文件，并报告进度和吞吐量
+  Response download(const std::string &url, const fs::path &output,
+                    const Headers &headers = {},
+                    ProgressCallback progress = nullptr) {
+    Response response;
+    std::ofstream file;
+    uint64_t received = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+
+    follow(url, headers, response, [&](const char *data, size_t n) {
+      // 错误页面不写入输出文件，读完以便复用连接
+      if (response.status != 200 && response.status != 206) {
+        return true;
+      }
+      if (!file.is_open()) {
+        file.open(output, std::ios::binary | std::ios::trunc);
+        if (!file) {
+          response.error = "can't create " + output.string();
+          return false;
+        }
+      }
+      file.write(data, static_cast<std::streamsize>(n));
+      received += n;
+      uint64_t total = content_length(response);
+      if (progress) {
+        progress(received, total);
+      } else {
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::milliseconds(250)) {
+          last_report = now;
+          print_progress(received, total, now - start, false);
+        }
+      }
+      return static_cast<bool>(file);
+    });
+
+    const bool success = response.error.empty() &&
+                         (response.status == 200 || response.status == 206);
+    if (response.ok() && !success) {
+      response.error = "unexpected HTTP status " +
+                       std::to_string(response.status);
+    }
+    if (success && !file.is_open()) {
+      std::ofstream(output, std::ios::binary | std::ios::trunc); // 空文件
+    } else if (!success) {
+      // 其他状态码（包括中断的传输）不留下不完整或错误的内容
+      file.close();
+      std::error_code ec;
+      fs::remove(output, ec);
+    }
+    if (response.ok() && !progress) {
+      print_progress(received, content_length(response),
+                     std::chrono::steady_clock::now() - start, true);
+    }
+    return response;
+  }
+
+  // 大文件分段并行下载：按Range把各段pwrite到预分配的文件，失败的段单独重试；
+  // 进度记录在<output>.part.state中，中断后再次调用即可续传
+  Response download_segmented(const std::string &url, const fs::path &output,
+                              ProgressCallback progress = nullptr,
+                              unsigned segments = kDefaultSegments) {
+    // 用一个字节的Range请求探测大小和Range支持
+    Response probe;
+    follow(url, {{"Range", "bytes=0-0"}}, probe,
+           [&probe](const char *, size_t) { return probe.status == 206; });
+    uint64_t total = 0;
+    if (probe.status == 206) {
+      std::string range = probe.header("content-range");
+      size_t slash = range.rfind('/');
+      if (slash != std::string::npos) {
+        total = std::strtoull(range.c_str() + slash + 1, nullptr, 10);
+      }
+    }
+    if (segments < 2 || total < kSegmentThreshold) {
+      return download(url, output, {}, progress);
+    }
+
+    // If-Range保证服务器上的文件变化时不会拼接出混合内容
+    std::string validator = probe.header("etag");
+    if (validator.empty() || validator.rfind("W/", 0) == 0) {
+      validator = probe.header("last-modified");
+    }
+    const std::string source = probe.final_url;
+    auto parsed = Url::parse(source);
+
+    Response response;
+    response.final_url = source;
+    const fs::path part_path = output.string() + ".part";
+    const fs::path state_path = output.string() + ".part.state";
+
+    int state_fd = ::open(state_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC,
+                          0644);
+    if (state_fd < 0) {
+      response.error = "can't create " + state_path.string();
+      return response;
+    }
+    // 多个进程下载同一文件时串行化
+    flock(state_fd, LOCK_EX);
+
+    const uint64_t unit = std::max<uint64_t>(
+        kMinSegmentBytes, (total + segments * 4 - 1) / (segments * 4));
+    const size_t unit_count = static_cast<size_t>((total + unit - 1) / unit);
+    std::vector<char> done(unit_count, 0);
+    const std::string header =
+        source + "\t" + std::to_string(total) + "\t" + validator + "\n";
+
+    // 读取上次的状态；来源、大小或校验值不同则从头开始
+    std::string state;
+    char chunk[4096];
+    ssize_t n;
+    while ((n = ::read(state_fd, chunk, sizeof(chunk))) > 0) {
+      state.append(chunk, static_cast<size_t>(n));
+    }
+    std::error_code ec;
+    size_t resumed = 0;
+    if (!validator.empty() && state.rfind(header, 0) == 0 &&
+        fs::file_size(part_path, ec) == total) {
+      std::istringstream lines(state.substr(header.size()));
+      size_t index;
+      while (lines >> index) {
+        if (index < unit_count && !done[index]) {
+          done[index] = 1;
+          resumed++;
+        }
+      }
+    } else {
+      fs::remove(part_path, ec);
+      if (ftruncate(state_fd, 0) != 0 || lseek(state_fd, 0, SEEK_SET) != 0 ||
+          ::write(state_fd, header.data(), header.size()) !=
+              static_cast<ssize_t>(header.size())) {
+        response.error = "can't write " + state_path.string();
+        ::close(state_fd);
+        return response;
+      }
+    }
+    lseek(state_fd, 0, SEEK_END);
+
+    int fd = ::open(part_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      response.error = "can't create " + part_path.string();
+      ::close(state_fd);
+      return response;
+    }
+    // 预分配空间，避免各段乱序写入时产生碎片
+    if (posix_fallocate(fd, 0, static_cast<off_t>(total)) != 0 &&
+        ftruncate(fd, static_cast<off_t>(total)) != 0) {
+      response.error = "can't allocate " + part_path.string();
+      ::close(fd);
+      ::close(state_fd);
+      return response;
+    }
+
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < unit_count; i++) {
+      if (!done[i]) {
+        pending.push_back(i);
+      }
+    }
+    if (resumed > 0) {
+      std::cout << "Resuming download: " << resumed << "/" << unit_count
+                << " segments already present\n";
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> changed{false};
+    std::atomic<unsigned> running{0};
+    std::mutex state_mtx;
+    std::condition_variable finished;
+    std::vector<size_t> failed;
+
+    auto fetch_unit = [&](size_t index) {
+      const uint64_t end = std::min(total, (index + 1) * unit) - 1;
+      uint64_t offset = index * unit;
+      for (int attempt = 0; attempt < kSegmentRetries && offset <= end &&
+                            !changed;
+           attempt++) {
+        Response part;
+        bool write_failed = false;
+        request(*parsed,
+                {{"Range", "bytes=" + std::to_string(offset) + "-" +
+                               std::to_string(end)},
+                 {"If-Range", validator}},
+                part,
+                [&](const char *data, size_t size) {
+                  if (part.status != 206) {
+                    if (part.status == 200) {
+                      changed = true;
+                    }
+                    return false;
+                  }
+                  size = static_cast<size_t>(
+                      std::min<uint64_t>(size, end + 1 - offset));
+                  while (size > 0) {
+                    ssize_t written =
+                        pwrite(fd, data, size, static_cast<off_t>(offset));
+                    if (written < 0 && errno == EINTR)
+                      continue;
+                    if (written <= 0) {
+                      write_failed = true;
+                      return false;
+                    }
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                    offset += static_cast<uint64_t>(written);
+                    received += static_cast<uint64_t>(written);
+                  }
+                  return true;
+                },
+                nullptr, true);
+        if (write_failed) {
+          break;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(state_mtx);
+      if (offset > end) {
+        std::string line = std::to_string(index) + "\n";
+        if (::write(state_fd, line.data(), line.size()) < 0) {
+          // 状态写入失败只影响续传
+        }
+      } else {
+        failed.push_back(index);
+      }
+    };
+
+    const unsigned thread_count = static_cast<unsigned>(
+        std::min<size_t>(segments, pending.size()));
+    std::vector<TaskScheduler::Future<void>> workers;
+    running = thread_count;
+    auto token = CancellationToken::current();
+    for (unsigned t = 0; t < thread_count; t++) {
+      workers.push_back(TaskScheduler::instance().submit_blocking([&] {
+        // 工作线程继承调用者的取消令牌
+        CancellationToken::Scope scope(token);
+        for (size_t i = next++; i < pending.size(); i = next++) {
+          if (token && token->cancelled()) {
+            std::lock_guard<std::mutex> lock(state_mtx);
+            failed.push_back(pending[i]);
+            continue;
+          }
+          fetch_unit(pending[i]);
+        }
+        std::lock_guard<std::mutex> lock(state_mtx);
+        if (--running == 0) {
+          finished.notify_all();
+        }
+      }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(state_mtx);
+      while (!finished.wait_for(lock, std::chrono::milliseconds(250),
+                                [&] { return running == 0; })) {
+        uint64_t present = std::min(total, received + resumed * unit);
+        if (progress) {
+          progress(present, total);
+        } else {
+          print_progress(present, total,
+                         std::chrono::steady_clock::now() - start, false);
+        }
+      }
+    }
+    for (auto &worker : workers) {
+      worker.wait();
+    }
+    ::close(fd);
+
+    if (changed) {
+      // 远端文件已变化，丢弃部分内容
+      fs::remove(part_path, ec);
+      fs::remove(state_path, ec);
+      ::close(state_fd);
+      response.error = "remote file changed during download";
+      return response;
+    }
+    if (!failed.empty()) {
+      ::close(state_fd);
+      response.error = std::to_string(failed.size()) + " of " +
+                       std::to_string(unit_count) +
+                       " segments failed; rerun to resume";
+      return response;
+    }
+
+    fs::rename(part_path, output, ec);
+    if (ec) {
+      ::close(state_fd);
+      response.error = "can't rename " + part_path.string() + ": " +
+                       ec.message();
+      return response;
+    }
+    fs::remove(state_path, ec);
+    ::close(state_fd);
+    if (progress) {
+      progress(total, total);
+    } else {
+      print_progress(received, total,
+                     std::chrono::steady_clock::now() - start, true);
+    }
+    response.status = 200;
+    response.headers = probe.headers;
+    return response;
+  }
+
+  // 流水线批量请求：同一主机的请求连续写入同一连接，再按顺序读取响应
+  std::vector<Response> get_many(const std::vector<std::string> &urls,
+                                 const std::vector<Headers> &headers = {}) {
+    std::vector<Response> responses(urls.size());
+    std::map<std::string, std::vector<size_t>> by_host;
+    for (size_t i = 0; i < urls.size(); i++) {
+      auto url = Url::parse(urls[i]);
+      if (url && supports(urls[i])) {
+        by_host[url->scheme + "://" + url->authority()].push_back(i);
+      } else {
+        responses[i].error = "unsupported URL: " + urls[i];
+      }
+    }
+
+    for (const auto &group : by_host) {
+      std::vector<size_t> remaining = group.second;
+      if (remaining.size() > 1) {
+        remaining = batch(urls, headers, group.second, responses);
+      }
+      // 未完成的（连接提前关闭、重定向等）逐个回退到普通请求
+      for (size_t i : remaining) {
+        responses[i] = get(urls[i], i < headers.size() ? headers[i] : Headers());
+      }
+    }
+    return responses;
+  }
+
+private:
+  using Sink = std::function<bool(const char *, size_t)>;
+
+  struct Connection {
+    int fd = -1;
+    std::string buffer;
+    size_t pos = 0;
+    bool reused = false;
+  };
+
+  // 当前线程的取消令牌可通过shutdown中止阻塞在该连接上的读写
+  class CancelGuard {
+  public:
+    explicit CancelGuard(int fd) : token_(CancellationToken::current()) {
+      if (token_) {
+        id_ = token_->on_cancel([fd] { shutdown(fd, SHUT_RDWR); });
+      }
+    }
+    ~CancelGuard() {
+      if (token_) {
+        token_->remove(id_);
+      }
+    }
+    CancelGuard(const CancelGuard &) = delete;
+    CancelGuard &operator=(const CancelGuard &) = delete;
+
+    bool cancelled() const { return token_ && token_->cancelled(); }
+
+  private:
+    std::shared_ptr<CancellationToken> token_;
+    uint64_t id_ = 0;
+  };
+
+  static constexpr int kMaxRedirects = 5;
+  static constexpr int kTimeoutSeconds = 30;
+  static constexpr unsigned kDefaultSegments = 4;
+  static constexpr int kSegmentRetries = 3;
+  static constexpr uint64_t kSegmentThreshold = 8ull * 1024 * 1024;
+  static constexpr uint64_t kMinSegmentBytes = 1024 * 1024;
+
+  std::mutex pool_mtx_;
+  std::map<std::string, std::vector<int>> idle_;
+  static bool libcurl_for_http_;
+
+#ifdef SLN2CODE_HAVE_LIBCURL
+  // 一次libcurl传输；回调在驱动线程上执行，调用者线程等待done
+  struct CurlTransfer {
+    std::string url;
+    Headers headers;
+    std::string range;
+    Response *response = nullptr;
+    Sink sink;
+    bool *is_redirect = nullptr;
+    bool own_connection = false; // 强制HTTP/1.1，使用独立连接
+    bool pipewait = false;       // 等待可多路复用的连接，而不是新建连接
+    CURL *easy = nullptr;
+    curl_slist *header_list = nullptr;
+    bool redirect = false;
+    std::atomic<bool> abort{false};
+    bool done = false;
+    CURLcode result = CURLE_OK;
+    char error[CURL_ERROR_SIZE] = {};
+  };
+
+  static constexpr long kMaxHostConnections = 8;
+
+  // multi句柄自带连接池；share句柄另外共享DNS缓存和TLS会话，
+  // 新建到同一主机的连接可以恢复会话，省去完整握手。
+  // 两者只在驱动线程上使用，不需要加锁回调
+  CURLM *multi_ = nullptr;
+  CURLSH *share_ = nullptr;
+  std::mutex curl_mtx_;
+  std::condition_variable curl_done_;
+  std::vector<CurlTransfer *> curl_pending_;
+  std::thread curl_thread_;
+  bool curl_stopping_ = false;
+#endif
+
+  HttpClient() {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi_ = curl_multi_init();
+    share_ = curl_share_init();
+    if (multi_ == nullptr || share_ == nullptr) {
+      throw std::runtime_error("Failed to initialise libcurl");
+    }
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      kMaxHostConnections);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#endif
+  }
+
+  ~HttpClient() {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    {
+      std::lock_guard<std::mutex> lock(curl_mtx_);
+      curl_stopping_ = true;
+    }
+    if (curl_thread_.joinable()) {
+      curl_multi_wakeup(multi_);
+      curl_thread_.join();
+    }
+    curl_multi_cleanup(multi_);
+    curl_share_cleanup(share_);
+    curl_global_cleanup();
+#endif
+    for (auto &entry : idle_) {
+      for (int fd : entry.second) {
+        close(fd);
+      }
+    }
+  }
+
+  static bool use_libcurl(const Url &url) {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    return url.scheme == "https" || libcurl_for_http_;
+#else
+    (void)url;
+    return false;
+#endif
+  }
+
+#ifdef SLN2CODE_HAVE_LIBCURL
+  // 把传输交给驱动线程并等待全部完成；当前线程的取消令牌会中止这些传输
+  void curl_perform(const std::vector<CurlTransfer *> &transfers) {
+    for (CurlTransfer *transfer : transfers) {
+      curl_setup(*transfer);
+    }
+    auto token = CancellationToken::current();
+    uint64_t registration = 0;
+    if (token) {
+      registration = token->on_cancel([this, transfers] {
+        for (CurlTransfer *transfer : transfers) {
+          transfer->abort = true;
+        }
+        curl_multi_wakeup(multi_);
+      });
+    }
+    {
+      std::lock_guard<std::mutex> lock(curl_mtx_);
+      curl_pending_.insert(curl_pending_.end(), transfers.begin(),
+                           transfers.end());
+      if (!curl_thread_.joinable()) {
+        curl_thread_ = std::thread([this] { curl_loop(); });
+      }
+    }
+    curl_multi_wakeup(multi_);
+    {
+      std::unique_lock<std::mutex> lock(curl_mtx_);
+      curl_done_.wait(lock, [&transfers] {
+        return std::all_of(transfers.begin(), transfers.end(),
+                           [](const CurlTransfer *t) { return t->done; });
+      });
+    }
+    if (token) {
+      token->remove(registration);
+    }
+
+    for (CurlTransfer *transfer : transfers) {
+      Response &response = *transfer->response;
+      if (transfer->result == CURLE_ABORTED_BY_CALLBACK) {
+        response.error = "cancelled";
+      } else if (transfer->result != CURLE_OK && response.error.empty()) {
+        response.error = transfer->error[0] != '\0'
+                             ? transfer->error
+                             : curl_easy_strerror(transfer->result);
+      }
+      curl_easy_cleanup(transfer->easy);
+      curl_slist_free_all(transfer->header_list);
+    }
+  }
+
+  void curl_setup(CurlTransfer &transfer) {
+    CURL *easy = transfer.easy = curl_easy_init();
+    if (easy == nullptr) {
+      throw std::runtime_error("Failed to initialise libcurl transfer");
+    }
+    curl_easy_setopt(easy, CURLOPT_URL, transfer.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_SHARE, share_);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, &transfer);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer.error);
+    const std::string agent = "SLN2Code/" + Constants::VERSION;
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, agent.c_str());
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT,
+                     static_cast<long>(kTimeoutSeconds));
+    // 与内置客户端的套接字超时一致：30秒没有数据则失败
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME,
+                     static_cast<long>(kTimeoutSeconds));
+    // 重定向由follow处理，与内置客户端一致
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 0L);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &HttpClient::curl_header);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &HttpClient::curl_write);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+    for (const auto &header : transfer.headers) {
+      // 字节范围交给libcurl（分段下载的各段）
+      if (header.first == "Range" && header.second.rfind("bytes=", 0) == 0) {
+        transfer.range = header.second.substr(6);
+        curl_easy_setopt(easy, CURLOPT_RANGE, transfer.range.c_str());
+        continue;
+      }
+      transfer.header_list = curl_slist_append(
+          transfer.header_list, (header.first + ": " + header.second).c_str());
+    }
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.header_list);
+    if (transfer.own_connection) {
+      curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+    if (transfer.pipewait) {
+      curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    }
+  }
+
+  // 驱动线程：把新传输加入multi句柄，推进所有传输，完成后通知调用者
+  void curl_loop() {
+    std::vector<CurlTransfer *> active;
+    auto finish = [this, &active](CurlTransfer *transfer, CURLcode result) {
+      curl_multi_remove_handle(multi_, transfer->easy);
+      active.erase(std::find(active.begin(), active.end(), transfer));
+      std::lock_guard<std::mutex> lock(curl_mtx_);
+      transfer->result = result;
+      transfer->done = true;
+      curl_done_.notify_all();
+    };
+
+    while (true) {
+      bool stopping;
+      {
+        std::lock_guard<std::mutex> lock(curl_mtx_);
+        for (CurlTransfer *transfer : curl_pending_) {
+          curl_multi_add_handle(multi_, transfer->easy);
+          active.push_back(transfer);
+        }
+        curl_pending_.clear();
+        stopping = curl_stopping_;
+      }
+      if (stopping && active.empty()) {
+        return;
+      }
+
+      for (size_t i = active.size(); i-- > 0;) {
+        if (active[i]->abort || stopping) {
+          finish(active[i], CURLE_ABORTED_BY_CALLBACK);
+        }
+      }
+
+      int running = 0;
+      curl_multi_perform(multi_, &running);
+      int queued = 0;
+      while (CURLMsg *message = curl_multi_info_read(multi_, &queued)) {
+        if (message->msg != CURLMSG_DONE) {
+          continue;
+        }
+        CurlTransfer *transfer = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+        finish(transfer, message->data.result);
+      }
+      curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+  }
+
+  // 每行响应头；状态行（包括1xx和代理CONNECT的响应）开始一组新的响应头
+  static size_t curl_header(char *data, size_t size, size_t count,
+                            void *user) {
+    auto &transfer = *static_cast<CurlTransfer *>(user);
+    Response &response = *transfer.response;
+    std::string line(data, size * count);
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+      line.pop_back();
+    }
+    if (line.rfind("HTTP/", 0) == 0) {
+      size_t space = line.find(' ');
+      response.status =
+          space == std::string::npos ? 0 : std::atoi(line.c_str() + space + 1);
+      response.headers.clear();
+      transfer.redirect = false;
+    } else if (line.empty()) {
+      if (transfer.is_redirect != nullptr) {
+        transfer.redirect = response.status >= 300 && response.status < 400 &&
+                            !response.header("location").empty();
+        *transfer.is_redirect = transfer.redirect;
+      }
+    } else {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        std::string key = line.substr(0, colon);
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        response.headers[key] = value;
+      }
+    }
+    return size * count;
+  }
+
+  static size_t curl_write(char *data, size_t size, size_t count, void *user) {
+    auto &transfer = *static_cast<CurlTransfer *>(user);
+    const size_t n = size * count;
+    // 重定向的响应体丢弃；sink拒绝时返回0中止传输
+    if (transfer.redirect) {
+      return n;
+    }
+    return transfer.sink(data, n) ? n : 0;
+  }
+
+  // https批量请求：同时提交给multi句柄。PIPEWAIT让后续请求等待第一个连接
+  // 协商完成，HTTP/2服务器上全部在这一个连接上多路复用
+  std::vector<size_t> curl_batch(const std::vector<std::string> &urls,
+                                 const std::vector<Headers> &headers,
+                                 const std::vector<size_t> &indices,
+                                 std::vector<Response> &responses) {
+    std::vector<std::unique_ptr<CurlTransfer>> transfers;
+    std::unique_ptr<bool[]> redirects(new bool[indices.size()]());
+    std::vector<CurlTransfer *> pointers;
+    for (size_t k = 0; k < indices.size(); k++) {
+      const size_t i = indices[k];
+      Response &response = responses[i];
+      response.final_url = urls[i];
+      auto transfer = std::make_unique<CurlTransfer>();
+      transfer->url = urls[i];
+      transfer->headers = i < headers.size() ? headers[i] : Headers();
+      transfer->response = &response;
+      transfer->sink = [&response](const char *data, size_t n) {
+        response.body.append(data, n);
+        return true;
+      };
+      transfer->is_redirect = &redirects[k];
+      transfer->pipewait = true;
+      pointers.push_back(transfer.get());
+      transfers.push_back(std::move(transfer));
+    }
+    curl_perform(pointers);
+
+    std::vector<size_t> remaining;
+    for (size_t k = 0; k < indices.size(); k++) {
+      Response &response = responses[indices[k]];
+      if (redirects[k] || !response.error.empty()) {
+        // 重定向和失败的请求逐个重试
+        response = Response();
+        remaining.push_back(indices[k]);
+      }
+    }
+    return remaining;
+  }
+#endif
+
+  static uint64_t content_length(const Response &response) {
+    try {
+      std::string value = response.header("content-length");
+      return value.empty() ? 0 : std::stoull(value);
+    } catch (...) {
+      return 0;
+    }
+  }
+
+  static void print_progress(uint64_t received, uint64_t total,
+                             std::chrono::steady_clock::duration elapsed,
+                             bool done) {
+    double seconds = std::max(
+        0.001, std::chrono::duration<double>(elapsed).count());
+    double mib = received / (1024.0 * 1024.0);
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "\r  " << mib << " MiB";
+    if (total > 0) {
+      line << " / " << total / (1024.0 * 1024.0) << " MiB";
+    }
+    line << "  " << mib / seconds << " MiB/s";
+    if (done) {
+      line << " in " << seconds << " s\n";
+    }
+    std::cout << line.str() << std::flush;
+  }
+
+  // 跟随重定向；跳转到不支持的地址（未链接libcurl时的https）时交给调用者回退
+  void follow(std::string url, const Headers &headers, Response &response,
+              const Sink &sink) {
+    for (int hop = 0; hop <= kMaxRedirects; hop++) {
+      response = Response();
+      response.final_url = url;
+      auto parsed = Url::parse(url);
+      if (!parsed || !supports(url)) {
+        response.error = "unsupported URL: " + url;
+        return;
+      }
+      bool is_redirect = false;
+      request(*parsed, headers, response, [&](const char *data, size_t n) {
+        return is_redirect || sink(data, n);
+      }, &is_redirect);
+      if (!is_redirect || !response.error.empty()) {
+        return;
+      }
+      url = parsed->resolve(response.header("location"));
+      if (!supports(url)) {
+        // status为0：调用者据此用final_url回退到curl
+        response.status = 0;
+        response.final_url = url;
+        response.error = "redirected to unsupported URL: " + url;
+        return;
+      }
+    }
+    response.error = "too many redirects";
+  }
+
+  static std::string build_request(const Url &url, const Headers &headers) {
+    std::string request = "GET " + url.target + " HTTP/1.1\r\n";
+    request += "Host: " + (url.port == "80" ? url.host : url.authority()) +
+               "\r\n";
+    request += "User-Agent: SLN2Code/" + Constants::VERSION + "\r\n";
+    request += "Accept-Encoding: identity\r\n";
+    for (const auto &header : headers) {
+      request += header.first + ": " + header.second + "\r\n";
+    }
+    request += "\r\n";
+    return request;
+  }
+
+  // 单个请求；stale的复用连接在收到任何字节之前失败时重试一次。
+  // own_connection：不与其他请求多路复用同一连接（分段下载各段独立限速）
+  void request(const Url &url, const Headers &headers, Response &response,
+               const Sink &sink, bool *is_redirect,
+               bool own_connection = false) {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    if (use_libcurl(url)) {
+      CurlTransfer transfer;
+      transfer.url = url.scheme + "://" + url.authority() + url.target;
+      transfer.headers = headers;
+      transfer.response = &response;
+      transfer.sink = sink;
+      transfer.is_redirect = is_redirect;
+      transfer.own_connection = own_connection;
+      curl_perform({&transfer});
+      return;
+    }
+#else
+    (void)own_connection;
+#endif
+    const std::string payload = build_request(url, headers);
+    for (int attempt = 0; attempt < 2; attempt++) {
+      Connection conn = acquire(url, response.error);
+      if (conn.fd < 0) {
+        return;
+      }
+      bool started = false;
+      bool keep_alive = false;
+      bool ok;
+      bool cancelled;
+      {
+        CancelGuard guard(conn.fd);
+        ok = send_all(conn.fd, payload) &&
+             read_response(conn, response, sink, started, keep_alive,
+                           is_redirect);
+        cancelled = guard.cancelled();
+      }
+      if (ok) {
+        release(url, conn, keep_alive && !cancelled);
+        return;
+      }
+      close(conn.fd);
+      if (cancelled) {
+        response.error = "cancelled";
+        return;
+      }
+      if (started || !conn.reused) {
+        if (response.error.empty()) {
+          response.error = "connection to " + url.authority() + " failed";
+        }
+        return;
+      }
+      response = Response();
+      response.final_url = url.scheme + "://" + url.authority() + url.target;
+    }
+  }
+
+  // 同一主机的批量请求；返回需要逐个重试的请求
+  std::vector<size_t> batch(const std::vector<std::string> &urls,
+                            const std::vector<Headers> &headers,
+                            const std::vector<size_t> &indices,
+                            std::vector<Response> &responses) {
+#ifdef SLN2CODE_HAVE_LIBCURL
+    // libcurl不再支持HTTP/1.1流水线：同时提交，由multi句柄多路复用
+    if (use_libcurl(*Url::parse(urls[indices.front()]))) {
+      return curl_batch(urls, headers, indices, responses);
+    }
+#endif
+    return pipeline(urls, headers, indices, responses);
+  }
+
+  std::vector<size_t> pipeline(const std::vector<std::string> &urls,
+                               const std::vector<Headers> &headers,
+                               const std::vector<size_t> &indices,
+                               std::vector<Response> &responses) {
+    auto first = Url::parse(urls[indices.front()]);
+    std::string error;
+    Connection conn = acquire(*first, error);
+    if (conn.fd < 0) {
+      return indices;
+    }
+
+    std::string payload;
+    for (size_t i : indices) {
+      payload += build_request(*Url::parse(urls[i]),
+                               i < headers.size() ? headers[i] : Headers());
+    }
+    if (!send_all(conn.fd, payload)) {
+      close(conn.fd);
+      return indices;
+    }
+
+    std::vector<size_t> remaining;
+    bool keep_alive = true;
+    size_t done = 0;
+    for (; done < indices.size() && keep_alive; done++) {
+      Response &response = responses[indices[done]];
+      response.final_url = urls[indices[done]];
+      bool started = false;
+      bool is_redirect = false;
+      if (!read_response(
+              conn, response,
+              [&](const char *data, size_t n) {
+                if (!is_redirect)
+                  response.body.append(data, n);
+                return true;
+              },
+              started, keep_alive, &is_redirect)) {
+        keep_alive = false;
+        break;
+      }
+      if (is_redirect) {
+        remaining.push_back(indices[done]);
+      }
+    }
+    if (keep_alive) {
+      release(*first, conn, true);
+    } else {
+      close(conn.fd);
+    }
+    remaining.insert(remaining.end(), indices.begin() + done, indices.end());
+    return remaining;
+  }
+
+  Connection acquire(const Url &url, std::string &error) {
+    Connection conn;
+    {
+      std::lock_guard<std::mutex> lock(pool_mtx_);
+      auto &idle = idle_[url.authority()];
+      if (!idle.empty()) {
+        conn.fd = idle.back();
+        conn.reused = true;
+        idle.pop_back();
+        return conn;
+      }
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    int rc = getaddrinfo(url.host.c_str(), url.port.c_str(), &hints,
+                         &addresses);
+    if (rc != 0) {
+      error = "can't resolve " + url.host + ": " + gai_strerror(rc);
+      return conn;
+    }
+    for (addrinfo *ai = addresses; ai != nullptr; ai = ai->ai_next) {
+      int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC,
+                      ai->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      timeval timeout{kTimeoutSeconds, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        conn.fd = fd;
+        break;
+      }
+      close(fd);
+    }
+    freeaddrinfo(addresses);
+    if (conn.fd < 0) {
+      error = "can't connect to " + url.authority();
+    }
+    return conn;
+  }
+
+  void release(const Url &url, Connection &conn, bool keep_alive) {
+    // 有未读数据的连接不能复用
+    if (!keep_alive || conn.pos < conn.buffer.size()) {
+      close(conn.fd);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(pool_mtx_);
+    idle_[url.authority()].push_back(conn.fd);
+  }
+
+  static bool send_all(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = send(fd, data.data() + sent, data.size() - sent,
+                       MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  static bool fill(Connection &conn) {
+    if (conn.pos > 0 && conn.pos == conn.buffer.size()) {
+      conn.buffer.clear();
+      conn.pos = 0;
+    }
+    char chunk[64 * 1024];
+    while (true) {
+      ssize_t n = recv(conn.fd, chunk, sizeof(chunk), 0);
+      if (n > 0) {
+        conn.buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+      }
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+  }
+
+  static bool read_line(Connection &conn, std::string &line) {
+    while (true) {
+      size_t eol = conn.buffer.find("\r\n", conn.pos);
+      if (eol != std::string::npos) {
+        line = conn.buffer.substr(conn.pos, eol - conn.pos);
+        conn.pos = eol + 2;
+        return true;
+      }
+      if (!fill(conn)) {
+        return false;
+      }
+    }
+  }
+
+  // 读取定长数据交给sink
+  static bool read_exact(Connection &conn, uint64_t length, const Sink &sink) {
+    while (length > 0) {
+      if (conn.pos == conn.buffer.size() && !fill(conn)) {
+        return false;
+      }
+      size_t n = static_cast<size_t>(
+          std::min<uint64_t>(length, conn.buffer.size() - conn.pos));
+      if (!sink(conn.buffer.data() + conn.pos, n)) {
+        return false;
+      }
+      conn.pos += n;
+      length -= n;
+    }
+    return true;
+  }
+
+  static bool read_response(Connection &conn, Response &response,
+                            const Sink &sink, bool &started, bool &keep_alive,
+                            bool *is_redirect) {
+    std::string line;
+    if (!read_line(conn, line)) {
+      return false;
+    }
+    started = true;
+
+    // 状态行：HTTP/1.1 200 OK
+    if (line.rfind("HTTP/", 0) != 0 || line.size() < 12) {
+      response.error = "malformed status line";
+      return false;
+    }
+    bool http10 = line.compare(0, 8, "HTTP/1.0") == 0;
+    response.status = std::atoi(line.c_str() + 9);
+
+    while (read_line(conn, line) && !line.empty()) {
+      size_t colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      std::string key = line.substr(0, colon);
+      std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+      std::string value = line.substr(colon + 1);
+      value.erase(0, value.find_first_not_of(" \t"));
+      response.headers[key] = value;
+    }
+    if (!line.empty()) {
+      return false;
+    }
+
+    std::string connection = response.header("connection");
+    std::transform(connection.begin(), connection.end(), connection.begin(),
+                   ::tolower);
+    keep_alive = http10 ? connection == "keep-alive" : connection != "close";
+    if (is_redirect != nullptr) {
+      *is_redirect = response.status >= 300 && response.status < 400 &&
+                     !response.header("location").empty();
+    }
+
+    // 无响应体的状态码
+    if (response.status == 204 || response.status == 304 ||
+        response.status < 200) {
+      return true;
+    }
+
+    std::string encoding = response.header("transfer-encoding");
+    std::transform(encoding.begin(), encoding.end(), encoding.begin(),
+                   ::tolower);
+    if (encoding.find("chunked") != std::string::npos) {
+      while (true) {
+        if (!read_line(conn, line)) {
+          return false;
+        }
+        uint64_t size = std::strtoull(line.c_str(), nullptr, 16);
+        if (size == 0) {
+          // 跳过trailer
+          while (read_line(conn, line) && !line.empty()) {
+          }
+          return line.empty();
+        }
+        if (!read_exact(conn, size, sink) || !read_line(conn, line)) {
+          return false;
+        }
+      }
+    }
+
+    std::string length = response.header("content-length");
+    if (!length.empty()) {
+      return read_exact(conn, std::strtoull(length.c_str(), nullptr, 10),
+                        sink);
+    }
+
+    // 无长度信息：读到连接关闭
+    keep_alive = false;
+    while (true) {
+      if (conn.pos < conn.buffer.size()) {
+        if (!sink(conn.buffer.data() + conn.pos,
+                  conn.buffer.size() - conn.pos)) {
+          return false;
+        }
+        conn.pos = conn.buffer.size();
+      }
+      if (!fill(conn)) {
+        return true;
+      }
+    }
+  }
+};
+
+bool HttpClient::libcurl_for_http_ = false;
+#endif
+
+// 安全命令执行类
+class SafeCommandExecutor {
+public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+
+  // 内存中的获取结果（status为0表示网络错误）
+  struct FetchResponse {
+    int status = 0;
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+
+    bool ok() const { return status >= 200 && status < 300; }
+  };
+
+  // 安全执行命令并获取输出。pass_stderr为true时stderr直接显示在终端，
+  // 用于不解析输出、耗时较长的交互式命令（curl下载、unzip）
+  static std::string execute(const std::vector<std::string> &args,
+                             std::chrono::milliseconds timeout =
+                                 std::chrono::milliseconds::zero(),
+                             bool pass_stderr = false) {
+    if (args.empty()) {
+      throw std::invalid_argument("Command arguments cannot be empty");
+    }
+
+    // Validate each argument
+    for (const auto &arg : args) {
+      if (!is_safe_argument(arg)) {
+        throw std::runtime_error("Unsafe argument detected: " + arg);
+      }
+    }
+
+    // Build the command string for logging
+    std::string command_str;
+    for (const auto &arg : args) {
+      command_str += arg + " ";
+    }
+    std::cout << "Executing safe command: " << command_str << std::endl;
+
+    // 执行命令并返回其标准输出
+    return execute_posix(args, timeout, pass_stderr);
+  }
+  // 安全下载文件
+  static bool download_file(
+      const std::string &url, const fs::path &output_path,
+      const std::function<void(uint64_t, uint64_t)> &progress = nullptr) {
+    // 验证URL
+    if (!is_valid_url(url)) {
+      throw std::invalid_argument("Invalid URL format: " + url);
+    }
+
+    // 验证输出路径
+    if (output_path.empty() || output_path.is_relative()) {
+      throw std::invalid_argument("Output path must be absolute");
+    }
+
+    // 安全路径检查
+    if (output_path.string().find("..") != std::string::npos) {
+      throw std::invalid_argument(
+          "Output path contains parent directory traversal");
+    }
+
+    // 创建输出目录
+    if (!safe_create_directory(output_path.parent_path())) {
+      throw std::runtime_error("Failed to create output directory");
+    }
+
+    std::string source = url;
+#ifndef _WIN32
+    // 进程内下载（http以及链接libcurl时的https），复用连接；大文件分段并行下载
+    if (HttpClient::supports(url)) {
+      auto response = HttpClient::instance().download_segmented(
+          url, output_path, progress);
+      if (response.ok()) {
+        return true;
+      }
+      if (response.status != 0 || response.final_url.empty() ||
+          HttpClient::supports(response.final_url) ||
+          !is_valid_url(response.final_url)) {
+        if (cancelled()) {
+          return false;
+        }
+        std::cerr << "Download failed: "
+                  << (response.error.empty()
+                          ? "HTTP " + std::to_string(response.status)
+                          : response.error)
+                  << std::endl;
+        return false;
+      }
+      // 重定向到不支持的地址（未链接libcurl时的https）：交给curl继续
+      source = response.final_url;
+    }
+#endif
+
+    std::vector<std::string> args = {"curl",
+                                     "-f",      // HTTP错误时不写入错误页面
+                                     "-L",      // 跟随重定向
+                                     "-C", "-", // 续传已有的部分文件
+                                     "-o", output_path.string(), source};
+
+    try {
+      // curl失败时以非零状态退出，execute抛出异常
+      execute(args, std::chrono::milliseconds::zero(), true);
+      return true;
+    } catch (const std::exception &e) {
+      if (!cancelled()) {
+        std::cerr << "Download failed: " << e.what() << std::endl;
+      }
+      return false;
+    }
+  }
+
+  // 验证URL格式
+  // 在 SafeCommandExecutor 类中修改 is_valid_url 函数
+  static bool is_valid_url(const std::string &url) {
+    // 更简单但更健壮的URL验证
+    try {
+      // 基本检查：URL必须以http://或https://开头
+      if (url.find("http://") != 0 && url.find("https://") != 0) {
+        return false;
+      }
+
+      // 检查是否包含空格或控制字符
+      for (char c : url) {
+        if (std::isspace(c) || c < 0x20) {
+          return false;
+        }
+      }
+
+      // 检查是否包含可疑字符
+      if (url.find("..") != std::string::npos ||
+          url.find(";") != std::string::npos ||
+          url.find("|") != std::string::npos ||
+          url.find("`") != std::string::npos ||
+          url.find("$") != std::string::npos ||
+          url.find("(") != std::string::npos ||
+          url.find(")") != std::string::npos) {
+        return false;
+      }
+
+      // 对于已知的安全URL模式，直接放行
+      if (url.find("https://github.com/") == 0 ||
+          url.find("https://archives.boost.io/") == 0 ||
+          url.find("https://www.libsdl.org/") == 0) {
+        return true;
+      }
+
+      // 其他URL需要更严格的检查
+      static const std::regex domain_regex(
+          R"((?:[a-zA-Z0-9][a-zA-Z0-9-]{0,61}[a-zA-Z0-9]\.)+[a-zA-Z]{2,})");
+      static const std::regex ipv4_regex(
+          R"((?:(?:25[0-5]|2[0-4][0-9]|1?[0-9]{1,2})\.){3}(?:25[0-5]|2[0-4][0-9]|1?[0-9]{1,2}))");
+
+      // 提取域名部分
+      size_t start = url.find("://") + 3;
+      size_t end = url.find_first_of("/?#", start);
+      if (end == std::string::npos)
+        end = url.length();
+
+      std::string domain = url.substr(start, end - start);
+
+      // 允许显式端口（本地镜像、测试服务器）
+      size_t colon = domain.find(':');
+      if (colon != std::string::npos) {
+        std::string port = domain.substr(colon + 1);
+        if (port.empty() || port.size() > 5 ||
+            !std::all_of(port.begin(), port.end(), ::isdigit) ||
+            std::stoi(port) == 0 || std::stoi(port) > 65535) {
+          return false;
+        }
+        domain.erase(colon);
+      }
+
+      // 验证域名格式
+      return domain == "localhost" || std::regex_match(domain, ipv4_regex) ||
+             std::regex_match(domain, domain_regex);
+    } catch (const std::exception &e) {
+      std::cerr << "URL validation error: " << e.what() << "\n";
+      return false;
+    }
+  }
+
+  // 当前线程的请求是否已被取消（竞速中落败的请求不报告错误）
+  static bool cancelled() {
+#ifndef _WIN32
+    auto token = CancellationToken::current();
+    return token && token->cancelled();
+#else
+    return false;
+#endif
+  }
+
+  // 获取小文件（元数据）内容到内存，不经过临时文件；
+  // headers可携带If-None-Match等条件请求头，304时body为空
+  static FetchResponse fetch(const std::string &url,
+                             const Headers &headers = {}) {
+    if (!is_valid_url(url)) {
+      throw std::invalid_argument("Invalid URL format: " + url);
+    }
+#ifndef _WIN32
+    if (HttpClient::supports(url)) {
+      auto response = HttpClient::instance().get(url, headers);
+      // 只有重定向到不支持的地址时才交给curl
+      if (response.status != 0 || HttpClient::supports(response.final_url) ||
+          !is_valid_url(response.final_url)) {
+        FetchResponse result;
+        result.status = response.status;
+        result.body = std::move(response.body);
+        result.etag = response.header("etag");
+        result.last_modified = response.header("last-modified");
+        return result;
+      }
+      return fetch_with_curl(response.final_url, headers);
+    }
+#endif
+    return fetch_with_curl(url, headers);
+  }
+
+  // 安全解压文件
+  static bool unzip_file(const fs::path &zip_file, const fs::path &output_dir,
+                         const ZipExtractor::Filter &filter = {}) {
+    // 验证输入文件
+    if (!fs::exists(zip_file) || !fs::is_regular_file(zip_file)) {
+      throw std::invalid_argument("Invalid zip file: " + zip_file.string());
+    }
+
+    // 验证输出目录
+    if (!fs::exists(output_dir) || !fs::is_directory(output_dir)) {
+      throw std::invalid_argument("Invalid output directory: " +
+                                  output_dir.string());
+    }
+
+    // 安全路径检查
+    if (zip_file.string().find("..") != std::string::npos ||
+        output_dir.string().find("..") != std::string::npos) {
+      throw std::invalid_argument("Path contains parent directory traversal");
+    }
+
+    // 优先使用内置解压器，遇到不支持的压缩方法时回退到外部命令
+    try {
+      auto start = std::chrono::steady_clock::now();
+      ZipExtractor::Result result =
+          ZipExtractor::extract(zip_file, output_dir, filter);
+      if (result.unsupported == 0) {
+        for (const auto &failure : result.failures) {
+          std::cerr << "  Failed to extract " << failure << std::endl;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Extracted " << result.files << " files ("
+                  << result.bytes / 1024 << " KiB) in " << elapsed.count()
+                  << " ms";
+        if (result.skipped > 0) {
+          std::cout << ", skipped " << result.skipped << " unselected entries";
+        }
+        std::cout << "\n";
+        return result.failures.empty();
+      }
+      std::cerr << result.unsupported
+                << " entries use unsupported compression methods, falling "
+                   "back to external unzip"
+                << std::endl;
+    } catch (const std::exception &e) {
+      std::cerr << "Built-in unzip failed: " << e.what()
+                << ", falling back to external unzip" << std::endl;
+    }
+
+    // 外部命令不理解过滤规则：有过滤时先解压到暂存目录，再只移入选中的条目
+    const fs::path target =
+        filter.empty() ? output_dir
+                       : output_dir / (".unzip-staging-" +
+                                       std::to_string(getpid()));
+#ifdef _WIN32
+    std::vector<std::string> args = {
+        "powershell",      "-Command",         "Expand-Archive",   "-Path",
+        zip_file.string(), "-DestinationPath", target.string()};
+#else
+    std::vector<std::string> args = {"unzip", "-o", zip_file.string(), "-d",
+                                     target.string()};
+#endif
+
+    bool ok;
+    try {
+      execute(args, std::chrono::milliseconds::zero(), true);
+      ok = filter.empty() || move_selected(target, output_dir, filter);
+    } catch (const std::exception &e) {
+      std::cerr << "Unzip failed: " << e.what() << std::endl;
+      ok = false;
+    }
+    if (!filter.empty()) {
+      std::error_code ec;
+      fs::remove_all(target, ec);
+    }
+    return ok;
+  }
+
+  // 将暂存目录中被过滤规则选中的文件和目录移到输出目录（覆盖已有文件）
+  static bool move_selected(const fs::path &staging, const fs::path &output_dir,
+                            const ZipExtractor::Filter &filter) {
+    std::vector<fs::path> selected;
+    size_t skipped = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(staging, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      const std::string name =
+          it->path().lexically_relative(staging).generic_string();
+      const bool is_directory = it->is_directory(ec);
+      // 未选中的目录仍要遍历：其中的文件可能被include规则选中
+      if (filter.accepts(name, is_directory)) {
+        selected.push_back(it->path());
+      } else {
+        skipped++;
+      }
+    }
+    if (ec) {
+      std::cerr << "Failed to read " << staging.string() << ": "
+                << ec.message() << std::endl;
+      return false;
+    }
+
+    bool ok = true;
+    size_t moved = 0;
+    for (const auto &path : selected) {
+      const fs::path destination =
+          output_dir / path.lexically_relative(staging);
+      if (fs::is_directory(path, ec)) {
+        fs::create_directories(destination, ec);
+        continue;
+      }
+      fs::create_directories(destination.parent_path(), ec);
+      fs::remove(destination, ec);
+      fs::rename(path, destination, ec);
+      if (ec) {
+        std::cerr << "  Failed to extract "
+                  << path.lexically_relative(staging).generic_string() << ": "
+                  << ec.message() << std::endl;
+        ok = false;
+        continue;
+      }
+      moved++;
+    }
+    std::cout << "Extracted " << moved << " files, skipped " << skipped
+              << " unselected entries\n";
+    return ok;
+  }
+
+  // 安全创建目录
+  static bool safe_create_directory(const fs::path &path) {
+    try {
+      if (!fs::exists(path)) {
+        return fs::create_directories(path);
+      }
+      return true;
+    } catch (const fs::filesystem_error &e) {
+      std::cerr << "Error creating directory: " << e.what() << std::endl;
+      return false;
+    }
+  }
+
+private:
+  // POSIX命令执行
+  static std::string execute_posix(const std::vector<std::string> &args,
+                                   std::chrono::milliseconds timeout,
+                                   bool pass_stderr) {
+#ifdef _WIN32
+    // Windows版本使用_popen，stderr本来就直接输出到终端
+    (void)timeout;
+    (void)pass_stderr;
+    std::string command;
+    for (const auto &arg : args) {
+      if (!command.empty())
+        command += " ";
+      command += arg;
+    }
+
+    std::array<char, 128> buffer;
+    std::string result;
+    std::unique_ptr<FILE, decltype(&_pclose)> pipe(_popen(command.c_str(), "r"),
+                                                   _pclose);
+
+    if (!pipe) {
+      throw std::runtime_error("_popen() failed!");
+    }
+
+    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
+      result += buffer.data();
+    }
+
+    return result;
+#else
+    // 交给进程管理器执行，多个调用者的子进程由同一个监督线程并行处理
+    ProcessManager::Result result =
+        ProcessManager::instance().run(args, timeout, !pass_stderr);
+
+    if (result.timed_out) {
+      throw std::runtime_error("Command timed out: " + args[0]);
+    }
+    if (result.cancelled) {
+      throw std::runtime_error("Command cancelled: " + args[0]);
+    }
+    if (result.signal != 0) {
+      throw std::runtime_error("Command terminated by signal " +
+                               std::to_string(result.signal));
+    }
+    if (result.exit_code != 0) {
+      std::string message = "Command exited with non-zero status: " +
+                            std::to_string(result.exit_code);
+      // 附带stderr的最后一行便于诊断
+      std::string details = result.err;
+      while (!details.empty() && std::isspace(static_cast<unsigned char>(
+                                     details.back()))) {
+        details.pop_back();
+      }
+      details = details.substr(details.find_last_of('\n') + 1);
+      if (!details.empty()) {
+        message += " (" + details + ")";
+      }
+      throw std::runtime_error(message);
+    }
+
+    return result.out;
+#endif
+  }
+
+  // 通过curl把响应头和内容输出到stdout
+  static FetchResponse fetch_with_curl(const std::string &url,
+                                       const Headers &headers) {
+    std::vector<std::string> args = {"curl", "-sSL", "-D", "-"};
+    for (const auto &header : headers) {
+      std::string line = header.first + ": " + header.second;
+      if (is_safe_argument(line)) {
+        args.push_back("-H");
+        args.push_back(line);
+      }
+    }
+    args.push_back(url);
+
+    FetchResponse result;
+    std::string out;
+    try {
+      out = execute(args);
+    } catch (const std::exception &e) {
+      if (!cancelled()) {
+        std::cerr << "Download failed: " << e.what() << std::endl;
+      }
+      return result;
+    }
+
+    // 跟随重定向时有多组响应头，以最后一组为准
+    size_t pos = 0;
+    while (out.compare(pos, 5, "HTTP/") == 0) {
+      size_t end = out.find("\r\n\r\n", pos);
+      if (end == std::string::npos) {
+        return FetchResponse();
+      }
+      std::istringstream block(out.substr(pos, end - pos));
+      std::string line;
+      std::getline(block, line);
+      size_t space = line.find(' ');
+      result.status =
+          space == std::string::npos ? 0 : std::atoi(line.c_str() + space + 1);
+      result.etag.clear();
+      result.last_modified.clear();
+      while (std::getline(block, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+          continue;
+        }
+        std::string key = line.substr(0, colon);
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r") + 1);
+        if (key == "etag") {
+          result.etag = value;
+        } else if (key == "last-modified") {
+          result.last_modified = value;
+        }
+      }
+      pos = end + 4;
+    }
+    result.body = out.substr(pos);
+    return result;
+  }
+
+
+  // Windows参数转义
+  static std::string escape_windows_arg(const std::string &arg) {
+    std::string escaped;
+    for (char c : arg) {
+      if (c == '"') {
+        escaped += "\\\"";
+      } else if (c == '\\') {
+        escaped += "\\\\";
+      } else {
+        escaped += c;
+      }
+    }
+    return escaped;
+  }
+
+  // 验证参数安全性
+  static bool is_safe_argument(const std::string &arg) {
+    // 禁止命令分隔符
+    if (arg.find(';') != std::string::npos ||
+        arg.find('|') != std::string::npos ||
+        arg.find('&') != std::string::npos ||
+        arg.find('$') != std::string::npos ||
+        arg.find('`') != std::string::npos ||
+        arg.find('>') != std::string::npos ||
+        arg.find('<') != std::string::npos) {
+      return false;
+    }
+
+    // 禁止目录遍历
+    if (arg.find("..") != std::string::npos) {
+      return false;
+    }
+
+    return true;
+  }
+};
+
+// JSON文档：两阶段解析（SIMD结构索引 + 沿索引构建紧凑节点数组），
+// 字符串以string_view指向源文本，含转义的字符串解码到文档内的解码区；
+// 文档移动后不可再使用之前取得的JsonValue
+class JsonDocument;
+
+class JsonValue {
+public:
+  enum class Type : uint8_t {
+    NONE, // 不存在的成员
+    NUL,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+  };
+
+  JsonValue() = default;
+
+  Type type() const;
+  bool valid() const { return doc_ != nullptr; }
+  bool is_null() const { return type() == Type::NUL; }
+  bool is_bool() const { return type() == Type::BOOLEAN; }
+  bool is_number() const { return type() == Type::NUMBER; }
+  bool is_string() const { return type() == Type::STRING; }
+  bool is_array() const { return type() == Type::ARRAY; }
+  bool is_object() const { return type() == Type::OBJECT; }
+
+  std::string_view as_string(std::string_view fallback = {}) const;
+  double as_number(double fallback = 0) const;
+  bool as_bool(bool fallback = false) const;
+
+  // 原始JSON文本（用于原样转存子树）
+  std::string_view raw() const;
+
+  // 数组元素数或对象成员数
+  size_t size() const;
+
+  // 对象成员；不存在时返回无效值
+  JsonValue operator[](std::string_view key) const;
+  JsonValue at(size_t index) const;
+
+  // 遍历对象成员 f(key, value) 或数组元素 f(value)
+  template <typename F> void for_each_member(F f) const;
+  template <typename F> void for_each_element(F f) const;
+
+private:
+  friend class JsonDocument;
+  JsonValue(const JsonDocument *doc, uint32_t index)
+      : doc_(doc), index_(index) {}
+
+  const JsonDocument *doc_ = nullptr;
+  uint32_t index_ = 0;
+};
+
+class JsonDocument {
+public:
+  static std::optional<JsonDocument> parse(std::string text,
+                                           std::string *error = nullptr) {
+    JsonDocument doc;
+    doc.text_ = std::make_unique<std::string>(std::move(text));
+    Parser parser(doc);
+    if (!parser.run()) {
+      if (error) {
+        *error = parser.error();
+      }
+      return std::nullopt;
+    }
+    return doc;
+  }
+
+  JsonValue root() const { return JsonValue(this, 0); }
+
+  // 生成带引号和转义的JSON字符串
+  static std::string quote(std::string_view value) {
+    std::string out;
+    out.reserve(value.size() + 2);
+    out += '"';
+    for (char c : value) {
+      switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out += escaped;
+        } else {
+          out += c;
+        }
+      }
+    }
+    out += '"';
+    return out;
+  }
+
+private:
+  friend class JsonValue;
+
+  // 容器节点的子节点紧随其后；end为子树之后的下标，用于跳过整个子树
+  struct Node {
+    JsonValue::Type type = JsonValue::Type::NUL;
+    uint32_t count = 0;
+    uint32_t end = 0;
+    uint32_t raw_begin = 0;
+    uint32_t raw_end = 0;
+    std::string_view text;
+    double number = 0;
+  };
+
+  std::unique_ptr<std::string> text_;
+  std::vector<Node> nodes_;
+  // 含转义字符串的解码区：解码结果不长于源文本，一次分配后只追加，
+  // 已发出的string_view始终有效
+  std::unique_ptr<char[]> arena_;
+  size_t arena_used_ = 0;
+
+  JsonDocument() = default;
+
+  // 第一阶段：每次处理64字节，用SIMD比较得到引号、反斜杠、结构字符和
+  // 空白的位掩码，按位运算求出字符串内部区域，输出所有结构字符
+  // （{}[]:, 、字符串的起止引号和标量起始位置）的偏移
+  class StructuralIndexer {
+  public:
+    static bool run(std::string_view src, std::vector<uint32_t> &out) {
+      out.reserve(src.size() / 6 + 4);
+      uint64_t prev_escaped = 0;  // 上一块末尾的反斜杠转义了本块首字符
+      uint64_t prev_in_string = 0; // 上一块结束时仍在字符串内（全1）
+      uint64_t prev_scalar = 0;    // 上一块末尾是非引号标量字符
+      uint8_t tail[64];
+      for (size_t base = 0; base < src.size(); base += 64) {
+        const uint8_t *block =
+            reinterpret_cast<const uint8_t *>(src.data()) + base;
+        if (src.size() - base < 64) {
+          std::memset(tail, ' ', sizeof(tail));
+          std::memcpy(tail, block, src.size() - base);
+          block = tail;
+        }
+        Masks masks = classify(block);
+
+        uint64_t escaped = escaped_chars(masks.backslash, prev_escaped);
+        uint64_t quotes = masks.quote & ~escaped;
+        uint64_t in_string = prefix_xor(quotes) ^ prev_in_string;
+        prev_in_string = static_cast<uint64_t>(
+            -static_cast<int64_t>(in_string >> 63));
+
+        uint64_t scalar = ~(masks.op | masks.space);
+        uint64_t nonquote_scalar = scalar & ~quotes;
+        uint64_t follows_scalar = nonquote_scalar << 1 | prev_scalar;
+        prev_scalar = nonquote_scalar >> 63;
+        uint64_t starts = scalar & ~follows_scalar;
+        // 去除字符串内部，保留起止引号
+        uint64_t structurals = ((masks.op | starts) & ~in_string) | quotes;
+
+        while (structurals != 0) {
+          uint32_t offset = static_cast<uint32_t>(base) +
+                            static_cast<uint32_t>(trailing_zeros(structurals));
+          if (offset >= src.size()) {
+            break;
+          }
+          out.push_back(offset);
+          structurals &= structurals - 1;
+        }
+      }
+      return prev_in_string == 0;
+    }
+
+  private:
+    struct Masks {
+      uint64_t quote = 0;
+      uint64_t backslash = 0;
+      uint64_t op = 0;    // {}[]:,
+      uint64_t space = 0; // 空格、\t、\n、\r
+    };
+
+#ifdef SLN2CODE_JSON_SSE2
+    static Masks classify(const uint8_t *block) {
+      Masks masks;
+      for (int lane = 0; lane < 4; lane++) {
+        __m128i chunk = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(block + 16 * lane));
+        auto eq = [&](char c) {
+          return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c));
+        };
+        auto bits = [](__m128i mask) {
+          return static_cast<uint64_t>(
+              static_cast<uint16_t>(_mm_movemask_epi8(mask)));
+        };
+        const int shift = 16 * lane;
+        masks.quote |= bits(eq('"')) << shift;
+        masks.backslash |= bits(eq('\\')) << shift;
+        masks.op |= bits(_mm_or_si128(
+                        _mm_or_si128(_mm_or_si128(eq('{'), eq('}')),
+                                     _mm_or_si128(eq('['), eq(']'))),
+                        _mm_or_si128(eq(':'), eq(','))))
+                    << shift;
+        masks.space |= bits(_mm_or_si128(_mm_or_si128(eq(' '), eq('\t')),
+                                         _mm_or_si128(eq('\n'), eq('\r'))))
+                       << shift;
+      }
+      return masks;
+    }
+#else
+    static Masks classify(const uint8_t *block) {
+      Masks masks;
+      for (int i = 0; i < 64; i++) {
+        const uint64_t bit = uint64_t(1) << i;
+        switch (block[i]) {
+        case '"':
+          masks.quote |= bit;
+          break;
+        case '\\':
+          masks.backslash |= bit;
+          break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+          masks.op |= bit;
+          break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+          masks.space |= bit;
+          break;
+        default:
+          break;
+        }
+      }
+      return masks;
+    }
+#endif
+
+    // 被奇数个连续反斜杠转义的字符；开销只与反斜杠数量有关
+    static uint64_t escaped_chars(uint64_t backslash, uint64_t &carry) {
+      uint64_t escaped = carry;
+      uint64_t pending = backslash & ~carry;
+      carry = 0;
+      while (pending != 0) {
+        int i = trailing_zeros(pending);
+        if (i == 63) {
+          carry = 1;
+          break;
+        }
+        escaped |= uint64_t(1) << (i + 1);
+        pending &= ~(uint64_t(3) << i);
+      }
+      return escaped;
+    }
+
+    // 前缀异或：每一位等于其及之前所有位的异或，得到“位于引号对之间”
+    static uint64_t prefix_xor(uint64_t x) {
+      x ^= x << 1;
+      x ^= x << 2;
+      x ^= x << 4;
+      x ^= x << 8;
+      x ^= x << 16;
+      x ^= x << 32;
+      return x;
+    }
+  };
+
+  // x不为0
+  static int trailing_zeros(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int count = 0;
+    while ((x & 1) == 0) {
+      x >>= 1;
+      count++;
+    }
+    return count;
+#endif
+  }
+
+  // 第二阶段：沿结构字符偏移做递归下降，构建节点数组
+  class Parser {
+  public:
+    explicit Parser(JsonDocument &doc)
+        : doc_(doc), src_(*doc.text_), next_(0) {}
+
+    bool run() {
+      if (src_.size() >= std::numeric_limits<uint32_t>::max()) {
+        return fail("document too large", 0);
+      }
+      if (!StructuralIndexer::run(src_, index_)) {
+        return fail("unterminated string", src_.size());
+      }
+      if (index_.empty()) {
+        return fail("empty document", 0);
+      }
+      doc_.nodes_.reserve(index_.size() / 2 + 1);
+      if (!value(0)) {
+        return false;
+      }
+      return next_ == index_.size() || fail("trailing characters", peek());
+    }
+
+    const std::string &error() const { return error_; }
+
+  private:
+    static constexpr int kMaxDepth = 512;
+
+    JsonDocument &doc_;
+    std::string_view src_;
+    std::vector<uint32_t> index_;
+    size_t next_;
+    std::string error_;
+
+    bool fail(const std::string &message, size_t pos) {
+      if (error_.empty()) {
+        error_ = message + " at offset " + std::to_string(pos);
+      }
+      return false;
+    }
+
+    // 下一个结构字符的偏移，用尽时为文本末尾
+    size_t peek() const {
+      return next_ < index_.size() ? index_[next_] : src_.size();
+    }
+
+    char peek_char() const {
+      return next_ < index_.size() ? src_[index_[next_]] : '\0';
+    }
+
+    uint32_t push(JsonValue::Type type, size_t pos) {
+      Node node;
+      node.type = type;
+      node.raw_begin = static_cast<uint32_t>(pos);
+      doc_.nodes_.push_back(node);
+      return static_cast<uint32_t>(doc_.nodes_.size() - 1);
+    }
+
+    void finish(uint32_t index, size_t end) {
+      doc_.nodes_[index].end = static_cast<uint32_t>(doc_.nodes_.size());
+      doc_.nodes_[index].raw_end = static_cast<uint32_t>(end);
+    }
+
+    bool value(int depth) {
+      if (depth > kMaxDepth) {
+        return fail("nesting too deep", peek());
+      }
+      if (next_ >= index_.size()) {
+        return fail("unexpected end", src_.size());
+      }
+      size_t pos = index_[next_++];
+      switch (src_[pos]) {
+      case '{':
+        return object(pos, depth);
+      case '[':
+        return array(pos, depth);
+      case '"':
+        return string(pos);
+      case 't':
+        return literal(pos, "true", JsonValue::Type::BOOLEAN, 1);
+      case 'f':
+        return literal(pos, "false", JsonValue::Type::BOOLEAN, 0);
+      case 'n':
+        return literal(pos, "null", JsonValue::Type::NUL, 0);
+      default:
+        return number(pos);
+      }
+    }
+
+    // 标量之后必须是空白、结构字符或文本末尾
+    bool scalar_ends(size_t end) const {
+      if (end >= src_.size()) {
+        return true;
+      }
+      switch (src_[end]) {
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+      case ',':
+      case ':':
+      case ']':
+      case '}':
+      case '[':
+      case '{':
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    bool literal(size_t pos, std::string_view word, JsonValue::Type type,
+                 double number) {
+      if (src_.substr(pos, word.size()) != word ||
+          !scalar_ends(pos + word.size())) {
+        return fail("invalid literal", pos);
+      }
+      uint32_t index = push(type, pos);
+      doc_.nodes_[index].number = number;
+      finish(index, pos + word.size());
+      return true;
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool number(size_t pos) {
+      size_t end = pos;
+      auto digits = [&] {
+        size_t begin = end;
+        while (end < src_.size() &&
+               std::isdigit(static_cast<unsigned char>(src_[end]))) {
+          end++;
+        }
+        return end - begin;
+      };
+      if (end < src_.size() && src_[end] == '-') {
+        end++;
+      }
+      const size_t digits_begin = end;
+      const size_t int_digits = digits();
+      bool valid = int_digits > 0 &&
+                   (int_digits == 1 || src_[digits_begin] != '0');
+      bool integral = true;
+      if (valid && end < src_.size() && src_[end] == '.') {
+        end++;
+        integral = false;
+        valid = digits() > 0;
+      }
+      if (valid && end < src_.size() && (src_[end] == 'e' || src_[end] == 'E')) {
+        end++;
+        integral = false;
+        if (end < src_.size() && (src_[end] == '+' || src_[end] == '-')) {
+          end++;
+        }
+        valid = digits() > 0;
+      }
+      if (!valid || !scalar_ends(end)) {
+        return fail("invalid number", pos);
+      }
+
+      double parsed = 0;
+      if (integral && end - digits_begin <= 15) {
+        // 常见的短整数直接累加，避免复制和strtod
+        int64_t magnitude = 0;
+        for (size_t i = digits_begin; i < end; i++) {
+          magnitude = magnitude * 10 + (src_[i] - '0');
+        }
+        parsed = static_cast<double>(pos == digits_begin ? magnitude
+                                                         : -magnitude);
+      } else {
+        std::string digits(src_.substr(pos, end - pos));
+        char *parsed_end = nullptr;
+        parsed = std::strtod(digits.c_str(), &parsed_end);
+        if (parsed_end != digits.c_str() + digits.size()) {
+          return fail("invalid number", pos);
+        }
+      }
+      uint32_t index = push(JsonValue::Type::NUMBER, pos);
+      doc_.nodes_[index].number = parsed;
+      finish(index, end);
+      return true;
+    }
+
+    static char *append_utf8(char *out, uint32_t cp) {
+      if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+      } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xc0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+      } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xe0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+      } else {
+        *out++ = static_cast<char>(0xf0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+      }
+      return out;
+    }
+
+    bool hex4(size_t &pos, size_t limit, uint32_t &cp) {
+      if (pos + 4 > limit) {
+        return fail("truncated \\u escape", pos);
+      }
+      cp = 0;
+      for (int i = 0; i < 4; i++) {
+        char c = src_[pos++];
+        cp <<= 4;
+        if (c >= '0' && c <= '9')
+          cp |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+          cp |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+          cp |= c - 'A' + 10;
+        else
+          return fail("invalid \\u escape", pos);
+      }
+      return true;
+    }
+
+    // 结束引号是下一个结构字符
+    bool string(size_t pos) {
+      uint32_t index = push(JsonValue::Type::STRING, pos);
+      if (next_ >= index_.size() || src_[index_[next_]] != '"') {
+        return fail("unterminated string", pos);
+      }
+      const size_t start = pos + 1;
+      const size_t end = index_[next_++];
+      const char *data = src_.data();
+      const char *slash = static_cast<const char *>(
+          std::memchr(data + start, '\\', end - start));
+      // 快速路径：无转义时直接引用源文本
+      if (slash == nullptr) {
+        doc_.nodes_[index].text = src_.substr(start, end - start);
+        finish(index, end + 1);
+        return true;
+      }
+
+      // 解码到文档的解码区（\uXXXX的UTF-8编码不长于转义本身）
+      if (!doc_.arena_) {
+        doc_.arena_.reset(new char[src_.size()]);
+      }
+      char *begin = doc_.arena_.get() + doc_.arena_used_;
+      char *out = begin;
+      size_t done = start;
+      while (slash != nullptr) {
+        size_t cursor = static_cast<size_t>(slash - data);
+        std::memcpy(out, data + done, cursor - done);
+        out += cursor - done;
+        char e = src_[++cursor];
+        cursor++;
+        switch (e) {
+        case '"':
+        case '\\':
+        case '/':
+          *out++ = e;
+          break;
+        case 'b':
+          *out++ = '\b';
+          break;
+        case 'f':
+          *out++ = '\f';
+          break;
+        case 'n':
+          *out++ = '\n';
+          break;
+        case 'r':
+          *out++ = '\r';
+          break;
+        case 't':
+          *out++ = '\t';
+          break;
+        case 'u': {
+          uint32_t cp = 0;
+          if (!hex4(cursor, end, cp)) {
+            return false;
+          }
+          // UTF-16代理对；后面不是低位代理时按单独的码元处理
+          if (cp >= 0xd800 && cp < 0xdc00 &&
+              src_.substr(cursor, 2) == "\\u") {
+            size_t next = cursor + 2;
+            uint32_t low = 0;
+            if (!hex4(next, end, low)) {
+              return false;
+            }
+            if (low >= 0xdc00 && low < 0xe000) {
+              cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+              cursor = next;
+            }
+          }
+          out = append_utf8(out, cp);
+          break;
+        }
+        default:
+          return fail("invalid escape", cursor - 1);
+        }
+        done = cursor;
+        slash = static_cast<const char *>(
+            std::memchr(data + done, '\\', end - done));
+      }
+      std::memcpy(out, data + done, end - done);
+      out += end - done;
+      doc_.arena_used_ += static_cast<size_t>(out - begin);
+      doc_.nodes_[index].text =
+          std::string_view(begin, static_cast<size_t>(out - begin));
+      finish(index, end + 1);
+      return true;
+    }
+
+    bool array(size_t pos, int depth) {
+      uint32_t index = push(JsonValue::Type::ARRAY, pos);
+      uint32_t count = 0;
+      if (peek_char() == ']') {
+        finish(index, index_[next_++] + 1);
+        return true;
+      }
+      while (true) {
+        if (!value(depth + 1)) {
+          return false;
+        }
+        count++;
+        char c = peek_char();
+        if (c == ',') {
+          next_++;
+          continue;
+        }
+        if (c == ']') {
+          break;
+        }
+        return fail("expected ',' or ']'", peek());
+      }
+      doc_.nodes_[index].count = count;
+      finish(index, index_[next_++] + 1);
+      return true;
+    }
+
+    bool object(size_t pos, int depth) {
+      uint32_t index = push(JsonValue::Type::OBJECT, pos);
+      uint32_t count = 0;
+      if (peek_char() == '}') {
+        finish(index, index_[next_++] + 1);
+        return true;
+      }
+      while (true) {
+        if (peek_char() != '"') {
+          return fail("expected object key", peek());
+        }
+        if (!string(index_[next_++])) {
+          return false;
+        }
+        if (peek_char() != ':') {
+          return fail("expected ':'", peek());
+        }
+        next_++;
+        if (!value(depth + 1)) {
+          return false;
+        }
+        count++;
+        char c = peek_char();
+        if (c == ',') {
+          next_++;
+          continue;
+        }
+        if (c == '}') {
+          break;
+        }
+        return fail("expected ',' or '}'", peek());
+      }
+      doc_.nodes_[index].count = count;
+      finish(index, index_[next_++] + 1);
+      return true;
+    }
+  };
+};
+
+inline JsonValue::Type JsonValue::type() const {
+  return doc_ ? doc_->nodes_[index_].type : Type::NONE;
+}
+
+inline std::string_view JsonValue::as_string(std::string_view fallback) const {
+  return is_string() ? doc_->nodes_[index_].text : fallback;
+}
+
+inline double JsonValue::as_number(double fallback) const {
+  return is_number() ? doc_->nodes_[index_].number : fallback;
+}
+
+inline bool JsonValue::as_bool(bool fallback) const {
+  return is_bool() ? doc_->nodes_[index_].number != 0 : fallback;
+}
+
+inline std::string_view JsonValue::raw() const {
+  if (!doc_) {
+    return {};
+  }
+  const auto &node = doc_->nodes_[index_];
+  return std::string_view(*doc_->text_)
+      .substr(node.raw_begin, node.raw_end - node.raw_begin);
+}
+
+inline size_t JsonValue::size() const {
+  return is_array() || is_object() ? doc_->nodes_[index_].count : 0;
+}
+
+inline JsonValue JsonValue::operator[](std::string_view key) const {
+  JsonValue found;
+  for_each_member([&](std::string_view name, JsonValue value) {
+    if (!found.valid() && name == key) {
+      found = value;
+    }
+  });
+  return found;
+}
+
+inline JsonValue JsonValue::at(size_t index) const {
+  JsonValue found;
+  size_t i = 0;
+  for_each_element([&](JsonValue value) {
+    if (i++ == index) {
+      found = value;
+    }
+  });
+  return found;
+}
+
+template <typename F> void JsonValue::for_each_member(F f) const {
+  if (!is_object()) {
+    return;
+  }
+  const auto &nodes = doc_->nodes_;
+  uint32_t child = index_ + 1;
+  for (uint32_t i = 0; i < nodes[index_].count; i++) {
+    uint32_t value = child + 1;
+    f(nodes[child].text, JsonValue(doc_, value));
+    child = nodes[value].end;
+  }
+}
+
+template <typename F> void JsonValue::for_each_element(F f) const {
+  if (!is_array()) {
+    return;
+  }
+  const auto &nodes = doc_->nodes_;
+  uint32_t child = index_ + 1;
+  for (uint32_t i = 0; i < nodes[index_].count; i++) {
+    f(JsonValue(doc_, child));
+    child = nodes[child].end;
+  }
+}
+
+// 实用工具类
+class Utils {
+public:
+  // 清理路径输入
+  static std::string clean_path(const std::string &input) {
+    std::string cleaned = input;
+
+    // 替换反斜杠为正斜杠
+    std::replace(cleaned.begin(), cleaned.end(), '\\', '/');
+
+    // 移除末尾的斜杠
+    if (!cleaned.empty() && cleaned.back() == '/' && cleaned.size() > 1) {
+      cleaned.pop_back();
+    }
+
+    return cleaned;
+  }
+
+  // 库名会拼进镜像URL、HTTP请求行和缓存文件名，只允许[A-Za-z0-9._+-]，
+  // 且不能以点开头
+  static bool is_valid_library_name(const std::string &name) {
+    return !name.empty() && name.size() <= 128 && name[0] != '.' &&
+           std::all_of(name.begin(), name.end(), [](unsigned char c) {
+             return std::isalnum(c) || c == '.' || c == '_' || c == '+' ||
+                    c == '-';
+           });
+  }
+
+  // 获取有效项目名称
+  static std::string get_valid_name(const std::string &input) {
+    if (input.find_first_of(";&|<>`$()") != std::string::npos) {
+      throw std::invalid_argument("Invalid characters in project name");
+    }
+    std::string name = input;
+
+    // 移除非字母数字字符（允许连字符和下划线）
+    name.erase(std::remove_if(name.begin(), name.end(),
+                              [](char c) {
+                                return !(std::isalnum(c) || c == '-' ||
+                                         c == '_' || c == ' ');
+                              }),
+               name.end());
+
+    // 替换空格为连字符
+    std::replace(name.begin(), name.end(), ' ', '-');
+
+    // 转换为小写
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    return name;
+  }
+
+  // 检查编译器是否支持指定标准
+  static bool is_standard_supported(const CompilerConfig &compiler,
+                                    const std::string &standard) {
+    // 简化实现：实际项目中应调用编译器获取支持的标准列表
+    return true;
+  }
+
+  // 安全执行系统命令
+  static int execute_command(const std::string &command) {
+    std::cout << "Executing: " << command << std::endl;
+    return std::system(command.c_str());
+  }
+
+  // 安全执行命令（使用SafeCommandExecutor）
+  static std::string
+  safe_execute_command(const std::vector<std::string> &args) {
+    return SafeCommandExecutor::execute(args);
+  }
+
+  // 安全下载文件
+  static bool safe_download_file(
+      const std::string &url, const fs::path &output_path,
+      const std::function<void(uint64_t, uint64_t)> &progress = nullptr) {
+    return SafeCommandExecutor::download_file(url, output_path, progress);
+  }
+
+  // 获取远程内容到内存
+  static SafeCommandExecutor::FetchResponse
+  safe_fetch(const std::string &url,
+             const SafeCommandExecutor::Headers &headers = {}) {
+    return SafeCommandExecutor::fetch(url, headers);
+  }
+
+  // 安全解压文件
+  static bool safe_unzip_file(const fs::path &zip_file,
+                              const fs::path &output_dir,
+                              const ZipExtractor::Filter &filter = {}) {
+    return SafeCommandExecutor::unzip_file(zip_file, output_dir, filter);
+  }
+
+  // 安全创建目录
+  static bool safe_create_directory(const fs::path &path) {
+    return SafeCommandExecutor::safe_create_directory(path);
+  }
+
+  // 跨平台路径拼接
+  static fs::path join_paths(const fs::path &base, const std::string &part) {
+    return base / part;
+  }
+
+  // 安全写入文件
+  static bool safe_write_file(const fs::path &path,
+                              const std::string &content) {
+    try {
+      std::ofstream file(path);
+      if (!file)
+        return false;
+      file << content;
+      return true;
+    } catch (const std::exception &e) {
+      std::cerr << "Error writing file: " << e.what() << std::endl;
+      return false;
+    }
+  }
+
+  enum class WriteResult { CREATED, UPDATED, UNCHANGED, FAILED };
+
+  // 仅在内容变化时写入，未变化的文件保留原有的修改时间，
+  // 不会触发CMake重新配置或编辑器重新索引
+  static WriteResult write_if_changed(const fs::path &path,
+                                      const std::string &content) {
+    std::error_code ec;
+    const bool exists = fs::is_regular_file(path, ec);
+    if (exists && same_content(path, content)) {
+      return WriteResult::UNCHANGED;
+    }
+    if (!safe_write_file(path, content)) {
+      return WriteResult::FAILED;
+    }
+    return exists ? WriteResult::UPDATED : WriteResult::CREATED;
+  }
+
+  // 文件内容是否与content相同：先比较大小，大小相同再映射文件逐字节比较
+  static bool same_content(const fs::path &path, const std::string &content) {
+#ifdef _WIN32
+    // safe_write_file以文本模式写入，磁盘上的换行为\r\n
+    std::string expected;
+    expected.reserve(content.size() + content.size() / 32);
+    for (char c : content) {
+      if (c == '\n') {
+        expected += '\r';
+      }
+      expected += c;
+    }
+#else
+    const std::string &expected = content;
+#endif
+    std::error_code ec;
+    const uintmax_t size = fs::file_size(path, ec);
+    if (ec || size != expected.size()) {
+      return false;
+    }
+    if (expected.empty()) {
+      return true;
+    }
+    try {
+      MappedFile file(path);
+      return file.size() == expected.size() &&
+             std::memcmp(file.data(), expected.data(), expected.size()) == 0;
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
+  // 安全读取文件
+  static std::string safe_read_file(const fs::path &path) {
+    try {
+      std::ifstream file(path);
+      if (!file)
+        return "";
+      std::string content((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+      return content;
+    } catch (const std::exception &e) {
+      std::cerr << "Error reading file: " << e.what() << std::endl;
+      return "";
+    }
+  }
+
+  // 简单字符串修剪
+  static std::string trim(const std::string &str) {
+    auto start = std::find_if_not(str.begin(), str.end(),
+                                  [](int c) { return std::isspace(c); });
+    auto end = std::find_if_not(str.rbegin(), str.rend(), [](int c) {
+                 return std::isspace(c);
+               }).base();
+    return (start < end) ? std::string(start, end) : std::string();
+  }
+
+  // 拆分以'\n'连接的列表
+  static std::vector<std::string> split_lines(std::string_view joined) {
+    std::vector<std::string> items;
+    while (!joined.empty()) {
+      size_t end = joined.find('\n');
+      items.emplace_back(joined.substr(0, end));
+      joined.remove_prefix(end == std::string_view::npos ? joined.size()
+                                                         : end + 1);
+    }
+    return items;
+  }
+};
+
+// 内容寻址的本地压缩包缓存（按SHA256存放，跨项目、跨进程共享）
+class ArchiveCache {
+public:
+  static void configure(bool enabled, const std::string &dir,
+                        uint64_t max_megabytes) {
+    enabled_ = enabled;
+    if (!dir.empty()) {
+      root_override_ = dir;
+    }
+    if (max_megabytes > 0) {
+      max_bytes_ = max_megabytes * 1024 * 1024;
+    }
+  }
+
+  static bool enabled() { return enabled_; }
+
+  static uint64_t max_bytes() { return max_bytes_; }
+
+  // 缓存根目录：--cache-dir > SLN2CODE_CACHE_DIR > XDG_CACHE_HOME > ~/.cache
+  static fs::path cache_root() {
+    if (!root_override_.empty()) {
+      return root_override_;
+    }
+    if (const char *dir = std::getenv("SLN2CODE_CACHE_DIR"); dir && *dir) {
+      return dir;
+    }
+#ifdef _WIN32
+    if (const char *dir = std::getenv("LOCALAPPDATA"); dir && *dir) {
+      return fs::path(dir) / "SLN2Code" / "cache";
+    }
+#else
+    if (const char *dir = std::getenv("XDG_CACHE_HOME"); dir && *dir) {
+      return fs::path(dir) / "sln2code";
+    }
+    if (const char *home = std::getenv("HOME"); home && *home) {
+      return fs::path(home) / ".cache" / "sln2code";
+    }
+#endif
+    return fs::temp_directory_path() / "sln2code-cache";
+  }
+
+  // 只有启用缓存且摘要合法时才使用缓存
+  static bool usable(const std::string &digest) {
+    if (!enabled_ || digest.size() != 64) {
+      return false;
+    }
+    return std::all_of(digest.begin(), digest.end(), [](unsigned char c) {
+      return std::isxdigit(c) != 0;
+    });
+  }
+
+  // 查找缓存的压缩包，命中时刷新访问时间（用于LRU）
+  static std::optional<fs::path> lookup(const std::string &digest) {
+    if (!usable(digest)) {
+      return std::nullopt;
+    }
+    const fs::path path = entry_path(digest);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+      return std::nullopt;
+    }
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return path;
+  }
+
+  // 下载文件放在条目同目录下的固定位置：rename是原子的，中断后还能续传
+  static fs::path download_path(const std::string &digest) {
+    const fs::path final_path = entry_path(digest);
+    Utils::safe_create_directory(final_path.parent_path());
+    return final_path.parent_path() / (final_path.stem().string() + ".download");
+  }
+
+  // 同一摘要的下载、校验和提交在进程间互斥：.download文件被多个进程共享，
+  // 截断、续传和校验失败时的删除都必须在锁内进行
+  class DownloadLock {
+  public:
+    explicit DownloadLock(const std::string &digest) {
+#ifndef _WIN32
+      const fs::path path = download_path(digest).replace_extension(".lock");
+      // 锁文件可能被evict当作残留删除：加锁后确认路径仍指向同一文件
+      while (true) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+          return;
+        }
+        if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+          std::cout << "Waiting for another process downloading "
+                    << digest.substr(0, 12) << "...\n";
+          while (flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+              return; // 不支持文件锁的文件系统：不加锁继续
+            }
+          }
+        }
+        struct stat held, current;
+        if (fstat(fd_, &held) == 0 && ::stat(path.c_str(), &current) == 0 &&
+            held.st_dev == current.st_dev && held.st_ino == current.st_ino) {
+          return;
+        }
+        ::close(fd_);
+      }
+#endif
+    }
+    ~DownloadLock() {
+#ifndef _WIN32
+      if (fd_ >= 0) {
+        ::close(fd_);
+      }
+#endif
+    }
+    DownloadLock(const DownloadLock &) = delete;
+    DownloadLock &operator=(const DownloadLock &) = delete;
+
+  private:
+    int fd_ = -1;
+  };
+
+  // 将已校验的临时文件原子地提交到缓存
+  static std::optional<fs::path> commit(const std::string &digest,
+                                        const fs::path &temp_file) {
+    const fs::path final_path = entry_path(digest);
+    std::error_code ec;
+    fs::rename(temp_file, final_path, ec);
+    if (ec) {
+      // 另一个进程可能已经提交了相同内容
+      fs::remove(temp_file, ec);
+      if (!fs::is_regular_file(final_path, ec)) {
+        return std::nullopt;
+      }
+    }
+    evict(final_path);
+    return final_path;
+  }
+
+  // 超出容量上限时按最近使用时间淘汰（keep为刚提交、即将使用的条目）
+  static void evict(const fs::path &keep = {}) {
+    const fs::path dir = archives_dir();
+#ifndef _WIN32
+    // 文件锁保证多个进程不会同时淘汰
+    int lock_fd = ::open((dir / ".lock").c_str(),
+                         O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd < 0) {
+      return;
+    }
+    if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+      ::close(lock_fd);
+      return;
+    }
+#endif
+    struct CachedFile {
+      fs::path path;
+      uint64_t size;
+      fs::file_time_type used;
+    };
+    std::vector<CachedFile> files;
+    uint64_t total = 0;
+    std::error_code ec;
+    const auto stale_before =
+        fs::file_time_type::clock::now() - std::chrono::hours(24 * 7);
+    std::vector<fs::path> stale;
+    for (auto it = fs::recursive_directory_iterator(dir, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (!it->is_regular_file(ec) || it->path().filename() == ".lock") {
+        continue;
+      }
+      if (it->path().extension() != ".zip") {
+        // 一周未续传的下载残留
+        if (it->last_write_time(ec) < stale_before) {
+          stale.push_back(it->path());
+        }
+        continue;
+      }
+      uint64_t size = it->file_size(ec);
+      files.push_back({it->path(), size, it->last_write_time(ec)});
+      total += size;
+    }
+    for (const auto &path : stale) {
+      fs::remove(path, ec);
+    }
+
+    if (total > max_bytes_) {
+      std::sort(files.begin(), files.end(),
+                [](const CachedFile &a, const CachedFile &b) {
+                  return a.used < b.used;
+                });
+      for (const auto &file : files) {
+        if (total <= max_bytes_) {
+          break;
+        }
+        if (file.path != keep && fs::remove(file.path, ec)) {
+          total -= file.size;
+        }
+      }
+    }
+#ifndef _WIN32
+    flock(lock_fd, LOCK_UN);
+    ::close(lock_fd);
+#endif
+  }
+
+private:
+  static bool enabled_;
+  static fs::path root_override_;
+  static uint64_t max_bytes_;
+
+  static fs::path archives_dir() { return cache_root() / "archives"; }
+
+  static fs::path entry_path(const std::string &digest) {
+    std::string key = digest;
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    return archives_dir() / key.substr(0, 2) / (key + ".zip");
+  }
+};
+
+bool ArchiveCache::enabled_ = true;
+fs::path ArchiveCache::root_override_;
+uint64_t ArchiveCache::max_bytes_ = [] {
+  if (const char *mb = std::getenv("SLN2CODE_CACHE_MAX_MB"); mb && *mb) {
+    try {
+      return std::stoull(mb) * 1024 * 1024;
+    } catch (...) {
+    }
+  }
+  return 4096ull * 1024 * 1024;
+}();
+
+// 镜像统计：按来源（scheme://host:port）记录延迟、吞吐量和连续失败次数，
+// 持久化到缓存目录，用于决定镜像的先后顺序
+class MirrorStats {
+public:
+  static std::string origin(const std::string &url) {
+    size_t start = url.find("://");
+    if (start == std::string::npos) {
+      return url;
+    }
+    return url.substr(0, url.find('/', start + 3));
+  }
+
+  static void record_latency(const std::string &url, double milliseconds) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry &entry = entry_locked(url);
+    entry.latency_ms = blend(entry.latency_ms, milliseconds);
+    entry.failures = 0;
+    save_locked();
+  }
+
+  static void record_throughput(const std::string &url,
+                                double bytes_per_second) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry &entry = entry_locked(url);
+    entry.throughput = blend(entry.throughput, bytes_per_second);
+    entry.failures = 0;
+    save_locked();
+  }
+
+  static void record_failure(const std::string &url) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entry_locked(url).failures++;
+    save_locked();
+  }
+
+  // 延迟低的在前；没有记录的镜像排在已知镜像之前以便探测
+  static std::vector<std::string>
+  rank_by_latency(std::vector<std::string> urls) {
+    return rank(std::move(urls), [](const Entry &a, const Entry &b) {
+      return a.latency_ms < b.latency_ms;
+    });
+  }
+
+  // 吞吐量高的在前
+  static std::vector<std::string>
+  rank_by_throughput(std::vector<std::string> urls) {
+    return rank(std::move(urls), [](const Entry &a, const Entry &b) {
+      return a.throughput > b.throughput;
+    });
+  }
+
+private:
+  struct Entry {
+    double latency_ms = 0;
+    double throughput = 0;
+    unsigned failures = 0;
+  };
+
+  static std::mutex mtx_;
+  static bool loaded_;
+  static std::map<std::string, Entry> entries_;
+
+  // 指数加权平均，新样本权重0.3
+  static double blend(double previous, double sample) {
+    return previous <= 0 ? sample : previous * 0.7 + sample * 0.3;
+  }
+
+  static fs::path stats_path() {
+    return ArchiveCache::cache_root() / "mirrors.tsv";
+  }
+
+  template <typename Better>
+  static std::vector<std::string> rank(std::vector<std::string> urls,
+                                       Better better) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    load_locked();
+    std::vector<std::pair<std::string, Entry>> ranked;
+    for (auto &url : urls) {
+      auto it = entries_.find(origin(url));
+      ranked.emplace_back(std::move(url), it == entries_.end() ? Entry()
+                                                                : it->second);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [&](const auto &a, const auto &b) {
+                       if (a.second.failures != b.second.failures) {
+                         return a.second.failures < b.second.failures;
+                       }
+                       bool a_known = a.second.latency_ms > 0 ||
+                                      a.second.throughput > 0;
+                       bool b_known = b.second.latency_ms > 0 ||
+                                      b.second.throughput > 0;
+                       if (a_known != b_known) {
+                         return !a_known;
+                       }
+                       return better(a.second, b.second);
+                     });
+    urls.clear();
+    for (auto &entry : ranked) {
+      urls.push_back(std::move(entry.first));
+    }
+    return urls;
+  }
+
+  static Entry &entry_locked(const std::string &url) {
+    load_locked();
+    return entries_[origin(url)];
+  }
+
+  static void load_locked() {
+    if (loaded_) {
+      return;
+    }
+    loaded_ = true;
+    std::ifstream file(stats_path());
+    std::string line;
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string key;
+      Entry entry;
+      if (std::getline(fields, key, '\t') &&
+          fields >> entry.latency_ms >> entry.throughput >> entry.failures) {
+        entries_[key] = entry;
+      }
+    }
+  }
+
+  // 写入临时文件后rename，并发的进程不会读到写了一半的文件
+  static void save_locked() {
+    if (!ArchiveCache::enabled()) {
+      return;
+    }
+    const fs::path path = stats_path();
+    if (!Utils::safe_create_directory(path.parent_path())) {
+      return;
+    }
+    fs::path temp = path;
+    temp += ".tmp." + std::to_string(getpid());
+    {
+      std::ofstream file(temp, std::ios::trunc);
+      for (const auto &entry : entries_) {
+        file << entry.first << '\t' << entry.second.latency_ms << '\t'
+             << entry.second.throughput << '\t' << entry.second.failures
+             << '\n';
+      }
+      if (!file) {
+        return;
+      }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+  }
+};
+
+std::mutex MirrorStats::mtx_;
+bool MirrorStats::loaded_ = false;
+std::map<std::string, MirrorStats::Entry> MirrorStats::entries_;
+
+// 持久化的元数据缓存：镜像上的libraries.json和<lib>.json按镜像组存放，
+// TTL内直接使用，过期后用ETag/Last-Modified条件请求重新验证；离线时使用过期数据
+class MetadataCache {
+public:
+  struct Entry {
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+    int64_t fetched = 0; // Unix时间（秒）
+
+    bool fresh() const { return now() - fetched < ttl_.count(); }
+
+    // 重新验证用的条件请求头
+    SafeCommandExecutor::Headers conditional_headers() const {
+      SafeCommandExecutor::Headers headers;
+      if (!etag.empty()) {
+        headers.emplace_back("If-None-Match", etag);
+      }
+      if (!last_modified.empty()) {
+        headers.emplace_back("If-Modified-Since", last_modified);
+      }
+      return headers;
+    }
+  };
+
+  static void configure(std::optional<std::chrono::seconds> ttl, bool offline) {
+    if (ttl) {
+      ttl_ = *ttl;
+    }
+    offline_ = offline;
+  }
+
+  static bool offline() { return offline_; }
+
+  // 镜像组的标识：镜像列表的CRC32，不同镜像组的数据互不混用
+  static std::string scope_of(std::vector<std::string> mirrors) {
+    std::sort(mirrors.begin(), mirrors.end());
+    uint32_t crc = 0;
+    for (const auto &mirror : mirrors) {
+      crc = CRC32::update(crc, reinterpret_cast<const uint8_t *>(mirror.data()),
+                          mirror.size() + 1);
+    }
+    std::ostringstream hex;
+    hex << std::hex << std::setw(8) << std::setfill('0') << crc;
+    return hex.str();
+  }
+
+  // with_body为false时只读元数据
+  static std::optional<Entry> load(const std::string &scope,
+                                   const std::string &file,
+                                   bool with_body = true) {
+    if (!cacheable(file)) {
+      return std::nullopt;
+    }
+    const fs::path path = entry_path(scope, file);
+    std::ifstream meta(path.string() + ".meta");
+    if (!meta) {
+      return std::nullopt;
+    }
+    Entry entry;
+    std::string line;
+    while (std::getline(meta, line)) {
+      size_t tab = line.find('\t');
+      if (tab == std::string::npos) {
+        continue;
+      }
+      std::string key = line.substr(0, tab);
+      std::string value = line.substr(tab + 1);
+      if (key == "fetched") {
+        entry.fetched = std::atoll(value.c_str());
+      } else if (key == "etag") {
+        entry.etag = value;
+      } else if (key == "last-modified") {
+        entry.last_modified = value;
+      }
+    }
+    if (!with_body) {
+      return entry;
+    }
+    std::ifstream body(path, std::ios::binary);
+    if (!body) {
+      return std::nullopt;
+    }
+    entry.body.assign(std::istreambuf_iterator<char>(body),
+                      std::istreambuf_iterator<char>());
+    return entry;
+  }
+
+  // 写入新内容；先写内容再写元数据，两者都经临时文件rename
+  static void store(const std::string &scope, const std::string &file,
+                    const Entry &entry) {
+    if (!cacheable(file)) {
+      return;
+    }
+    const fs::path path = entry_path(scope, file);
+    if (!Utils::safe_create_directory(path.parent_path())) {
+      return;
+    }
+    if (write_atomic(path, entry.body)) {
+      write_meta(path, entry);
+    }
+  }
+
+  // 304：内容未变，只刷新获取时间
+  static void revalidated(const std::string &scope, const std::string &file,
+                          Entry &entry) {
+    entry.fetched = now();
+    if (cacheable(file)) {
+      write_meta(entry_path(scope, file), entry);
+    }
+  }
+
+  static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static fs::path entry_path(const std::string &scope,
+                             const std::string &file) {
+    return ArchiveCache::cache_root() / "metadata" / scope / file;
+  }
+
+  static bool write_atomic(const fs::path &path, const std::string &content) {
+    fs::path temp = path;
+    temp += ".tmp." + std::to_string(getpid());
+    {
+      std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+      file.write(content.data(), static_cast<std::streamsize>(content.size()));
+      if (!file) {
+        return false;
+      }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    return !ec;
+  }
+
+private:
+  static std::chrono::seconds ttl_;
+  static bool offline_;
+
+  // 文件名来自库名，只缓存不含路径成分的名字
+  static bool cacheable(const std::string &file) {
+    return !file.empty() && file[0] != '.' &&
+           std::all_of(file.begin(), file.end(), [](unsigned char c) {
+             return std::isalnum(c) || c == '.' || c == '_' || c == '-' ||
+                    c == '+';
+           });
+  }
+
+  static void write_meta(const fs::path &path, const Entry &entry) {
+    std::ostringstream meta;
+    meta << "fetched\t" << entry.fetched << "\n";
+    meta << "etag\t" << entry.etag << "\n";
+    meta << "last-modified\t" << entry.last_modified << "\n";
+    write_atomic(path.string() + ".meta", meta.str());
+  }
+};
+
+std::chrono::seconds MetadataCache::ttl_{24 * 60 * 60};
+bool MetadataCache::offline_ = false;
+
+// 编译后的库索引：按名称排序的记录表 + 完美哈希目录，内存映射后直接查询，
+// 启动开销与目录大小无关。布局（小端）：
+//   头部 | seeds[buckets] | slots[slot_count] | records[count] | 字符串区
+// 记录保存各字段在字符串区的偏移与长度，列表字段以'\n'连接
+class LibraryIndex {
+public:
+  // 由目录生成索引文件；stamp用于判断索引是否与来源目录一致
+  static bool compile(const std::map<std::string, ThirdPartyLibrary> &libraries,
+                      uint64_t stamp, const fs::path &output) {
+    const uint32_t count = static_cast<uint32_t>(libraries.size());
+    const uint32_t buckets = count / 3 + 1;
+    const uint32_t slot_count = count + count / 4 + 1;
+
+    // 为每个桶寻找使其所有键落入空槽的种子（大桶优先）
+    std::vector<std::vector<uint32_t>> members(buckets);
+    std::vector<uint64_t> hashes;
+    for (const auto &library : libraries) {
+      uint64_t h = hash(library.first);
+      members[mix(h, 0) % buckets].push_back(
+          static_cast<uint32_t>(hashes.size()));
+      hashes.push_back(h);
+    }
+    std::vector<uint32_t> order(buckets);
+    for (uint32_t b = 0; b < buckets; ++b) {
+      order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return members[a].size() > members[b].size();
+    });
+    std::vector<uint32_t> seeds(buckets, 0);
+    std::vector<uint32_t> slots(slot_count, kEmpty);
+    std::vector<uint32_t> chosen;
+    for (uint32_t b : order) {
+      if (members[b].empty()) {
+        break;
+      }
+      bool placed = false;
+      for (uint32_t seed = 0; seed < kMaxSeed && !placed; ++seed) {
+        chosen.clear();
+        placed = true;
+        for (uint32_t record : members[b]) {
+          uint32_t slot =
+              static_cast<uint32_t>(mix(hashes[record], seed + 1) % slot_count);
+          if (slots[slot] != kEmpty ||
+              std::find(chosen.begin(), chosen.end(), slot) != chosen.end()) {
+            placed = false;
+            break;
+          }
+          chosen.push_back(slot);
+        }
+        if (placed) {
+          seeds[b] = seed;
+          for (size_t k = 0; k < chosen.size(); ++k) {
+            slots[chosen[k]] = members[b][k];
+          }
+        }
+      }
+      if (!placed) {
+        return false;
+      }
+    }
+
+    // 字符串区（相同内容只存一份）
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> interned;
+    std::string records;
+    auto add_field = [&](const std::string &value) {
+      auto it = interned.find(value);
+      uint32_t offset;
+      if (it != interned.end()) {
+        offset = it->second;
+      } else {
+        offset = static_cast<uint32_t>(strings.size());
+        strings += value;
+        interned.emplace(value, offset);
+      }
+      put32(records, offset);
+      put32(records, static_cast<uint32_t>(value.size()));
+    };
+    auto join = [](const std::vector<std::string> &items) {
+      std::string joined;
+      for (const auto &item : items) {
+        joined += (joined.empty() ? "" : "\n") + item;
+      }
+      return joined;
+    };
+    for (const auto &library : libraries) {
+      const ThirdPartyLibrary &lib = library.second;
+      add_field(library.first);
+      add_field(lib.downloadUrl);
+      add_field(lib.includePath);
+      add_field(lib.libPath);
+      add_field(lib.configInstructions);
+      add_field(lib.sha256);
+      add_field(join(lib.dependencies));
+      add_field(join(lib.extractInclude));
+      add_field(join(lib.extractExclude));
+      add_field(join(lib.mirrorUrls));
+      add_field(lib.description);
+      add_field(join(lib.tags));
+      add_field(join(lib.primaryHeaders));
+    }
+
+    std::string blob(kMagic, sizeof(kMagic));
+    put32(blob, count);
+    put32(blob, buckets);
+    put32(blob, slot_count);
+    put32(blob, 0);
+    put64(blob, stamp);
+    const uint64_t total = kHeaderSize + 4ull * (buckets + slot_count) +
+                           records.size() + strings.size();
+    if (total > std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+    put64(blob, total);
+    for (uint32_t seed : seeds) {
+      put32(blob, seed);
+    }
+    for (uint32_t slot : slots) {
+      put32(blob, slot);
+    }
+    blob += records;
+    blob += strings;
+    return MetadataCache::write_atomic(output, blob);
+  }
+
+  // 打开索引；文件缺失、损坏或与stamp不符时返回nullptr
+  static std::unique_ptr<LibraryIndex> open(const fs::path &path,
+                                            uint64_t stamp) {
+    std::error_code ec;
+    if (!fs::exists(path, ec)) {
+      return nullptr;
+    }
+    std::unique_ptr<LibraryIndex> index(new LibraryIndex());
+    try {
+      index->file_ = std::make_unique<MappedFile>(path);
+    } catch (const std::exception &) {
+      return nullptr;
+    }
+    const uint8_t *data = index->file_->data();
+    const size_t size = index->file_->size();
+    if (size < kHeaderSize ||
+        std::memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+        read64(data + 24) != stamp || read64(data + 32) != size) {
+      return nullptr;
+    }
+    index->count_ = read32(data + 8);
+    index->buckets_ = read32(data + 12);
+    index->slot_count_ = read32(data + 16);
+    index->seeds_ = data + kHeaderSize;
+    index->slots_ = index->seeds_ + 4ull * index->buckets_;
+    index->records_ = index->slots_ + 4ull * index->slot_count_;
+    index->strings_ = index->records_ + kRecordSize * index->count_;
+    if (index->buckets_ == 0 || index->slot_count_ < index->count_ ||
+        static_cast<size_t>(index->strings_ - data) > size) {
+      return nullptr;
+    }
+    index->strings_size_ = size - static_cast<size_t>(index->strings_ - data);
+    return index;
+  }
+
+  size_t size() const { return count_; }
+
+  // 按名称排序的全部库名
+  std::vector<std::string> names() const {
+    std::vector<std::string> result;
+    result.reserve(count_);
+    for (uint32_t i = 0; i < count_; ++i) {
+      result.emplace_back(field(i, 0));
+    }
+    return result;
+  }
+
+  std::optional<ThirdPartyLibrary> find(std::string_view name) const {
+    if (count_ == 0) {
+      return std::nullopt;
+    }
+    uint64_t h = hash(name);
+    uint32_t seed = read32(seeds_ + 4 * (mix(h, 0) % buckets_));
+    uint32_t record = read32(slots_ + 4 * (mix(h, seed + 1) % slot_count_));
+    if (record >= count_ || field(record, 0) != name) {
+      return std::nullopt;
+    }
+    return entry(record);
+  }
+
+  // 第i个库（按名称排序）
+  ThirdPartyLibrary entry(size_t record) const {
+    const auto split = Utils::split_lines;
+    ThirdPartyLibrary lib_info;
+    lib_info.name = std::string(field(record, 0));
+    lib_info.downloadUrl = std::string(field(record, 1));
+    lib_info.includePath = std::string(field(record, 2));
+    lib_info.libPath = std::string(field(record, 3));
+    lib_info.configInstructions = std::string(field(record, 4));
+    lib_info.sha256 = std::string(field(record, 5));
+    lib_info.dependencies = split(field(record, 6));
+    lib_info.extractInclude = split(field(record, 7));
+    lib_info.extractExclude = split(field(record, 8));
+    lib_info.mirrorUrls = split(field(record, 9));
+    lib_info.description = std::string(field(record, 10));
+    lib_info.tags = split(field(record, 11));
+    lib_info.primaryHeaders = split(field(record, 12));
+    return lib_info;
+  }
+
+private:
+  static constexpr char kMagic[8] = {'S', 'L', 'N', 'I', 'D', 'X', '0', '3'};
+  static constexpr size_t kHeaderSize = 40;
+  static constexpr size_t kFields = 13;
+  static constexpr size_t kRecordSize = kFields * 8;
+  static constexpr uint32_t kEmpty = 0xffffffffu;
+  static constexpr uint32_t kMaxSeed = 1u << 20;
+
+  std::unique_ptr<MappedFile> file_;
+  uint32_t count_ = 0;
+  uint32_t buckets_ = 0;
+  uint32_t slot_count_ = 0;
+  const uint8_t *seeds_ = nullptr;
+  const uint8_t *slots_ = nullptr;
+  const uint8_t *records_ = nullptr;
+  const uint8_t *strings_ = nullptr;
+  size_t strings_size_ = 0;
+
+  LibraryIndex() = default;
+
+  // 越界的字段视为空，损坏的索引不会读出映射范围
+  std::string_view field(uint32_t record, size_t index) const {
+    const uint8_t *p = records_ + kRecordSize * record + 8 * index;
+    uint64_t offset = read32(p);
+    uint64_t length = read32(p + 4);
+    if (offset + length > strings_size_) {
+      return {};
+    }
+    return std::string_view(reinterpret_cast<const char *>(strings_) + offset,
+                            static_cast<size_t>(length));
+  }
+
+  // FNV-1a
+  static uint64_t hash(std::string_view text) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : text) {
+      h = (h ^ c) * 0x100000001b3ull;
+    }
+    return h;
+  }
+
+  // 按种子打散（splitmix64终结函数）
+  static uint64_t mix(uint64_t h, uint64_t seed) {
+    h ^= seed * 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+  }
+
+  static void put32(std::string &out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+  }
+
+  static void put64(std::string &out, uint64_t value) {
+    put32(out, static_cast<uint32_t>(value));
+    put32(out, static_cast<uint32_t>(value >> 32));
+  }
+
+  static uint32_t read32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+  }
+
+  static uint64_t read64(const uint8_t *p) {
+    return static_cast<uint64_t>(read32(p)) |
+           static_cast<uint64_t>(read32(p + 4)) << 32;
+  }
+};
+
+// 库信息提供者接口
+class ILibraryInfoProvider {
+public:
+  virtual ~ILibraryInfoProvider() = default;
+
+  // 获取所有可用库的名称列表
+  virtual std::vector<std::string> get_available_libraries() = 0;
+
+  // 获取所有可用库的摘要（name为库名，附带简介和标签），供搜索使用；
+  // 默认只有名称
+  virtual std::vector<ThirdPartyLibrary> get_library_summaries() {
+    std::vector<ThirdPartyLibrary> summaries;
+    for (const auto &name : get_available_libraries()) {
+      summaries.emplace_back();
+      summaries.back().name = name;
+    }
+    return summaries;
+  }
+
+  // 获取指定库的详细信息
+  virtual std::optional<ThirdPartyLibrary>
+  get_library_info(const std::string &lib_name) = 0;
+
+  // 批量预取库信息，远程提供者可合并请求；默认不做任何事
+  virtual void prefetch_library_info(const std::vector<std::string> &) {}
+
+  // 刷新库信息（从远程源更新）
+  virtual bool refresh_library_info() = 0;
+
+  // 获取提供者名称
+  virtual std::string get_provider_name() const = 0;
+};
+
+// 内置库信息提供者
+class BuiltinLibraryProvider : public ILibraryInfoProvider {
+public:
+  std::vector<std::string> get_available_libraries() override {
+    std::vector<std::string> libs;
+    for (const auto &entry : Constants::BUILTIN_LIBRARIES) {
+      libs.emplace_back(entry.key);
+    }
+    return libs;
+  }
+
+  std::vector<ThirdPartyLibrary> get_library_summaries() override {
+    std::vector<ThirdPartyLibrary> summaries;
+    for (const auto &entry : Constants::BUILTIN_LIBRARIES) {
+      summaries.push_back(materialize(entry.value));
+      summaries.back().name = std::string(entry.key);
+    }
+    return summaries;
+  }
+
+  std::optional<ThirdPartyLibrary>
+  get_library_info(const std::string &lib_name) override {
+    if (auto lib = Constants::BUILTIN_LIBRARIES.find(lib_name)) {
+      return materialize(*lib);
+    }
+    return std::nullopt;
+  }
+
+  bool refresh_library_info() override {
+    // 内置库不需要刷新
+    return true;
+  }
+
+  std::string get_provider_name() const override {
+    return "Built-in Library Provider";
+  }
+
+private:
+  // 只在查询时把只读数据复制为ThirdPartyLibrary
+  static ThirdPartyLibrary materialize(const BuiltinLibrary &lib) {
+    ThirdPartyLibrary lib_info;
+    lib_info.name = std::string(lib.name);
+    lib_info.downloadUrl = std::string(lib.downloadUrl);
+    lib_info.includePath = std::string(lib.includePath);
+    lib_info.libPath = std::string(lib.libPath);
+    lib_info.dependencies = Utils::split_lines(lib.dependencies);
+    lib_info.configInstructions = std::string(lib.configInstructions);
+    lib_info.sha256 = std::string(lib.sha256);
+    lib_info.extractInclude = Utils::split_lines(lib.extractInclude);
+    lib_info.extractExclude = Utils::split_lines(lib.extractExclude);
+    lib_info.mirrorUrls = Utils::split_lines(lib.mirrorUrls);
+    lib_info.description = std::string(lib.description);
+    lib_info.tags = Utils::split_lines(lib.tags);
+    lib_info.primaryHeaders = Utils::split_lines(lib.primaryHeaders);
+    return lib_info;
+  }
+};
+
+// 远程库信息提供者
+class RemoteLibraryProvider : public ILibraryInfoProvider {
+public:
+  explicit RemoteLibraryProvider(const std::vector<std::string> &mirror_urls) {
+    for (const auto &url : mirror_urls) {
+      mirror_urls_.push_back(ensure_trailing_slash(url));
+    }
+    cache_scope_ = MetadataCache::scope_of(mirror_urls_);
+  }
+
+  std::vector<std::string> get_available_libraries() override {
+    if (ensure_catalog() && index_) {
+      return index_->names();
+    }
+    if (available_libraries_.empty()) {
+      refresh_library_info();
+    }
+    return available_libraries_;
+  }
+
+  // 合并目录包含简介和标签；旧式镜像只能提供名称
+  std::vector<ThirdPartyLibrary> get_library_summaries() override {
+    if (!ensure_catalog()) {
+      return ILibraryInfoProvider::get_library_summaries();
+    }
+    std::vector<ThirdPartyLibrary> summaries;
+    if (index_) {
+      summaries.reserve(index_->size());
+      for (size_t i = 0; i < index_->size(); ++i) {
+        summaries.push_back(index_->entry(i));
+      }
+    } else {
+      for (const auto &name : available_libraries_) {
+        summaries.push_back(library_cache_[name]);
+      }
+    }
+    return summaries;
+  }
+
+  std::optional<ThirdPartyLibrary>
+  get_library_info(const std::string &lib_name) override {
+    // 首先检查缓存（合并目录已全部载入内存）
+    auto it = library_cache_.find(lib_name);
+    if (it != library_cache_.end()) {
+      return it->second;
+    }
+    if (ensure_catalog()) {
+      if (!index_) {
+        return std::nullopt;
+      }
+      auto lib_info = index_->find(lib_name);
+      if (lib_info) {
+        library_cache_[lib_name] = *lib_info;
+      }
+      return lib_info;
+    }
+
+    // 从远程获取库信息
+    if (!Utils::is_valid_library_name(lib_name)) {
+      std::cerr << "Invalid library name: " << lib_name << std::endl;
+      return std::nullopt;
+    }
+    auto json_content = fetch(lib_name + ".json");
+    if (!json_content) {
+      std::cerr << "Failed to download library info for " << lib_name
+                << std::endl;
+      return std::nullopt;
+    }
+    if (json_content->empty()) {
+      std::cerr << "Failed to read library info for " << lib_name << std::endl;
+      return std::nullopt;
+    }
+
+    // 添加到缓存
+    ThirdPartyLibrary lib_info = parse_library_info(*json_content);
+    library_cache_[lib_name] = lib_info;
+    return lib_info;
+  }
+
+  // 先用磁盘缓存中未过期的库信息；其余的通过一条流水线连接从延迟最低的
+  // http镜像获取（过期条目发送条件请求）。未取到的由get_library_info逐个竞速补齐
+  void prefetch_library_info(const std::vector<std::string> &lib_names) override {
+    if (ensure_catalog()) {
+      return;
+    }
+    std::vector<std::string> names;
+    std::vector<std::optional<MetadataCache::Entry>> cached;
+    for (const auto &lib_name : lib_names) {
+      if (!Utils::is_valid_library_name(lib_name) ||
+          library_cache_.count(lib_name) ||
+          std::find(names.begin(), names.end(), lib_name) != names.end()) {
+        continue;
+      }
+      auto entry = MetadataCache::load(cache_scope_, lib_name + ".json");
+      if (entry && (entry->fresh() || MetadataCache::offline())) {
+        library_cache_[lib_name] = parse_library_info(entry->body);
+        continue;
+      }
+      names.push_back(lib_name);
+      cached.push_back(std::move(entry));
+    }
+#ifndef _WIN32
+    auto mirrors = MirrorStats::rank_by_latency(mirror_urls_);
+    auto mirror = std::find_if(mirrors.begin(), mirrors.end(),
+                               HttpClient::supports);
+    if (names.size() < 2 || MetadataCache::offline() ||
+        mirror == mirrors.end()) {
+      return;
+    }
+    std::vector<std::string> urls;
+    std::vector<HttpClient::Headers> headers;
+    for (size_t i = 0; i < names.size(); i++) {
+      urls.push_back(*mirror + names[i] + ".json");
+      headers.push_back(cached[i] ? cached[i]->conditional_headers()
+                                  : HttpClient::Headers());
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto responses = HttpClient::instance().get_many(urls, headers);
+    MirrorStats::record_latency(
+        *mirror, std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                         .count() /
+                     names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+      SafeCommandExecutor::FetchResponse response;
+      response.status = responses[i].status;
+      response.body = std::move(responses[i].body);
+      response.etag = responses[i].header("etag");
+      response.last_modified = responses[i].header("last-modified");
+      if (auto body = adopt(names[i] + ".json", cached[i], response)) {
+        library_cache_[names[i]] = parse_library_info(*body);
+      }
+    }
+#endif
+  }
+
+  bool refresh_library_info() override {
+    if (ensure_catalog()) {
+      return true;
+    }
+
+    // 镜像没有合并目录时下载库列表
+    auto list_content = fetch("libraries.json");
+    if (!list_content) {
+      std::cerr << "Failed to download library list" << std::endl;
+      return false;
+    }
+
+    std::string json_content = std::move(*list_content);
+    if (json_content.empty()) {
+      std::cerr << "Failed to read library list" << std::endl;
+      return false;
+    }
+
+    // 解析库列表（字符串数组）
+    std::string error;
+    auto doc = JsonDocument::parse(std::move(json_content), &error);
+    if (!doc || !doc->root().is_array()) {
+      std::cerr << "Invalid library list: "
+                << (doc ? "expected an array" : error) << std::endl;
+      return false;
+    }
+    available_libraries_.clear();
+    doc->root().for_each_element([&](JsonValue name) {
+      if (!name.as_string().empty()) {
+        available_libraries_.emplace_back(name.as_string());
+      }
+    });
+
+    return true;
+  }
+
+  std::string get_provider_name() const override {
+    std::string mirrors;
+    for (const auto &url : mirror_urls_) {
+      mirrors += (mirrors.empty() ? "" : ", ") + url;
+    }
+    return "Remote Library Provider (" + mirrors + ")";
+  }
+
+private:
+  std::vector<std::string> mirror_urls_;
+  std::string cache_scope_;
+  bool catalog_checked_ = false;
+  bool catalog_available_ = false;
+  std::unique_ptr<LibraryIndex> index_;
+  std::vector<std::string> available_libraries_;
+  std::unordered_map<std::string, ThirdPartyLibrary> library_cache_;
+
+  static std::string ensure_trailing_slash(const std::string &url) {
+    if (url.empty() || url.back() != '/') {
+      return url + '/';
+    }
+    return url;
+  }
+
+  // 从单个镜像获取文件并记录延迟；网络错误和服务器错误记为失败
+  static SafeCommandExecutor::FetchResponse
+  fetch_from(const std::string &mirror, const std::string &file,
+             const SafeCommandExecutor::Headers &headers) {
+    auto start = std::chrono::steady_clock::now();
+    SafeCommandExecutor::FetchResponse response;
+    try {
+      response = Utils::safe_fetch(mirror + file, headers);
+    } catch (const std::exception &e) {
+      std::cerr << "Failed to fetch " << mirror + file << ": " << e.what()
+                << std::endl;
+    }
+    if (good(response)) {
+      MirrorStats::record_latency(
+          mirror, std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
+    } else if ((response.status == 0 || response.status >= 500) &&
+               !SafeCommandExecutor::cancelled()) {
+      MirrorStats::record_failure(mirror);
+    }
+    return response;
+  }
+
+  static bool good(const SafeCommandExecutor::FetchResponse &response) {
+    return response.ok() || response.status == 304;
+  }
+
+  // 根据响应更新磁盘缓存，返回可用的内容
+  std::optional<std::string>
+  adopt(const std::string &file, std::optional<MetadataCache::Entry> &cached,
+        const SafeCommandExecutor::FetchResponse &response) const {
+    if (response.status == 304 && cached) {
+      MetadataCache::revalidated(cache_scope_, file, *cached);
+      return cached->body;
+    }
+    if (response.ok()) {
+      MetadataCache::Entry entry;
+      entry.body = response.body;
+      entry.etag = response.etag;
+      entry.last_modified = response.last_modified;
+      entry.fetched = MetadataCache::now();
+      MetadataCache::store(cache_scope_, file, entry);
+      return response.body;
+    }
+    return std::nullopt;
+  }
+
+  // 在所有镜像间竞速发送请求：第一个成功（或304）的响应胜出，其余请求被取消
+  std::optional<SafeCommandExecutor::FetchResponse>
+  fetch_raw(const std::string &file,
+            const SafeCommandExecutor::Headers &headers) const {
+    std::optional<SafeCommandExecutor::FetchResponse> winner;
+    auto mirrors = MirrorStats::rank_by_latency(mirror_urls_);
+#ifndef _WIN32
+    if (mirrors.size() > 1) {
+      struct Race {
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t finished = 0;
+      } race;
+      std::vector<std::shared_ptr<CancellationToken>> tokens;
+      std::vector<TaskScheduler::Future<void>> racers;
+      for (const auto &mirror : mirrors) {
+        auto token = std::make_shared<CancellationToken>();
+        tokens.push_back(token);
+        racers.push_back(TaskScheduler::instance().submit_blocking(
+            [&race, &winner, token, mirror, &file, &headers] {
+          CancellationToken::Scope scope(token);
+          auto response = fetch_from(mirror, file, headers);
+          std::lock_guard<std::mutex> lock(race.mtx);
+          if (good(response) && !winner) {
+            winner = std::move(response);
+          }
+          race.finished++;
+          race.cv.notify_all();
+        }));
+      }
+      {
+        std::unique_lock<std::mutex> lock(race.mtx);
+        race.cv.wait(lock, [&] {
+          return winner || race.finished == racers.size();
+        });
+      }
+      for (auto &token : tokens) {
+        token->cancel();
+      }
+      for (auto &racer : racers) {
+        racer.wait();
+      }
+      return winner;
+    }
+#endif
+    // 按延迟顺序依次尝试
+    for (const auto &mirror : mirrors) {
+      auto response = fetch_from(mirror, file, headers);
+      if (good(response)) {
+        return response;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // 获取元数据：未过期的磁盘缓存直接使用；否则竞速发送（条件）请求，
+  // 全部失败时退回过期的缓存
+  std::optional<std::string> fetch(const std::string &file) const {
+    auto cached = MetadataCache::load(cache_scope_, file);
+    if (cached && (cached->fresh() || MetadataCache::offline())) {
+      return cached->body;
+    }
+    if (MetadataCache::offline()) {
+      std::cerr << "Offline mode: no cached copy of " << file << std::endl;
+      return std::nullopt;
+    }
+
+    auto winner = fetch_raw(file, cached ? cached->conditional_headers()
+                                         : SafeCommandExecutor::Headers());
+    if (winner) {
+      if (auto body = adopt(file, cached, *winner)) {
+        return body;
+      }
+    }
+    if (cached) {
+      std::cerr << "Using stale cached " << file << std::endl;
+      return cached->body;
+    }
+    return std::nullopt;
+  }
+
+  // 载入合并目录catalog.json（优先catalog.json.gz；有缓存时先尝试
+  // catalog-delta-<缓存版本>.json增量）。镜像不提供目录时返回false，
+  // 并缓存这一结论，避免每次运行都探测
+  bool ensure_catalog() {
+    if (catalog_checked_) {
+      return catalog_available_;
+    }
+    catalog_checked_ = true;
+    const std::string file = "catalog.json";
+    // 目录未过期且已编译的索引与之对应时，无需读取和解析目录
+    auto cached = MetadataCache::load(cache_scope_, file, false);
+    if (cached && (cached->fresh() || MetadataCache::offline())) {
+      index_ = LibraryIndex::open(index_path(), cached->fetched);
+      if (index_) {
+        return catalog_available_ = true;
+      }
+      cached = MetadataCache::load(cache_scope_, file);
+      return catalog_available_ =
+                 cached && adopt_catalog(cached->body, cached->fetched);
+    }
+    if (MetadataCache::offline()) {
+      return false;
+    }
+    cached = MetadataCache::load(cache_scope_, file);
+
+    MetadataCache::Entry entry;
+    entry.fetched = MetadataCache::now();
+    if (cached && !cached->body.empty()) {
+      if (auto merged = fetch_catalog_delta(cached->body)) {
+        entry.body = std::move(*merged);
+        MetadataCache::store(cache_scope_, file, entry);
+        return catalog_available_ = adopt_catalog(entry.body, entry.fetched);
+      }
+    }
+
+    auto headers = cached && !cached->body.empty()
+                       ? cached->conditional_headers()
+                       : SafeCommandExecutor::Headers();
+    auto response = fetch_raw(file + ".gz", headers);
+    if (response && response->status == 304) {
+      MetadataCache::revalidated(cache_scope_, file, *cached);
+      return catalog_available_ = adopt_catalog(cached->body, cached->fetched);
+    }
+    std::optional<std::string> body;
+    if (response && response->ok()) {
+      body = Inflater::gunzip(response->body);
+      if (!body) {
+        std::cerr << "Ignoring corrupt " << file << ".gz" << std::endl;
+      }
+    }
+    if (!body) {
+      response = fetch_raw(file, {});
+      if (response && response->ok()) {
+        body = std::move(response->body);
+      }
+    }
+
+    if (body) {
+      entry.body = std::move(*body);
+      entry.etag = response->etag;
+      entry.last_modified = response->last_modified;
+      if (!adopt_catalog(entry.body, entry.fetched)) {
+        std::cerr << "Ignoring malformed " << file << std::endl;
+        return false;
+      }
+      MetadataCache::store(cache_scope_, file, entry);
+      return catalog_available_ = true;
+    }
+    if (cached && !cached->body.empty()) {
+      std::cerr << "Using stale cached " << file << std::endl;
+      return catalog_available_ = adopt_catalog(cached->body, cached->fetched);
+    }
+    // 空内容表示镜像不提供合并目录
+    MetadataCache::store(cache_scope_, file, entry);
+    return false;
+  }
+
+  // 获取增量目录并与缓存的目录合并；增量不存在或不匹配时返回nullopt
+  std::optional<std::string> fetch_catalog_delta(const std::string &base_text) {
+    auto base = JsonDocument::parse(base_text);
+    if (!base) {
+      return std::nullopt;
+    }
+    double version = base->root()["version"].as_number(-1);
+    if (version < 0) {
+      return std::nullopt;
+    }
+    auto response = fetch_raw(
+        "catalog-delta-" + std::to_string(static_cast<int64_t>(version)) +
+            ".json",
+        {});
+    if (!response || !response->ok()) {
+      return std::nullopt;
+    }
+    auto delta = JsonDocument::parse(std::move(response->body));
+    if (!delta || delta->root()["base"].as_number(-1) != version) {
+      return std::nullopt;
+    }
+
+    // 库条目按原始JSON文本合并，不重新序列化
+    std::map<std::string, std::string_view> libraries;
+    base->root()["libraries"].for_each_member(
+        [&](std::string_view name, JsonValue value) {
+          libraries[std::string(name)] = value.raw();
+        });
+    delta->root()["libraries"].for_each_member(
+        [&](std::string_view name, JsonValue value) {
+          libraries[std::string(name)] = value.raw();
+        });
+    delta->root()["removed"].for_each_element([&](JsonValue name) {
+      libraries.erase(std::string(name.as_string()));
+    });
+
+    std::string merged =
+        "{\"version\":" +
+        std::to_string(static_cast<int64_t>(
+            delta->root()["version"].as_number(version))) +
+        ",\"libraries\":{";
+    bool first = true;
+    for (const auto &library : libraries) {
+      merged += (first ? "\n" : ",\n") + JsonDocument::quote(library.first) +
+                ":" + std::string(library.second);
+      first = false;
+    }
+    merged += "\n}}\n";
+    std::cout << "Applied catalog delta " << static_cast<int64_t>(version)
+              << " -> "
+              << static_cast<int64_t>(
+                     delta->root()["version"].as_number(version))
+              << "\n";
+    return merged;
+  }
+
+  // 载入目录：编译为索引文件并映射；索引不可写时退回内存表。
+  // stamp为目录的获取时间，目录更新后旧索引自动失效
+  bool adopt_catalog(const std::string &text, int64_t stamp) {
+    if (text.empty()) {
+      return false;
+    }
+    auto doc = JsonDocument::parse(text);
+    if (!doc || !doc->root()["libraries"].is_object()) {
+      return false;
+    }
+    std::map<std::string, ThirdPartyLibrary> libraries;
+    doc->root()["libraries"].for_each_member(
+        [&](std::string_view name, JsonValue value) {
+          ThirdPartyLibrary lib_info = library_from_json(value);
+          lib_info.name = std::string(name);
+          libraries[lib_info.name] = std::move(lib_info);
+        });
+
+    library_cache_.clear();
+    available_libraries_.clear();
+    if (Utils::safe_create_directory(index_path().parent_path()) &&
+        LibraryIndex::compile(libraries, static_cast<uint64_t>(stamp),
+                              index_path())) {
+      index_ = LibraryIndex::open(index_path(), static_cast<uint64_t>(stamp));
+      if (index_) {
+        return true;
+      }
+    }
+    for (auto &library : libraries) {
+      available_libraries_.push_back(library.first);
+      library_cache_[library.first] = std::move(library.second);
+    }
+    return true;
+  }
+
+  fs::path index_path() const {
+    return MetadataCache::entry_path(cache_scope_, "catalog.idx");
+  }
+
+  // 库信息条目：列表字段接受数组或（旧格式的）逗号分隔字符串
+  static ThirdPartyLibrary library_from_json(JsonValue value) {
+    auto text = [&](std::string_view key) {
+      return std::string(value[key].as_string());
+    };
+    auto list = [&](std::string_view key) {
+      std::vector<std::string> items;
+      JsonValue field = value[key];
+      if (field.is_array()) {
+        field.for_each_element([&](JsonValue item) {
+          if (!item.as_string().empty()) {
+            items.emplace_back(item.as_string());
+          }
+        });
+      } else {
+        std::istringstream stream{std::string(field.as_string())};
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+          item = Utils::trim(item);
+          if (!item.empty()) {
+            items.push_back(item);
+          }
+        }
+      }
+      return items;
+    };
+
+    ThirdPartyLibrary lib_info;
+    lib_info.name = text("name");
+    lib_info.downloadUrl = text("downloadUrl");
+    lib_info.includePath = text("includePath");
+    lib_info.libPath = text("libPath");
+    lib_info.configInstructions = text("configInstructions");
+    lib_info.sha256 = text("sha256");
+    lib_info.dependencies = list("dependencies");
+    lib_info.extractInclude = list("extractInclude");
+    lib_info.extractExclude = list("extractExclude");
+    lib_info.mirrorUrls = list("mirrorUrls");
+    lib_info.description = text("description");
+    lib_info.tags = list("tags");
+    lib_info.primaryHeaders = list("primaryHeaders");
+    return lib_info;
+  }
+
+  // 解析单个库信息JSON
+  static ThirdPartyLibrary parse_library_info(const std::string &json_content) {
+    std::string error;
+    auto doc = JsonDocument::parse(json_content, &error);
+    if (!doc) {
+      std::cerr << "JSON parse error: " << error << std::endl;
+      return {};
+    }
+    return library_from_json(doc->root());
+  }
+};
+
+// 编译器服务类
+class CompilerService {
+public:
+  // 获取编译器配置
+  static CompilerConfig get_compiler_config() {
+    CompilerConfig config;
+
+    std::cout << "\n=== Compiler Configuration ===\n";
+
+    // 选择编译器类型
+    std::cout << "Select compiler type:\n";
+    std::cout << "1. gcc\n";
+    std::cout << "2. g++\n";
+    std::cout << "3. clang\n";
+    std::cout << "4. clang++\n";
+    std::cout << "5. MSVC (Visual Studio)\n";
+    std::cout << "Enter choice (1-5, default 1): ";
+
+    std::string choice;
+    std::getline(std::cin, choice);
+
+    if (choice == "2") {
+      config.type = CompilerType::GXX;
+      config.name = "g++";
+    } else if (choice == "3") {
+      config.type = CompilerType::CLANG;
+      config.name = "clang";
+    } else if (choice == "4") {
+      config.type = CompilerType::CLANGXX;
+      config.name = "clang++";
+    } else if (choice == "5") {
+      config.type = CompilerType::MSVC;
+      config.name = "cl";
+    } else {
+      config.type = CompilerType::GXX;
+      config.name = "g++";
+    }
+
+    // 获取编译器路径
+    config.path = find_compiler_path(config);
+
+    // 选择C++标准
+    config.cppStandard = select_cpp_standard(config);
+
+    // 选择C标准
+    config.cStandard = select_c_standard(config);
+
+    // 添加额外编译选项
+    std::cout << "Enter any additional compiler flags (space separated, or "
+                 "press Enter for none): ";
+    std::string extra_flags;
+    std::getline(std::cin, extra_flags);
+
+    if (!extra_flags.empty()) {
+      std::istringstream iss(extra_flags);
+      std::string flag;
+      while (iss >> flag) {
+        config.extraArgs.push_back(flag);
+      }
+    }
+
+    return config;
+  }
+
+  // 不询问用户，返回找到的第一个编译器路径（未找到时为空）
+  static std::string locate_compiler(const CompilerConfig &config) {
+    auto paths = config.type == CompilerType::MSVC
+                     ? find_msvc_paths()
+                     : find_compiler_in_path(config.name);
+    return paths.empty() ? std::string() : paths.front();
+  }
+
+  // 在PATH中查找编译器缓存：auto依次尝试ccache和sccache，none不查找。
+  // 找到时name为工具名、path为其路径；auto未找到时保持auto，
+  // 生成的CMake工程在配置时再查找
+  static void detect_compiler_cache(CompilerCacheConfig &cache) {
+    if (cache.name == "none") {
+      return;
+    }
+    const std::vector<std::string> candidates =
+        cache.name == "auto" ? std::vector<std::string>{"ccache", "sccache"}
+                             : std::vector<std::string>{cache.name};
+    for (const auto &candidate : candidates) {
+      auto paths = find_compiler_in_path(candidate);
+      if (!paths.empty()) {
+        cache.name = candidate;
+        cache.path = paths.front();
+        return;
+      }
+    }
+  }
+
+  // 在PATH中查找CMake和Ninja
+  static void detect_build_tools(BuildToolConfig &tools) {
+    auto locate = [](std::initializer_list<const char *> names) {
+      for (const char *name : names) {
+        auto paths = find_compiler_in_path(name);
+        if (!paths.empty()) {
+          return paths.front();
+        }
+      }
+      return std::string();
+    };
+    tools.cmake = locate({"cmake"});
+    tools.ninja = locate({"ninja", "ninja-build"});
+  }
+
+  // 缓存大小：数字加可选的K/M/G/T后缀
+  static bool valid_cache_size(const std::string &size) {
+    static const std::regex pattern(R"(\d+(\.\d+)?([KMGT]i?)?)",
+                                    std::regex::icase);
+    return std::regex_match(size, pattern);
+  }
+
+private:
+  // 查找编译器路径
+  static std::string find_compiler_path(CompilerConfig &config) {
+    std::vector<std::string> compiler_paths;
+
+    if (config.type == CompilerType::MSVC) {
+      compiler_paths = find_msvc_paths();
+    } else {
+      compiler_paths = find_compiler_in_path(config.name);
+    }
+
+    // 处理找到的编译器路径
+    if (compiler_paths.empty()) {
+      std::cout << "No " << config.name << " compiler found.\n";
+      std::cout << "Enter " << config.name << " compiler path: ";
+      std::string path;
+      std::getline(std::cin, path);
+      return Utils::clean_path(path);
+      if (path.find_first_of(";&|<>`$()") != std::string::npos) {
+        throw std::invalid_argument("Invalid characters in compiler path");
+      }
+      return Utils::clean_path(path);
+    }
+
+    if (compiler_paths.size() == 1) {
+      std::cout << "Using " << config.name
+                << " compiler found at: " << compiler_paths[0] << "\n";
+      return compiler_paths[0];
+    }
+
+    std::cout << "Multiple " << config.name << " compilers found:\n";
+    for (size_t i = 0; i < compiler_paths.size(); ++i) {
+      std::cout << "  " << i + 1 << ". " << compiler_paths[i] << "\n";
+    }
+    std::cout << "Select compiler (1-" << compiler_paths.size() << "): ";
+    std::string selection;
+    std::getline(std::cin, selection);
+
+    try {
+      size_t idx = std::stoi(selection) - 1;
+      if (idx < compiler_paths.size()) {
+        return compiler_paths[idx];
+      }
+    } catch (...) {
+      // 无效选择，使用第一个
+    }
+
+    return compiler_paths[0];
+  }
+
+  // 在PATH环境变量中查找编译器
+  static std::vector<std::string>
+  find_compiler_in_path(const std::string &executable_name) {
+    std::vector<std::string> found_paths;
+
+    // 获取PATH环境变量
+    const char *path_env = std::getenv("PATH");
+    if (!path_env) {
+      return found_paths;
+    }
+
+    std::string path_str(path_env);
+
+    // 分割PATH字符串
+#ifdef _WIN32
+    const char delimiter = ';';
+    std::string exe_name = executable_name + ".exe";
+#else
+    const char delimiter = ':';
+    std::string exe_name = executable_name;
+#endif
+
+    std::istringstream path_stream(path_str);
+    std::string directory;
+
+    while (std::getline(path_stream, directory, delimiter)) {
+      fs::path dir_path(directory);
+      if (fs::exists(dir_path) && fs::is_directory(dir_path)) {
+        fs::path executable_path = dir_path / exe_name;
+        if (fs::exists(executable_path) &&
+            fs::is_regular_file(executable_path)) {
+          found_paths.push_back(Utils::clean_path(executable_path.string()));
+        }
+      }
+    }
+
+    return found_paths;
+  }
+
+  // 查找MSVC路径
+  static std::vector<std::string> find_msvc_paths() {
+    std::vector<std::string> paths;
+
+#ifdef _WIN32
+    // 常见的Visual Studio安装路径
+    std::vector<std::string> common_paths = {
+        "C:/Program Files/Microsoft Visual Studio/2022/Community/VC/Tools/MSVC",
+        "C:/Program Files/Microsoft Visual "
+        "Studio/2022/Professional/VC/Tools/MSVC",
+        "C:/Program Files/Microsoft Visual "
+        "Studio/2022/Enterprise/VC/Tools/MSVC",
+        "C:/Program Files (x86)/Microsoft Visual "
+        "Studio/2019/Community/VC/Tools/MSVC",
+        "C:/Program Files (x86)/Microsoft Visual "
+        "Studio/2019/Professional/VC/Tools/MSVC",
+        "C:/Program Files (x86)/Microsoft Visual "
+        "Studio/2019/Enterprise/VC/Tools/MSVC"};
+
+    for (const auto &base_path : common_paths) {
+      if (fs::exists(base_path)) {
+        for (const auto &entry : fs::directory_iterator(base_path)) {
+          if (entry.is_directory()) {
+            fs::path compiler_path = entry.path() / "bin/Hostx64/x64/cl.exe";
+            if (fs::exists(compiler_path)) {
+              paths.push_back(Utils::clean_path(compiler_path.string()));
+            }
+          }
         }
       }
     }
@@ -1256,6 +7764,14 @@ public:
     return config;
   }
 
+  // 不询问用户，返回找到的第一个调试器路径（未找到时为空）
+  static std::string locate_debugger(const DebuggerConfig &config) {
+    auto paths = config.type == DebuggerType::CPPVSDBG
+                     ? find_vs_debugger_paths()
+                     : find_debugger_in_path(config.name);
+    return paths.empty() ? std::string() : paths.front();
+  }
+
 private:
   // 查找调试器路径
   static std::string find_debugger_path(DebuggerConfig &config) {
@@ -1379,7 +7895,29 @@ private:
 class ProjectStructureService {
 public:
   // 生成项目结构定义
-  static DirectoryNode get_project_structure(const std::string &project_name) {
+  static DirectoryNode
+  get_project_structure(const std::string &project_name,
+                        const WorkspaceConfig &workspace = {}) {
+    // 每个构建配置（见cmake/BuildProfiles.cmake）输出到build/bin下单独的目录
+    const std::vector<DirectoryNode> profile_dirs = {
+        {"Debug", {}},  {"Release", {}},       {"RelWithDebInfo", {}},
+        {"Native", {}}, {"PgoInstrument", {}}, {"Pgo", {}}};
+    if (workspace.enabled) {
+      std::vector<DirectoryNode> apps;
+      for (const auto &app : workspace_apps(project_name, workspace)) {
+        apps.push_back({app, {}});
+      }
+      return {project_name,
+              {{".vscode", {}},
+               {"core", {{"include", {{project_name, {}}}}, {"src", {}}}},
+               {"apps", apps},
+               {"tests", {}},
+               {"bench", {}},
+               {"cmake", {}},
+               {"build", {{"bin", profile_dirs}}},
+               {"third_party", {}},
+               {"docs", {}}}};
+    }
     return {
         project_name,
         {{".vscode", {}},
@@ -1387,10 +7925,52 @@ public:
          {"lib", {}},
          {"lib64", {}},
          {"src", {}},
-         {"build", {{"bin", {{"Debug", {}}, {"Release", {}}}}, {"obj", {}}}},
+         {"cmake", {}},
+         {"build", {{"bin", profile_dirs}, {"obj", {}}}},
          {"third_party", {}},
          {"docs", {}}}};
   }
+
+  // 检查工作区程序名并去重：不能与生成的其他目标或CMake保留的目标重名
+  static std::vector<std::string>
+  check_apps(const std::string &project_name,
+             const std::vector<std::string> &apps) {
+    const std::set<std::string> reserved = {
+        project_name + "_core",  project_name + "_objects",
+        project_name + "_tests", project_name + "_bench",
+        "all",                   "clean",
+        "help",                  "install",
+        "test",                  "package",
+        "package_source",        "edit_cache",
+        "rebuild_cache"};
+    std::vector<std::string> unique;
+    for (const auto &app : apps) {
+      if (app.empty()) {
+        throw std::invalid_argument("Empty application name");
+      }
+      if (reserved.count(app)) {
+        throw std::invalid_argument("Application name \"" + app +
+                                    "\" conflicts with a generated target");
+      }
+      if (std::find(unique.begin(), unique.end(), app) != unique.end()) {
+        std::cerr << "Ignoring duplicate application " << app << std::endl;
+        continue;
+      }
+      unique.push_back(app);
+    }
+    return unique;
+  }
+
+  // 工作区中的可执行程序；未指定时为一个与项目同名的程序
+  static std::vector<std::string>
+  workspace_apps(const std::string &project_name,
+                 const WorkspaceConfig &workspace) {
+    if (workspace.apps.empty()) {
+      return {project_name};
+    }
+    return workspace.apps;
+  }
+
   // 设置是否使用Unicode符号
   static bool use_unicode_symbols;
 
@@ -1449,79 +8029,671 @@ public:
       const std::string fail_mark = " [FAIL]";
       const std::string exist_mark = " [EXIST]";
 
-      return create_directory_recursive_impl(
-          base_path, node, depth, prefix, vertical_line, branch, last_branch,
-          space_fill, success_mark, fail_mark, exist_mark);
+      return create_directory_recursive_impl(
+          base_path, node, depth, prefix, vertical_line, branch, last_branch,
+          space_fill, success_mark, fail_mark, exist_mark);
+    }
+  }
+#endif
+
+private:
+  // 统一的实现函数
+  static bool create_directory_recursive_impl(
+      const fs::path &base_path, const DirectoryNode &node, int depth,
+      const std::string &prefix, const std::string &vertical_line,
+      const std::string &branch, const std::string &last_branch,
+      const std::string &space_fill, const std::string &success_mark,
+      const std::string &fail_mark, const std::string &exist_mark) {
+
+    const fs::path current_path = Utils::join_paths(base_path, node.name);
+    std::string tree_prefix;
+
+    if (depth > 0) {
+      tree_prefix = prefix + (depth > 1 ? vertical_line + "   " : "") +
+                    (depth > 0 ? branch : "");
+    }
+
+    std::cout << tree_prefix << node.name;
+
+    try {
+      if (!fs::exists(current_path)) {
+        if (Utils::safe_create_directory(current_path)) {
+          std::cout << success_mark << "\n";
+        } else {
+          std::cout << fail_mark << "\n";
+          return false;
+        }
+      } else {
+        std::cout << exist_mark << "\n";
+      }
+
+      std::string child_prefix =
+          prefix + (depth > 0 ? vertical_line + "   " : "");
+      for (size_t i = 0; i < node.children.size(); i++) {
+        const auto &child = node.children[i];
+        bool is_last = (i == node.children.size() - 1);
+
+        std::string new_prefix = is_last ? space_fill : vertical_line + "   ";
+        std::string new_branch = is_last ? last_branch : branch;
+
+        if (!create_directory_recursive_impl(
+                current_path, child, depth + 1, child_prefix + new_branch,
+                vertical_line, branch, last_branch, space_fill, success_mark,
+                fail_mark, exist_mark)) {
+          return false;
+        }
+      }
+
+      return true;
+    } catch (const fs::filesystem_error &e) {
+      std::cout << " [ERROR] " << e.what() << "\n";
+      return false;
+    }
+  }
+};
+
+// 初始化静态成员变量
+#ifdef _WIN32
+bool ProjectStructureService::use_unicode_symbols = false;
+#else
+bool ProjectStructureService::use_unicode_symbols = true;
+#endif
+// 计数信号量（限制并发任务数，上限可在运行时调整）
+class CountingSemaphore {
+public:
+  explicit CountingSemaphore(unsigned limit) : limit_(limit) {}
+
+  void acquire() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return in_use_ < limit_; });
+    in_use_++;
+  }
+
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      in_use_--;
+    }
+    cv_.notify_one();
+  }
+
+  void set_limit(unsigned limit) {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      limit_ = std::max(1u, limit);
+    }
+    cv_.notify_all();
+  }
+
+private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  unsigned limit_;
+  unsigned in_use_ = 0;
+};
+
+// RAII方式占用一个信号量名额
+class SlotGuard {
+public:
+  explicit SlotGuard(CountingSemaphore &sem) : sem_(sem) { sem_.acquire(); }
+  ~SlotGuard() { sem_.release(); }
+
+  SlotGuard(const SlotGuard &) = delete;
+  SlotGuard &operator=(const SlotGuard &) = delete;
+
+private:
+  CountingSemaphore &sem_;
+};
+
+// 共享的已解压库存储：每个(库, 摘要)只解压一次，再链接进各项目
+class ExtractedStore {
+public:
+  enum class LinkMode { NONE, AUTO, REFLINK, HARDLINK, SYMLINK, COPY };
+
+  static void set_link_mode(LinkMode mode) { mode_ = mode; }
+
+  static bool enabled() { return mode_ != LinkMode::NONE; }
+
+  static std::optional<LinkMode> parse_link_mode(const std::string &name) {
+    static const std::unordered_map<std::string, LinkMode> modes = {
+        {"none", LinkMode::NONE},         {"auto", LinkMode::AUTO},
+        {"reflink", LinkMode::REFLINK},   {"hardlink", LinkMode::HARDLINK},
+        {"symlink", LinkMode::SYMLINK},   {"copy", LinkMode::COPY}};
+    auto it = modes.find(name);
+    if (it == modes.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  // 确保压缩包已解压到共享存储，返回只读的存储目录
+  static std::optional<fs::path>
+  ensure(const std::string &lib_name, const std::string &digest,
+         const fs::path &archive, const ZipExtractor::Filter &filter = {}) {
+    const fs::path dir =
+        store_dir(lib_name, filter.empty()
+                                ? digest
+                                : digest + "-sel-" + filter.signature());
+    std::error_code ec;
+    if (fs::exists(dir / kCompleteMarker, ec)) {
+      // 标记文件的修改时间即最近使用时间（用于LRU）
+      fs::last_write_time(dir / kCompleteMarker,
+                          fs::file_time_type::clock::now(), ec);
+      return dir;
+    }
+
+    // 先解压到临时目录，完成后整体rename，其他进程只会看到完整的存储
+    static std::atomic<unsigned> counter{0};
+    const fs::path temp = dir.string() + ".tmp." + std::to_string(getpid()) +
+                          "." + std::to_string(counter++);
+    if (!Utils::safe_create_directory(temp) ||
+        !Utils::safe_unzip_file(archive, temp, filter)) {
+      fs::remove_all(temp, ec);
+      return std::nullopt;
+    }
+    make_read_only(temp);
+    // 标记文件记录解压后的大小，淘汰时不必遍历整个目录
+    std::ofstream(temp / kCompleteMarker) << tree_size(temp) << '\n';
+
+    fs::rename(temp, dir, ec);
+    if (ec) {
+      remove_store(temp);
+      if (!fs::exists(dir / kCompleteMarker, ec)) {
+        return std::nullopt;
+      }
+    }
+    evict(dir);
+    return dir;
+  }
+
+  // 存储总大小超出上限（与--cache-max-size相同，和压缩包分别计算）时
+  // 按最近使用时间淘汰。项目以符号链接引用的目录、keep以及最近一小时内
+  // 用过的目录不淘汰，避免删除其他进程正在链接的内容
+  static void evict(const fs::path &keep = {}) {
+    const fs::path root = ArchiveCache::cache_root() / "extracted";
+#ifndef _WIN32
+    int lock_fd = ::open((root / ".lock").c_str(),
+                         O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd < 0) {
+      return;
+    }
+    if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+      ::close(lock_fd);
+      return;
+    }
+#endif
+    struct StoredDir {
+      fs::path path;
+      uint64_t size;
+      fs::file_time_type used;
+    };
+    std::vector<StoredDir> candidates;
+    uint64_t total = 0;
+    std::error_code ec;
+    const auto now = fs::file_time_type::clock::now();
+    for (const auto &entry : fs::directory_iterator(root, ec)) {
+      if (!entry.is_directory(ec)) {
+        continue;
+      }
+      const fs::path marker = entry.path() / kCompleteMarker;
+      if (!fs::exists(marker, ec)) {
+        // 一周未完成的解压残留
+        if (entry.path().filename().string().find(".tmp.") !=
+                std::string::npos &&
+            entry.last_write_time(ec) < now - std::chrono::hours(24 * 7)) {
+          remove_store(entry.path());
+        }
+        continue;
+      }
+      uint64_t size = 0;
+      std::ifstream(marker) >> size;
+      if (size == 0) {
+        // 旧版本的标记文件不含大小：计算一次并记录
+        size = tree_size(entry.path());
+        std::ofstream(marker) << size << '\n';
+      }
+      total += size;
+      const auto used = fs::last_write_time(marker, ec);
+      if (entry.path() != keep && used < now - std::chrono::hours(1) &&
+          !fs::exists(entry.path() / kPinnedMarker, ec)) {
+        candidates.push_back({entry.path(), size, used});
+      }
+    }
+
+    if (total > ArchiveCache::max_bytes()) {
+      std::sort(candidates.begin(), candidates.end(),
+                [](const StoredDir &a, const StoredDir &b) {
+                  return a.used < b.used;
+                });
+      for (const auto &dir : candidates) {
+        if (total <= ArchiveCache::max_bytes()) {
+          break;
+        }
+        if (remove_store(dir.path)) {
+          total -= dir.size;
+        }
+      }
+    }
+#ifndef _WIN32
+    flock(lock_fd, LOCK_UN);
+    ::close(lock_fd);
+#endif
+  }
+
+  // 将存储目录的内容链接到项目的third_party目录
+  static bool populate(const fs::path &store, const fs::path &target_dir) {
+    Stats stats;
+    LinkMode mode = mode_;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(store, ec)) {
+      if (entry.path().filename() == kCompleteMarker ||
+          entry.path().filename() == kPinnedMarker) {
+        continue;
+      }
+      const fs::path dest = target_dir / entry.path().filename();
+      if (mode == LinkMode::SYMLINK || mode == LinkMode::AUTO) {
+        if (fs::is_symlink(dest, ec)) {
+          fs::remove(dest, ec);
+        }
+        if (mode == LinkMode::SYMLINK && !fs::exists(dest, ec)) {
+          if (entry.is_directory(ec)) {
+            fs::create_directory_symlink(entry.path(), dest, ec);
+          } else {
+            fs::create_symlink(entry.path(), dest, ec);
+          }
+          if (!ec) {
+            stats.symlinked++;
+            continue;
+          }
+        }
+      }
+      if (!link_tree(entry.path(), dest, mode, stats)) {
+        return false;
+      }
+    }
+    if (stats.symlinked > 0) {
+      // 项目直接指向存储目录，淘汰会破坏项目
+      std::ofstream(store / kPinnedMarker).put('\n');
+    }
+
+    std::cout << "Linked from shared store: " << stats.reflinked
+              << " reflinked, " << stats.hardlinked << " hardlinked, "
+              << stats.symlinked << " symlinked, " << stats.copied
+              << " copied\n";
+    return true;
+  }
+
+private:
+  static constexpr const char *kCompleteMarker = ".sln2code-complete";
+  static constexpr const char *kPinnedMarker = ".sln2code-pinned";
+  static LinkMode mode_;
+
+  struct Stats {
+    size_t reflinked = 0;
+    size_t hardlinked = 0;
+    size_t symlinked = 0;
+    size_t copied = 0;
+    bool reflink_failed = false;
+    bool hardlink_failed = false;
+  };
+
+  static fs::path store_dir(const std::string &lib_name,
+                            const std::string &key) {
+    return ArchiveCache::cache_root() / "extracted" /
+           (Utils::get_valid_name(lib_name) + "-" + key);
+  }
+
+  static uint64_t tree_size(const fs::path &dir) {
+    uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(dir, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (it->is_regular_file(ec) && !it->is_symlink(ec)) {
+        total += it->file_size(ec);
+      }
+    }
+    return total;
+  }
+
+  // 删除存储目录；只读文件在Windows上须先恢复写权限
+  static bool remove_store(const fs::path &dir) {
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    if (ec) {
+      for (auto it = fs::recursive_directory_iterator(dir, ec);
+           !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        fs::permissions(it->path(), fs::perms::owner_write,
+                        fs::perm_options::add | fs::perm_options::nofollow,
+                        ec);
+      }
+      ec.clear();
+      fs::remove_all(dir, ec);
+    }
+    return !ec;
+  }
+
+  // 去掉写权限，避免通过硬链接修改共享内容
+  static void make_read_only(const fs::path &dir) {
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(dir, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (it->is_regular_file(ec) && !it->is_symlink(ec)) {
+        fs::permissions(it->path(),
+                        fs::perms::owner_write | fs::perms::group_write |
+                            fs::perms::others_write,
+                        fs::perm_options::remove, ec);
+      }
+    }
+  }
+
+  static bool reflink_file(const fs::path &from, const fs::path &to) {
+#ifdef __linux__
+    int src = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src < 0) {
+      return false;
+    }
+    struct stat st;
+    fstat(src, &st);
+    int dst = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                     st.st_mode & 0777);
+    if (dst < 0) {
+      ::close(src);
+      return false;
+    }
+    bool ok = ioctl(dst, FICLONE, src) == 0;
+    ::close(src);
+    ::close(dst);
+    if (!ok) {
+      std::error_code ec;
+      fs::remove(to, ec);
+    }
+    return ok;
+#else
+    (void)from;
+    (void)to;
+    return false;
+#endif
+  }
+
+  // 逐个文件按 reflink -> 硬链接 -> 复制 的顺序回退
+  static bool link_file(const fs::path &from, const fs::path &to,
+                        LinkMode mode, Stats &stats) {
+    std::error_code ec;
+    if (fs::exists(fs::symlink_status(to, ec))) {
+      fs::remove(to, ec);
+    }
+    bool try_reflink = mode == LinkMode::REFLINK ||
+                       (mode == LinkMode::AUTO && !stats.reflink_failed);
+    bool try_hardlink = mode == LinkMode::HARDLINK ||
+                        ((mode == LinkMode::AUTO ||
+                          mode == LinkMode::REFLINK ||
+                          mode == LinkMode::SYMLINK) &&
+                         !stats.hardlink_failed);
+
+    if (try_reflink) {
+      if (reflink_file(from, to)) {
+        stats.reflinked++;
+        return true;
+      }
+      stats.reflink_failed = true;
+    }
+    if (try_hardlink) {
+      fs::create_hard_link(from, to, ec);
+      if (!ec) {
+        stats.hardlinked++;
+        return true;
+      }
+      stats.hardlink_failed = true;
+    }
+    fs::copy_file(from, to, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+      std::cerr << "Failed to copy " << from << ": " << ec.message() << "\n";
+      return false;
+    }
+    // 复制出的文件归项目所有，恢复写权限
+    fs::permissions(to, fs::perms::owner_write, fs::perm_options::add, ec);
+    stats.copied++;
+    return true;
+  }
+
+  static bool link_tree(const fs::path &from, const fs::path &to,
+                        LinkMode mode, Stats &stats) {
+    std::error_code ec;
+    if (fs::is_symlink(from, ec)) {
+      fs::remove(to, ec);
+      fs::copy_symlink(from, to, ec);
+      return !ec;
+    }
+    if (!fs::is_directory(from, ec)) {
+      return link_file(from, to, mode, stats);
+    }
+
+    fs::create_directories(to, ec);
+    for (auto it = fs::recursive_directory_iterator(from, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      const fs::path dest = to / fs::relative(it->path(), from);
+      if (it->is_symlink(ec)) {
+        fs::remove(dest, ec);
+        fs::copy_symlink(it->path(), dest, ec);
+      } else if (it->is_directory(ec)) {
+        fs::create_directories(dest, ec);
+      } else if (!link_file(it->path(), dest, mode, stats)) {
+        return false;
+      }
+      ec.clear();
+    }
+    return true;
+  }
+};
+
+ExtractedStore::LinkMode ExtractedStore::mode_ = ExtractedStore::LinkMode::NONE;
+
+// 库目录搜索：名称、标签和简介的三元组倒排索引，提供排序的模糊搜索与前缀补全
+class LibraryCatalog {
+public:
+  explicit LibraryCatalog(std::vector<ThirdPartyLibrary> entries)
+  {
+    std::vector<std::pair<std::string, uint32_t>> order;
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+      order.emplace_back(fold(entries[i].name), i);
+    }
+    std::sort(order.begin(), order.end());
+    entries_.reserve(order.size());
+    folded_.reserve(order.size());
+    for (auto &item : order) {
+      entries_.push_back(std::move(entries[item.second]));
+      folded_.push_back(std::move(item.first));
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> grams;
+    for (uint32_t doc = 0; doc < entries_.size(); ++doc) {
+      const ThirdPartyLibrary &lib = entries_[doc];
+      // 同一三元组只记录权重最高的字段
+      grams.clear();
+      add_trigrams(lib.name, kName, grams);
+      for (const auto &tag : lib.tags) {
+        add_trigrams(tag, kTag, grams);
+      }
+      add_trigrams(lib.description, kDescription, grams);
+      std::sort(grams.begin(), grams.end());
+      for (size_t i = 0; i < grams.size(); ++i) {
+        if (i == 0 || grams[i].first != grams[i - 1].first) {
+          postings_.emplace_back(grams[i].first, doc << 2 | grams[i].second);
+        }
+      }
     }
+    std::sort(postings_.begin(), postings_.end());
   }
-#endif
-
-private:
-  // 统一的实现函数
-  static bool create_directory_recursive_impl(
-      const fs::path &base_path, const DirectoryNode &node, int depth,
-      const std::string &prefix, const std::string &vertical_line,
-      const std::string &branch, const std::string &last_branch,
-      const std::string &space_fill, const std::string &success_mark,
-      const std::string &fail_mark, const std::string &exist_mark) {
 
-    const fs::path current_path = Utils::join_paths(base_path, node.name);
-    std::string tree_prefix;
+  size_t size() const { return entries_.size(); }
+  const std::vector<ThirdPartyLibrary> &entries() const { return entries_; }
 
-    if (depth > 0) {
-      tree_prefix = prefix + (depth > 1 ? vertical_line + "   " : "") +
-                    (depth > 0 ? branch : "");
+  // 精确匹配库名（忽略大小写）
+  const ThirdPartyLibrary *find(const std::string &name) const {
+    std::string key = fold(name);
+    auto it = std::lower_bound(folded_.begin(), folded_.end(), key);
+    if (it == folded_.end() || *it != key) {
+      return nullptr;
     }
+    return &entries_[static_cast<size_t>(it - folded_.begin())];
+  }
 
-    std::cout << tree_prefix << node.name;
+  // 以prefix开头的库名，按名称排序
+  std::vector<const ThirdPartyLibrary *> complete(const std::string &prefix,
+                                                 size_t limit) const {
+    std::vector<const ThirdPartyLibrary *> result;
+    std::string key = fold(prefix);
+    if (key.empty()) {
+      return result;
+    }
+    for (auto it = std::lower_bound(folded_.begin(), folded_.end(), key);
+         it != folded_.end() && it->compare(0, key.size(), key) == 0 &&
+         result.size() < limit;
+         ++it) {
+      result.push_back(&entries_[static_cast<size_t>(it - folded_.begin())]);
+    }
+    return result;
+  }
 
-    try {
-      if (!fs::exists(current_path)) {
-        if (Utils::safe_create_directory(current_path)) {
-          std::cout << success_mark << "\n";
-        } else {
-          std::cout << fail_mark << "\n";
-          return false;
+  // 模糊搜索：按命中三元组的字段权重累加得分，名称完全匹配、前缀匹配和
+  // 子串匹配额外加分；容忍拼写错误
+  std::vector<const ThirdPartyLibrary *> search(const std::string &query,
+                                               size_t limit) const {
+    std::vector<std::pair<uint32_t, uint32_t>> grams;
+    add_trigrams(query, kName, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    std::vector<uint32_t> scores(entries_.size(), 0);
+    std::vector<uint32_t> touched;
+    for (const auto &gram : grams) {
+      auto it = std::lower_bound(postings_.begin(), postings_.end(),
+                                 std::make_pair(gram.first, 0u));
+      for (; it != postings_.end() && it->first == gram.first; ++it) {
+        uint32_t posting = it->second;
+        uint32_t doc = posting >> 2;
+        if (scores[doc] == 0) {
+          touched.push_back(doc);
         }
-      } else {
-        std::cout << exist_mark << "\n";
+        scores[doc] += kWeights[posting & 3];
       }
+    }
 
-      std::string child_prefix =
-          prefix + (depth > 0 ? vertical_line + "   " : "");
-      for (size_t i = 0; i < node.children.size(); i++) {
-        const auto &child = node.children[i];
-        bool is_last = (i == node.children.size() - 1);
+    const std::string key = fold(query);
+    std::vector<std::pair<uint32_t, uint32_t>> ranked;
+    for (uint32_t doc : touched) {
+      if (scores[doc] < kMinScore) {
+        continue;
+      }
+      uint32_t score = scores[doc];
+      size_t pos = folded_[doc].find(key);
+      if (folded_[doc] == key) {
+        score += 100;
+      } else if (pos == 0) {
+        score += 50;
+      } else if (pos != std::string::npos) {
+        score += 20;
+      }
+      ranked.emplace_back(score, doc);
+    }
+    size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                      [](const auto &a, const auto &b) {
+                        return a.first != b.first ? a.first > b.first
+                                                  : a.second < b.second;
+                      });
+    std::vector<const ThirdPartyLibrary *> result;
+    for (size_t i = 0; i < count; ++i) {
+      result.push_back(&entries_[ranked[i].second]);
+    }
+    return result;
+  }
 
-        std::string new_prefix = is_last ? space_fill : vertical_line + "   ";
-        std::string new_branch = is_last ? last_branch : branch;
+private:
+  enum Field : uint32_t { kName = 0, kTag = 1, kDescription = 2 };
+  static constexpr uint32_t kWeights[3] = {6, 3, 1};
+  // 至少命中一个名称三元组，或两个以上标签/简介三元组
+  static constexpr uint32_t kMinScore = 2;
+
+  std::vector<ThirdPartyLibrary> entries_; // 按小写名称排序
+  std::vector<std::string> folded_;
+  // (三元组, doc<<2|字段)，按三元组排序
+  std::vector<std::pair<uint32_t, uint32_t>> postings_;
+
+  static std::string fold(const std::string &text) {
+    std::string folded = Utils::trim(text);
+    std::transform(folded.begin(), folded.end(), folded.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return folded;
+  }
 
-        if (!create_directory_recursive_impl(
-                current_path, child, depth + 1, child_prefix + new_branch,
-                vertical_line, branch, last_branch, space_fill, success_mark,
-                fail_mark, exist_mark)) {
-          return false;
+  // 每个单词前后补空格后取三元组，短词和词首词尾也能匹配
+  static void add_trigrams(const std::string &text, uint32_t field,
+                           std::vector<std::pair<uint32_t, uint32_t>> &grams) {
+    std::string word = " ";
+    auto flush = [&] {
+      if (word.size() > 1) {
+        word += ' ';
+        for (size_t i = 0; i + 3 <= word.size(); ++i) {
+          uint32_t gram = static_cast<uint8_t>(word[i]) << 16 |
+                          static_cast<uint8_t>(word[i + 1]) << 8 |
+                          static_cast<uint8_t>(word[i + 2]);
+          grams.emplace_back(gram, field);
         }
       }
-
-      return true;
-    } catch (const fs::filesystem_error &e) {
-      std::cout << " [ERROR] " << e.what() << "\n";
-      return false;
+      word = " ";
+    };
+    for (unsigned char c : text) {
+      if (std::isalnum(c) || c >= 0x80 || c == '+') {
+        word += static_cast<char>(std::tolower(c));
+      } else {
+        flush();
+      }
     }
+    flush();
   }
 };
 
-// 初始化静态成员变量
-#ifdef _WIN32
-bool ProjectStructureService::use_unicode_symbols = false;
-#else
-bool ProjectStructureService::use_unicode_symbols = true;
-#endif
 // 库服务
 class LibraryService {
 private:
+  // 待解压的库压缩包；来自缓存的压缩包解压后保留
+  struct LibraryArchive {
+    fs::path path;
+    bool cached = false;
+  };
+
   static std::unique_ptr<ILibraryInfoProvider> provider_;
+  // 按项目目录记录已安装的库，以及安装完成的库的信息（用于预编译头）
+  static std::map<std::string, std::set<std::string>> installed_libs_;
+  static std::map<std::string, std::map<std::string, ThirdPartyLibrary>>
+      finished_libs_;
+  static std::mutex installed_mtx_;
+  // 进行中的压缩包获取（按摘要），批量生成时多个项目共享同一次下载
+  static std::map<std::string,
+                  TaskScheduler::Future<std::optional<LibraryArchive>>>
+      inflight_;
+  static std::mutex inflight_mtx_;
+  // 库信息提供者不是线程安全的，并发安装时串行访问
+  static std::mutex provider_mtx_;
+  static CountingSemaphore download_slots_;
+  static bool selective_extraction_;
+
+  // 对冲下载：宽限期后所有进行中的来源都低于该吞吐量则启动下一个来源
+  static constexpr std::chrono::seconds kHedgeGrace{3};
+  static constexpr double kHedgeFloor = 256 * 1024;
+
+  // 交互选择：目录不超过该数量时全部列出；搜索最多显示的候选数
+  static constexpr size_t kListAllLimit = 30;
+  static constexpr size_t kSuggestionLimit = 10;
+
+  static void print_library_line(const ThirdPartyLibrary &lib) {
+    std::cout << "  - " << lib.name;
+    if (!lib.description.empty()) {
+      std::cout << " - " << lib.description;
+    }
+    std::cout << "\n";
+  }
 
   // 创建第三方库目录
   static void create_third_party_dir(const fs::path &project_path) {
@@ -1529,6 +8701,65 @@ private:
     Utils::safe_create_directory(third_party_dir);
   }
 
+  // 已安装库的清单，记录生成预编译头所需的信息；重新生成项目文件时
+  // 据此恢复PCH_INCLUDE_DIRS和PCH_HEADERS
+  static fs::path manifest_path(const fs::path &project_path) {
+    return project_path / "third_party" / "libraries.json";
+  }
+
+  static std::map<std::string, ThirdPartyLibrary>
+  load_manifest(const fs::path &project_path) {
+    std::map<std::string, ThirdPartyLibrary> libs;
+    const fs::path path = manifest_path(project_path);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      return libs;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+    std::string error;
+    auto doc = JsonDocument::parse(std::move(text), &error);
+    if (!doc || !doc->root()["libraries"].is_object()) {
+      std::cerr << "Ignoring invalid " << path.string() << ": "
+                << (doc ? "expected a libraries object" : error) << std::endl;
+      return libs;
+    }
+    doc->root()["libraries"].for_each_member(
+        [&](std::string_view name, JsonValue value) {
+          ThirdPartyLibrary lib;
+          lib.name = std::string(name);
+          if (!Utils::is_valid_library_name(lib.name)) {
+            return;
+          }
+          lib.includePath = std::string(value["includePath"].as_string());
+          value["primaryHeaders"].for_each_element([&](JsonValue header) {
+            if (!header.as_string().empty()) {
+              lib.primaryHeaders.emplace_back(header.as_string());
+            }
+          });
+          libs[lib.name] = std::move(lib);
+        });
+    return libs;
+  }
+
+  static bool save_manifest(const fs::path &project_path,
+                            const std::map<std::string, ThirdPartyLibrary> &libs) {
+    std::string json = "{\n  \"libraries\": {";
+    bool first = true;
+    for (const auto &[name, lib] : libs) {
+      json += std::string(first ? "\n" : ",\n") + "    " +
+              JsonDocument::quote(name) + ": {\"includePath\": " +
+              JsonDocument::quote(lib.includePath) + ", \"primaryHeaders\": [";
+      for (size_t i = 0; i < lib.primaryHeaders.size(); i++) {
+        json += (i ? ", " : "") + JsonDocument::quote(lib.primaryHeaders[i]);
+      }
+      json += "]}";
+      first = false;
+    }
+    json += "\n  }\n}\n";
+    return MetadataCache::write_atomic(manifest_path(project_path), json);
+  }
+
   // 生成库使用指南
   static void generate_library_guide(const fs::path &project_path,
                                      const ThirdPartyLibrary &lib) {
@@ -1546,44 +8777,597 @@ private:
     content += "```cmake\n" + lib.configInstructions + "\n```\n\n";
     content += "### Include in Code\n";
 
-    if (lib.name == "GLFW") {
-      content += "```cpp\n#include <GLFW/glfw3.h>\n```\n\n";
-    } else if (lib.name == "Boost") {
-      content += "```cpp\n#include <boost/filesystem.hpp>\n```\n\n";
-    } else if (lib.name == "SDL2") {
-      content += "```cpp\n#include <SDL.h>\n```\n\n";
-    } else {
-      content += "```cpp\n#include <" + lib.name + ".h>\n```\n\n";
+    content += "```cpp\n";
+    if (lib.primaryHeaders.empty()) {
+      content += "#include <" + lib.name + ".h>\n";
+    }
+    for (const auto &header : lib.primaryHeaders) {
+      content += "#include <" + header + ">\n";
+    }
+    content += "```\n\n";
+    if (!lib.primaryHeaders.empty()) {
+      content += "These headers are precompiled for the project targets "
+                 "(see cmake/PrecompiledHeaders.cmake).\n\n";
+    }
+
+    content += "## Official Documentation\n";
+    if (lib.name == "GLFW") {
+      content += "- [GLFW Documentation](https://www.glfw.org/docs/latest/)\n";
+    } else if (lib.name == "Boost") {
+      content += "- [Boost Documentation](https://www.boost.org/doc/libs/)\n";
+    } else if (lib.name == "SDL2") {
+      content += "- [SDL2 Documentation](https://wiki.libsdl.org/)\n";
+    } else {
+      content += "- Check the official website for " + lib.name + "\n";
+    }
+
+    Utils::write_if_changed(guide_path, content);
+  }
+
+  // 获取当前提供者
+  static ILibraryInfoProvider &get_provider() {
+    if (!provider_) {
+      provider_ = std::make_unique<BuiltinLibraryProvider>();
+    }
+    return *provider_;
+  }
+
+  // 下载库压缩包；有备用地址时对冲下载
+  static bool download_library_archive(const ThirdPartyLibrary &lib,
+                                       const fs::path &zip_file) {
+    std::cout << "\nDownloading " << lib.name << "...\n";
+
+    std::vector<std::string> sources{lib.downloadUrl};
+    for (const auto &url : lib.mirrorUrls) {
+      if (!url.empty() &&
+          std::find(sources.begin(), sources.end(), url) == sources.end()) {
+        sources.push_back(url);
+      }
+    }
+
+    bool ok;
+    if (sources.size() > 1) {
+      ok = download_hedged(sources, zip_file);
+    } else {
+      ok = Utils::safe_download_file(lib.downloadUrl, zip_file);
+    }
+    if (!ok) {
+      std::cerr << "Failed to download " << lib.name << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  // 对冲下载：先从吞吐量最高的来源下载，宽限期后吞吐量仍低于下限或失败时
+  // 再启动下一个来源；先完成者胜出，其余被取消。完整性由随后的SHA256校验保证
+  static bool download_hedged(const std::vector<std::string> &sources,
+                              const fs::path &zip_file) {
+    const auto ranked = MirrorStats::rank_by_throughput(sources);
+#ifndef _WIN32
+    using Clock = std::chrono::steady_clock;
+    struct Attempt {
+      std::string url;
+      fs::path path;
+      std::shared_ptr<CancellationToken> token;
+      std::atomic<uint64_t> bytes{0};
+      int state = 0; // 0: 进行中 1: 成功 2: 失败
+      double rate = 0;
+      Clock::time_point start;
+      TaskScheduler::Future<void> done;
+    };
+    std::vector<std::unique_ptr<Attempt>> attempts;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    // 每个来源写入各自的文件（按原始顺序编号，便于下次续传）
+    auto launch = [&](const std::string &url) {
+      size_t index = static_cast<size_t>(
+          std::find(sources.begin(), sources.end(), url) - sources.begin());
+      auto attempt = std::make_unique<Attempt>();
+      attempt->url = url;
+      attempt->path = zip_file.string() + ".src" + std::to_string(index);
+      attempt->token = std::make_shared<CancellationToken>();
+      attempt->start = Clock::now();
+      Attempt *raw = attempt.get();
+      attempt->done = TaskScheduler::instance().submit_blocking([raw, &mtx,
+                                                                 &cv] {
+        CancellationToken::Scope scope(raw->token);
+        bool ok = false;
+        try {
+          ok = Utils::safe_download_file(
+              raw->url, raw->path,
+              [raw](uint64_t received, uint64_t) { raw->bytes = received; });
+        } catch (const std::exception &e) {
+          std::cerr << "Download failed: " << e.what() << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        raw->state = ok ? 1 : 2;
+        cv.notify_all();
+      });
+      attempts.push_back(std::move(attempt));
+    };
+
+    std::unique_lock<std::mutex> lock(mtx);
+    launch(ranked[0]);
+    size_t next = 1;
+    Attempt *winner = nullptr;
+    while (!winner) {
+      cv.wait_for(lock, std::chrono::milliseconds(250));
+      bool running = false;
+      double best_rate = 0;
+      Clock::duration newest = Clock::duration::max();
+      for (auto &attempt : attempts) {
+        if (attempt->state == 1) {
+          winner = attempt.get();
+          break;
+        }
+        if (attempt->state == 0) {
+          // curl不报告进度，以文件大小估算
+          std::error_code ec;
+          uint64_t size = fs::file_size(attempt->path, ec);
+          uint64_t bytes = std::max<uint64_t>(attempt->bytes, ec ? 0 : size);
+          Clock::duration elapsed = Clock::now() - attempt->start;
+          attempt->rate =
+              bytes / std::chrono::duration<double>(elapsed).count();
+          best_rate = std::max(best_rate, attempt->rate);
+          newest = std::min(newest, elapsed);
+          running = true;
+        }
+      }
+      if (winner) {
+        break;
+      }
+      if (next < ranked.size() &&
+          (!running || (newest >= kHedgeGrace && best_rate < kHedgeFloor))) {
+        std::cout << (running ? "Slow source, also trying " : "Trying ")
+                  << MirrorStats::origin(ranked[next]) << "\n";
+        launch(ranked[next++]);
+      } else if (!running) {
+        break;
+      }
+    }
+    lock.unlock();
+
+    for (auto &attempt : attempts) {
+      if (attempt.get() != winner) {
+        attempt->token->cancel();
+      }
+    }
+    for (auto &attempt : attempts) {
+      attempt->done.wait();
+      if (attempt->state == 2 && !attempt->token->cancelled()) {
+        MirrorStats::record_failure(attempt->url);
+      } else if (attempt->token->cancelled()) {
+        // 被取消的来源也记录观测到的吞吐量，下次排在更快的来源之后
+        if (attempt->rate > 0) {
+          MirrorStats::record_throughput(attempt->url, attempt->rate);
+        } else {
+          MirrorStats::record_failure(attempt->url);
+        }
+      }
+    }
+    if (!winner) {
+      return false;
+    }
+
+    std::error_code ec;
+    double seconds = std::max(
+        0.001,
+        std::chrono::duration<double>(Clock::now() - winner->start).count());
+    MirrorStats::record_throughput(
+        winner->url, fs::file_size(winner->path, ec) / seconds);
+    std::cout << "Downloaded from " << MirrorStats::origin(winner->url)
+              << "\n";
+    for (auto &attempt : attempts) {
+      if (attempt.get() != winner) {
+        for (const char *suffix : {"", ".part", ".part.state"}) {
+          fs::remove(attempt->path.string() + suffix, ec);
+        }
+      }
+    }
+    fs::rename(winner->path, zip_file, ec);
+    return !ec;
+#else
+    // 没有取消机制时按吞吐量顺序依次尝试
+    for (const auto &url : ranked) {
+      auto start = std::chrono::steady_clock::now();
+      if (Utils::safe_download_file(url, zip_file)) {
+        std::error_code ec;
+        double seconds = std::max(
+            0.001, std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count());
+        MirrorStats::record_throughput(url,
+                                       fs::file_size(zip_file, ec) / seconds);
+        return true;
+      }
+      MirrorStats::record_failure(url);
+    }
+    return false;
+#endif
+  }
+
+  // 校验压缩包SHA256
+  static bool verify_library_archive(const ThirdPartyLibrary &lib,
+                                     const fs::path &zip_file) {
+    std::cout << "Verifying SHA256 checksum of " << lib.name << "...\n";
+    try {
+      std::string calculated_sha = SHA256::hash_file(zip_file);
+      std::transform(calculated_sha.begin(), calculated_sha.end(),
+                     calculated_sha.begin(), ::tolower);
+
+      if (calculated_sha != lib.sha256) {
+        std::cerr << "SHA256 verification failed for " << lib.name << "!\n";
+        std::cerr << "Expected: " << lib.sha256 << "\n";
+        std::cerr << "Actual:   " << calculated_sha << "\n";
+        fs::remove(zip_file);
+        return false;
+      }
+      std::cout << "SHA256 verification of " << lib.name << " passed.\n";
+    } catch (const std::exception &e) {
+      std::cerr << "Error during SHA256 calculation: " << e.what() << std::endl;
+      fs::remove(zip_file);
+      return false;
+    }
+    return true;
+  }
+
+  // 获取已校验的库压缩包：缓存命中时跳过网络，否则下载、校验并写入缓存
+  static std::optional<LibraryArchive>
+  acquire_library_archive(const ThirdPartyLibrary &lib,
+                          const fs::path &third_party_dir) {
+    if (auto hit = ArchiveCache::lookup(lib.sha256)) {
+      std::cout << "Using cached archive for " << lib.name << ": " << *hit
+                << "\n";
+      return LibraryArchive{*hit, true};
+    }
+
+    const bool use_cache = ArchiveCache::usable(lib.sha256);
+    std::optional<ArchiveCache::DownloadLock> lock;
+    if (use_cache) {
+      // 锁一直持有到提交完成；等待期间其他进程可能已提交同一压缩包
+      lock.emplace(lib.sha256);
+      if (auto hit = ArchiveCache::lookup(lib.sha256)) {
+        std::cout << "Using cached archive for " << lib.name << ": " << *hit
+                  << "\n";
+        return LibraryArchive{*hit, true};
+      }
+    }
+    const fs::path target = use_cache
+                                ? ArchiveCache::download_path(lib.sha256)
+                                : third_party_dir / (lib.name + ".zip");
+    {
+      SlotGuard slot(download_slots_);
+      if (!download_library_archive(lib, target)) {
+        // 缓存目录中的部分下载保留，下次运行时续传
+        if (!use_cache) {
+          std::error_code ec;
+          fs::remove(target, ec);
+        }
+        return std::nullopt;
+      }
+    }
+    // 下载在阻塞线程上进行，校验交给CPU工作线程
+    if (!TaskScheduler::instance()
+             .submit([&lib, &target] {
+               return verify_library_archive(lib, target);
+             })
+             .get()) {
+      return std::nullopt;
+    }
+
+    if (use_cache) {
+      if (auto committed = ArchiveCache::commit(lib.sha256, target)) {
+        return LibraryArchive{*committed, true};
+      }
+      std::cerr << "Failed to store " << lib.name << " in the archive cache\n";
+      return std::nullopt;
+    }
+    return LibraryArchive{target, false};
+  }
+
+  // 在阻塞线程上获取压缩包。可缓存的压缩包按摘要去重：其他项目正在获取
+  // 同一压缩包时直接等待那次下载。获取结束后移除记录，失败的下载可被
+  // 之后的项目重试，成功的压缩包此后直接由缓存提供
+  static TaskScheduler::Future<std::optional<LibraryArchive>>
+  acquire_shared(const ThirdPartyLibrary &lib,
+                 const fs::path &third_party_dir) {
+    auto &scheduler = TaskScheduler::instance();
+    auto acquire = [lib, third_party_dir] {
+      return acquire_library_archive(lib, third_party_dir);
+    };
+    if (!ArchiveCache::usable(lib.sha256)) {
+      return scheduler.submit_blocking(acquire);
+    }
+    std::string key = lib.sha256;
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    auto release = [key] {
+      std::lock_guard<std::mutex> lock(inflight_mtx_);
+      inflight_.erase(key);
+    };
+    std::lock_guard<std::mutex> lock(inflight_mtx_);
+    auto it = inflight_.find(key);
+    if (it == inflight_.end()) {
+      it = inflight_
+               .emplace(key, scheduler.submit_blocking([acquire, release] {
+                 try {
+                   auto archive = acquire();
+                   release();
+                   return archive;
+                 } catch (...) {
+                   release();
+                   throw;
+                 }
+               }))
+               .first;
+    }
+    return it->second;
+  }
+
+  // 选择性解压：includePath/libPath子树加上元数据中的glob
+  static ZipExtractor::Filter make_extract_filter(const ThirdPartyLibrary &lib) {
+    ZipExtractor::Filter filter;
+    if (!selective_extraction_) {
+      return filter;
+    }
+    for (const auto &path : {lib.includePath, lib.libPath}) {
+      std::string subtree = Utils::clean_path(path);
+      if (!subtree.empty()) {
+        filter.include.push_back(subtree + "/**");
+      }
+    }
+    filter.include.insert(filter.include.end(), lib.extractInclude.begin(),
+                          lib.extractInclude.end());
+    filter.exclude = lib.extractExclude;
+    return filter;
+  }
+
+  // 解压库压缩包（非缓存的压缩包解压后删除）
+  static bool extract_library_archive(const ThirdPartyLibrary &lib,
+                                      const LibraryArchive &archive,
+                                      const fs::path &third_party_dir) {
+    std::cout << "Extracting " << lib.name << "...\n";
+
+    const ZipExtractor::Filter filter = make_extract_filter(lib);
+    bool ok;
+    if (archive.cached && ExtractedStore::enabled()) {
+      // 共享存储：每个(库, 摘要)只解压一次，项目中只建立链接
+      auto store = ExtractedStore::ensure(lib.name, lib.sha256, archive.path,
+                                          filter);
+      ok = store && ExtractedStore::populate(*store, third_party_dir);
+    } else {
+      ok = Utils::safe_unzip_file(archive.path, third_party_dir, filter);
+    }
+    if (!ok) {
+      std::cerr << "Failed to extract " << lib.name << std::endl;
+      return false;
+    }
+
+    if (!archive.cached) {
+      // 删除压缩包（异步执行）
+      TaskScheduler::instance().submit([zip_file = archive.path]() {
+        try {
+          fs::remove(zip_file);
+        } catch (const std::exception &e) {
+          std::cerr << "Error removing zip file: " << e.what() << std::endl;
+        }
+      });
+    }
+
+    return true;
+  }
+
+  // 生成库指南并追加CMake配置
+  static void finalize_library(const fs::path &project_path,
+                               const ThirdPartyLibrary &lib) {
+    static std::mutex cmake_mtx;
+
+    generate_library_guide(project_path, lib);
+
+    {
+      std::lock_guard<std::mutex> lock(installed_mtx_);
+      auto &finished = finished_libs_[project_key(project_path)];
+      finished[lib.name] = lib;
+      // 保留之前运行安装的库
+      auto manifest = load_manifest(project_path);
+      for (const auto &[name, info] : finished) {
+        manifest[name] = info;
+      }
+      if (!save_manifest(project_path, manifest)) {
+        std::cerr << "Failed to update " << manifest_path(project_path).string()
+                  << std::endl;
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(cmake_mtx);
+      const fs::path cmake_path = project_path / "CMakeLists.txt";
+      if (fs::exists(cmake_path)) {
+        std::ofstream cmake(cmake_path, std::ios::app);
+        cmake << "\n# " << lib.name << " Configuration\n";
+        cmake << lib.configInstructions << "\n";
+      }
+    }
+
+    std::cout << lib.name << " added successfully!\n";
+    std::cout << "See docs/" << lib.name
+              << "_GUIDE.md for usage instructions\n";
+  }
+
+  // 依赖图中的一个待安装库
+  struct InstallNode {
+    ThirdPartyLibrary info;
+    std::vector<std::string> dependencies;
+    TaskScheduler::Future<bool> done;
+  };
+
+  // 解析完整依赖闭包，返回按拓扑排序的库名；未找到的库记入missing
+  static std::vector<std::string>
+  resolve_dependencies(const fs::path &project_path,
+                       const std::vector<std::string> &lib_names,
+                       std::map<std::string, InstallNode> &nodes,
+                       std::set<std::string> &missing) {
+    std::lock_guard<std::mutex> provider_lock(provider_mtx_);
+    auto &provider = get_provider();
+    std::vector<std::string> wave(lib_names);
+    std::vector<std::string> discovered;
+
+    // 按层广度优先遍历，每层的库信息一次性预取
+    while (!wave.empty()) {
+      provider.prefetch_library_info(wave);
+      std::vector<std::string> pending;
+      pending.swap(wave);
+      for (const auto &lib_name : pending) {
+        if (lib_name.empty() || nodes.count(lib_name) ||
+            missing.count(lib_name) || is_installed(project_path, lib_name)) {
+          continue;
+        }
+
+        // 名称来自命令行或远程JSON的依赖列表，拼进路径和URL前先校验
+        if (!Utils::is_valid_library_name(lib_name)) {
+          std::cerr << "Invalid library name: " << lib_name << std::endl;
+          missing.insert(lib_name);
+          continue;
+        }
+        auto lib_info = provider.get_library_info(lib_name);
+        if (lib_info && !Utils::is_valid_library_name(lib_info->name)) {
+          std::cerr << "Invalid library name in metadata of " << lib_name
+                    << ": " << lib_info->name << std::endl;
+          lib_info.reset();
+        }
+        if (!lib_info) {
+          std::cerr << "Library not found: " << lib_name << std::endl;
+          missing.insert(lib_name);
+          continue;
+        }
+
+        InstallNode &node = nodes[lib_name];
+        node.info = *lib_info;
+        discovered.push_back(lib_name);
+        for (const auto &dep : lib_info->dependencies) {
+          if (!dep.empty()) {
+            node.dependencies.push_back(dep);
+            wave.push_back(dep);
+          }
+        }
+      }
+    }
+
+    // Kahn拓扑排序；已安装或未找到的依赖不构成边
+    std::map<std::string, size_t> in_degree;
+    std::map<std::string, std::vector<std::string>> dependents;
+    for (const auto &name : discovered) {
+      in_degree[name];
+      for (const auto &dep : nodes[name].dependencies) {
+        if (nodes.count(dep)) {
+          in_degree[name]++;
+          dependents[dep].push_back(name);
+        }
+      }
+    }
+
+    std::vector<std::string> order;
+    for (const auto &name : discovered) {
+      if (in_degree[name] == 0) {
+        order.push_back(name);
+      }
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+      for (const auto &dependent : dependents[order[i]]) {
+        if (--in_degree[dependent] == 0) {
+          order.push_back(dependent);
+        }
+      }
     }
 
-    content += "## Official Documentation\n";
-    if (lib.name == "GLFW") {
-      content += "- [GLFW Documentation](https://www.glfw.org/docs/latest/)\n";
-    } else if (lib.name == "Boost") {
-      content += "- [Boost Documentation](https://www.boost.org/doc/libs/)\n";
-    } else if (lib.name == "SDL2") {
-      content += "- [SDL2 Documentation](https://wiki.libsdl.org/)\n";
-    } else {
-      content += "- Check the official website for " + lib.name + "\n";
+    if (order.size() != discovered.size()) {
+      for (const auto &name : discovered) {
+        if (in_degree[name] != 0) {
+          std::cerr << "Dependency cycle detected involving " << name
+                    << ", skipping.\n";
+          nodes.erase(name);
+        }
+      }
     }
+    return order;
+  }
 
-    Utils::safe_write_file(guide_path, content);
+  static std::string project_key(const fs::path &project_path) {
+    std::error_code ec;
+    fs::path path = fs::absolute(project_path, ec);
+    return (ec ? project_path : path).lexically_normal().generic_string();
   }
 
-  // 获取当前提供者
-  static ILibraryInfoProvider &get_provider() {
-    if (!provider_) {
-      provider_ = std::make_unique<BuiltinLibraryProvider>();
-    }
-    return *provider_;
+  static bool is_installed(const fs::path &project_path,
+                           const std::string &lib_name) {
+    std::lock_guard<std::mutex> lock(installed_mtx_);
+    auto it = installed_libs_.find(project_key(project_path));
+    return it != installed_libs_.end() && it->second.count(lib_name) != 0;
   }
 
 public:
+  // 一次安装的结果；failed包括未找到的库
+  struct InstallReport {
+    std::vector<std::string> installed;
+    std::vector<std::string> failed;
+  };
+
+  // 需要预编译的第三方头文件及其所在的包含目录（相对于项目目录）
+  struct PrecompiledHeaders {
+    std::vector<std::string> include_dirs;
+    std::vector<std::string> headers;
+  };
+
+  // 项目中已安装的库（清单加上本次运行安装的）的主要头文件，按库名排序，
+  // 结果稳定
+  static PrecompiledHeaders precompiled_headers(const fs::path &project_path) {
+    PrecompiledHeaders pch;
+    std::lock_guard<std::mutex> lock(installed_mtx_);
+    auto libs = load_manifest(project_path);
+    auto it = finished_libs_.find(project_key(project_path));
+    if (it != finished_libs_.end()) {
+      for (const auto &[name, lib] : it->second) {
+        libs[name] = lib;
+      }
+    }
+    for (const auto &[name, lib] : libs) {
+      if (lib.primaryHeaders.empty()) {
+        continue;
+      }
+      const std::string dir =
+          "third_party/" + Utils::clean_path(lib.includePath);
+      if (std::find(pch.include_dirs.begin(), pch.include_dirs.end(), dir) ==
+          pch.include_dirs.end()) {
+        pch.include_dirs.push_back(dir);
+      }
+      for (const auto &header : lib.primaryHeaders) {
+        if (std::find(pch.headers.begin(), pch.headers.end(), header) ==
+            pch.headers.end()) {
+          pch.headers.push_back(header);
+        }
+      }
+    }
+    return pch;
+  }
+
   // 设置库信息提供者
   static void set_provider(std::unique_ptr<ILibraryInfoProvider> provider) {
     provider_ = std::move(provider);
   }
 
+  // 只解压库需要的include/lib子树
+  static void set_selective_extraction(bool enabled) {
+    selective_extraction_ = enabled;
+  }
+
+  // 设置并发下载数和任务调度器的工作线程数（须在调度器首次使用前调用）
+  static void set_concurrency(unsigned download_jobs, unsigned cpu_jobs) {
+    if (download_jobs > 0) {
+      download_slots_.set_limit(download_jobs);
+    }
+    TaskScheduler::configure(cpu_jobs);
+  }
+
   static void offer_library_installation(const fs::path &project_path) {
     std::cout << "\nWould you like to add any third-party libraries? [y/N]: ";
     std::string response;
@@ -1594,246 +9378,815 @@ public:
     }
 
     auto &provider = get_provider();
-    auto available_libs = provider.get_available_libraries();
+    LibraryCatalog catalog(provider.get_library_summaries());
 
-    if (available_libs.empty()) {
+    if (catalog.size() == 0) {
       std::cout << "No libraries available from the current provider.\n";
       return;
     }
 
-    std::cout << "\nAvailable libraries:\n";
-    for (const auto &lib : available_libs) {
-      std::cout << "  - " << lib << "\n";
+    // 目录较小时全部列出，否则只提示搜索
+    if (catalog.size() <= kListAllLimit) {
+      std::cout << "\nAvailable libraries:\n";
+      for (const auto &lib : catalog.entries()) {
+        print_library_line(lib);
+      }
+    } else {
+      std::cout << "\n" << catalog.size()
+                << " libraries available. Type a name, a prefix or any "
+                   "keywords to search.\n";
     }
 
+    // 先收集全部选择，再统一并发安装；不存在的名称给出候选而不是去远程查询
+    std::vector<std::string> selected;
     while (true) {
       std::cout << "\nEnter library name (or 'done' to finish): ";
       std::string lib_name;
       std::getline(std::cin, lib_name);
+      lib_name = Utils::trim(lib_name);
 
-      if (lib_name == "done") {
+      if (lib_name == "done" || !std::cin) {
         break;
       }
+      if (lib_name.empty()) {
+        continue;
+      }
 
-      add_third_party_library(project_path, lib_name);
+      if (const ThirdPartyLibrary *lib = catalog.find(lib_name)) {
+        selected.push_back(lib->name);
+        std::cout << "Selected " << lib->name << "\n";
+        continue;
+      }
+      auto matches = catalog.complete(lib_name, kSuggestionLimit);
+      if (matches.empty()) {
+        matches = catalog.search(lib_name, kSuggestionLimit);
+      }
+      if (matches.empty()) {
+        std::cout << "No library matches '" << lib_name << "'.\n";
+        continue;
+      }
+      std::cout << "No library named '" << lib_name << "'. Matches:\n";
+      for (const ThirdPartyLibrary *match : matches) {
+        print_library_line(*match);
+      }
     }
+
+    install_libraries(project_path, selected);
   }
 
   // 下载并解压库文件
   static bool download_and_extract_library(const fs::path &project_path,
                                            const ThirdPartyLibrary &lib) {
     const fs::path third_party_dir = project_path / "third_party";
-    const fs::path zip_file = third_party_dir / (lib.name + ".zip");
-
-    std::cout << "\nDownloading " << lib.name << "...\n";
+    auto archive = acquire_library_archive(lib, third_party_dir);
+    return archive && extract_library_archive(lib, *archive, third_party_dir);
+  }
 
-    // 下载文件
-    if (!Utils::safe_download_file(lib.downloadUrl, zip_file)) {
-      std::cerr << "Failed to download " << lib.name << std::endl;
-      return false;
+  // 并发安装多个库：先解析完整依赖集，再并行下载、校验和解压。
+  // 下载与CPU任务分别受并发上限约束，只有存在依赖边的库才会等待。
+  static InstallReport
+  install_libraries(const fs::path &project_path,
+                    const std::vector<std::string> &lib_names) {
+    InstallReport report;
+    std::map<std::string, InstallNode> nodes;
+    std::set<std::string> missing;
+    std::vector<std::string> order =
+        resolve_dependencies(project_path, lib_names, nodes, missing);
+    report.failed.assign(missing.begin(), missing.end());
+    if (order.empty()) {
+      return report;
     }
 
-    std::cout << "Verifying SHA256 checksum...\n";
-    try {
-      std::string calculated_sha = SHA256::hash_file(zip_file);
-      std::transform(calculated_sha.begin(), calculated_sha.end(),
-                     calculated_sha.begin(), ::tolower);
+    create_third_party_dir(project_path);
+    const fs::path third_party_dir = project_path / "third_party";
 
-      if (calculated_sha != lib.sha256) {
-        std::cerr << "SHA256 verification failed!\n";
-        std::cerr << "Expected: " << lib.sha256 << "\n";
-        std::cerr << "Actual:   " << calculated_sha << "\n";
-        fs::remove(zip_file);
-        return false;
+    // 下载立即并行开始；解压和收尾在下载及所有依赖完成后才提交，
+    // 按拓扑顺序建立任务，保证依赖任务已经存在
+    auto &scheduler = TaskScheduler::instance();
+    for (const auto &name : order) {
+      InstallNode &node = nodes[name];
+      const ThirdPartyLibrary &lib = node.info;
+      std::cout << "\nAdding " << lib.name << " to project...\n";
+      auto download = acquire_shared(lib, third_party_dir);
+
+      std::vector<TaskScheduler::Future<bool>> deps;
+      std::vector<TaskScheduler::Handle> prerequisites{download.handle()};
+      for (const auto &dep : node.dependencies) {
+        auto it = nodes.find(dep);
+        if (it != nodes.end()) {
+          deps.push_back(it->second.done);
+          prerequisites.push_back(it->second.done.handle());
+        }
       }
-      std::cout << "SHA256 verification passed.\n";
-    } catch (const std::exception &e) {
-      std::cerr << "Error during SHA256 calculation: " << e.what() << std::endl;
-      fs::remove(zip_file);
-      return false;
-    }
-
-    std::cout << "Extracting " << lib.name << "...\n";
 
-    // 解压文件
-    if (!Utils::safe_unzip_file(zip_file, third_party_dir)) {
-      std::cerr << "Failed to extract " << lib.name << std::endl;
-      return false;
+      node.done = scheduler.submit_after(
+          prerequisites, [&project_path, &third_party_dir, &lib, download,
+                          deps]() {
+            auto archive = download.get();
+            for (const auto &dep : deps) {
+              if (!dep.get()) {
+                if (archive) {
+                  std::cerr << "Skipping " << lib.name
+                            << ": a dependency failed to install\n";
+                  if (!archive->cached) {
+                    fs::remove(archive->path);
+                  }
+                }
+                return false;
+              }
+            }
+            if (!archive ||
+                !extract_library_archive(lib, *archive, third_party_dir)) {
+              return false;
+            }
+            finalize_library(project_path, lib);
+            return true;
+          });
     }
 
-    // 删除压缩包（异步执行）
-    std::thread([zip_file]() {
+    for (const auto &name : order) {
+      bool ok = false;
       try {
-        fs::remove(zip_file);
+        ok = nodes[name].done.get();
       } catch (const std::exception &e) {
-        std::cerr << "Error removing zip file: " << e.what() << std::endl;
+        std::cerr << "Failed to install " << name << ": " << e.what()
+                  << std::endl;
       }
-    }).detach();
+      (ok ? report.installed : report.failed).push_back(name);
+    }
 
-    return true;
+    // 只记录安装成功的库，失败的库之后仍可重试
+    std::lock_guard<std::mutex> lock(installed_mtx_);
+    auto &installed = installed_libs_[project_key(project_path)];
+    installed.insert(report.installed.begin(), report.installed.end());
+    return report;
   }
 
-  // 添加第三方库到项目
+  // 添加第三方库到项目（连同其依赖）
   static void add_third_party_library(const fs::path &project_path,
                                       const std::string &lib_name) {
-    static std::set<std::string> installed_libs;
-    static std::mutex mtx;
+    if (is_installed(project_path, lib_name)) {
+      std::cout << lib_name << " already installed. Skipping.\n";
+      return;
+    }
+    install_libraries(project_path, {lib_name});
+  }
+};
 
-    {
-      std::lock_guard<std::mutex> lock(mtx);
-      if (installed_libs.find(lib_name) != installed_libs.end()) {
-        std::cout << lib_name << " already installed. Skipping.\n";
-        return;
+// 初始化静态成员
+std::unique_ptr<ILibraryInfoProvider> LibraryService::provider_ = nullptr;
+std::map<std::string, std::set<std::string>> LibraryService::installed_libs_;
+std::map<std::string, std::map<std::string, ThirdPartyLibrary>>
+    LibraryService::finished_libs_;
+std::mutex LibraryService::installed_mtx_;
+std::map<std::string, TaskScheduler::Future<
+                          std::optional<LibraryService::LibraryArchive>>>
+    LibraryService::inflight_;
+std::mutex LibraryService::inflight_mtx_;
+std::mutex LibraryService::provider_mtx_;
+bool LibraryService::selective_extraction_ = false;
+CountingSemaphore LibraryService::download_slots_(4);
+
+// 模板渲染用的值：字符串、布尔或字符串列表
+class TemplateValues {
+public:
+  struct Value {
+    enum class Kind { TEXT, FLAG, LIST } kind = Kind::TEXT;
+    std::string text;
+    bool flag = false;
+    std::vector<std::string> items;
+
+    bool truthy() const {
+      switch (kind) {
+      case Kind::FLAG:
+        return flag;
+      case Kind::LIST:
+        return !items.empty();
+      default:
+        return !text.empty();
       }
-      installed_libs.insert(lib_name);
     }
+  };
 
-    create_third_party_dir(project_path);
+  TemplateValues &set(std::string_view name, std::string text) {
+    slot(name) = Value{Value::Kind::TEXT, std::move(text), false, {}};
+    return *this;
+  }
 
-    auto &provider = get_provider();
-    auto lib_info = provider.get_library_info(lib_name);
+  TemplateValues &set(std::string_view name, const char *text) {
+    return set(name, std::string(text));
+  }
 
-    if (!lib_info) {
-      std::cerr << "Library not found: " << lib_name << std::endl;
-      return;
+  TemplateValues &set(std::string_view name, bool flag) {
+    slot(name) = Value{Value::Kind::FLAG, {}, flag, {}};
+    return *this;
+  }
+
+  TemplateValues &set(std::string_view name, std::vector<std::string> items) {
+    slot(name) = Value{Value::Kind::LIST, {}, false, std::move(items)};
+    return *this;
+  }
+
+  const Value *find(std::string_view name) const {
+    for (const auto &[key, value] : values_) {
+      if (key == name) {
+        return &value;
+      }
     }
+    return nullptr;
+  }
 
-    std::cout << "\nAdding " << lib_info->name << " to project...\n";
+private:
+  // 模板变量只有十个左右，线性查找即可
+  std::vector<std::pair<std::string, Value>> values_;
 
-    // 下载并解压库
-    if (!download_and_extract_library(project_path, *lib_info)) {
-      return;
+  Value &slot(std::string_view name) {
+    for (auto &[key, value] : values_) {
+      if (key == name) {
+        return value;
+      }
     }
+    return values_.emplace_back(std::string(name), Value{}).second;
+  }
+};
 
-    // 使用线程并行执行以下任务
-    auto future_guide = std::async(std::launch::async, [&]() {
-      generate_library_guide(project_path, *lib_info);
-    });
+// 预编译模板：解析一次得到指令列表（文本片段、变量、区块），渲染时先计算
+// 输出长度，再一次性写入预分配的缓冲区。文本片段直接引用模板源（常量或
+// 映射的文件），不复制
+class Template {
+public:
+  // 解析模板；语法错误抛出std::runtime_error
+  explicit Template(std::string_view source) : source_(source) { compile(); }
+
+  // 映射并解析用户模板文件
+  static std::unique_ptr<Template> load(const fs::path &path) {
+    auto file = std::make_unique<MappedFile>(path);
+    std::string_view source(reinterpret_cast<const char *>(file->data()),
+                            file->size());
+    auto tpl = std::make_unique<Template>(source);
+    tpl->file_ = std::move(file);
+    return tpl;
+  }
 
-    auto future_cmake = std::async(std::launch::async, [&]() {
-      const fs::path cmake_path = project_path / "CMakeLists.txt";
-      if (fs::exists(cmake_path)) {
-        std::ofstream cmake(cmake_path, std::ios::app);
-        cmake << "\n# " << lib_info->name << " Configuration\n";
-        cmake << lib_info->configInstructions << "\n";
+  Template(const Template &) = delete;
+  Template &operator=(const Template &) = delete;
+
+  std::string render(const TemplateValues &values) const {
+    std::vector<const TemplateValues::Value *> bound(symbols_.size());
+    for (size_t i = 0; i < symbols_.size(); i++) {
+      bound[i] = values.find(symbols_[i]);
+    }
+    std::string out;
+    out.reserve(run(0, code_.size(), values, bound, nullptr, nullptr));
+    run(0, code_.size(), values, bound, nullptr, &out);
+    return out;
+  }
+
+private:
+  struct Op {
+    enum class Kind : uint8_t { TEXT, VAR, SECTION, INVERTED, PARTIAL } kind;
+    uint32_t a; // TEXT: 源偏移；其他：符号下标（PARTIAL为模板名）
+    uint32_t b; // TEXT: 长度；区块：区块结束后的指令下标
+  };
+  static constexpr uint32_t kCurrentItem = UINT32_MAX; // {{.}}
+
+  std::string_view source_;
+  std::unique_ptr<MappedFile> file_;
+  std::vector<Op> code_;
+  std::vector<std::string_view> symbols_;
+
+  [[noreturn]] void fail(size_t offset, const std::string &message) const {
+    size_t line = 1 + static_cast<size_t>(std::count(
+                          source_.begin(), source_.begin() + offset, '\n'));
+    throw std::runtime_error("template line " + std::to_string(line) + ": " +
+                             message);
+  }
+
+  static std::string_view strip(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<uint8_t>(text.front()))) {
+      text.remove_prefix(1);
+    }
+    while (!text.empty() && std::isspace(static_cast<uint8_t>(text.back()))) {
+      text.remove_suffix(1);
+    }
+    return text;
+  }
+
+  uint32_t symbol(std::string_view name) {
+    if (name == ".") {
+      return kCurrentItem;
+    }
+    auto it = std::find(symbols_.begin(), symbols_.end(), name);
+    if (it == symbols_.end()) {
+      symbols_.push_back(name);
+      return static_cast<uint32_t>(symbols_.size() - 1);
+    }
+    return static_cast<uint32_t>(it - symbols_.begin());
+  }
+
+  void emit_text(size_t begin, size_t end) {
+    if (end > begin) {
+      code_.push_back({Op::Kind::TEXT, static_cast<uint32_t>(begin),
+                       static_cast<uint32_t>(end - begin)});
+    }
+  }
+
+  void compile() {
+    if (source_.size() >= UINT32_MAX) {
+      throw std::runtime_error("template too large");
+    }
+    std::vector<std::pair<size_t, std::string_view>> open; // 指令下标、名称
+    size_t text_begin = 0;
+    size_t pos = 0;
+    while ((pos = source_.find("{{", pos)) != std::string_view::npos) {
+      const size_t tag_begin = pos;
+      const size_t close = source_.find("}}", pos + 2);
+      if (close == std::string_view::npos) {
+        fail(tag_begin, "unterminated tag");
+      }
+      size_t tag_end = close + 2;
+      std::string_view body = source_.substr(pos + 2, close - pos - 2);
+      const char sigil = body.empty() ? '\0' : body[0];
+      const bool block = sigil == '#' || sigil == '^' || sigil == '/' ||
+                         sigil == '!' || sigil == '>';
+      std::string_view name = strip(block ? body.substr(1) : body);
+      if (name.empty() && sigil != '!') {
+        fail(tag_begin, "empty tag");
       }
-    });
 
-    // 等待任务完成
-    future_guide.get();
-    future_cmake.get();
+      // 独占一行的区块标签不输出所在的行
+      size_t text_end = tag_begin;
+      if (block) {
+        size_t line_begin = tag_begin;
+        while (line_begin > text_begin &&
+               (source_[line_begin - 1] == ' ' ||
+                source_[line_begin - 1] == '\t')) {
+          line_begin--;
+        }
+        size_t line_end = tag_end;
+        while (line_end < source_.size() &&
+               (source_[line_end] == ' ' || source_[line_end] == '\t' ||
+                source_[line_end] == '\r')) {
+          line_end++;
+        }
+        const bool at_line_start =
+            line_begin == 0 || source_[line_begin - 1] == '\n';
+        const bool at_line_end =
+            line_end == source_.size() || source_[line_end] == '\n';
+        if (at_line_start && at_line_end) {
+          text_end = line_begin;
+          tag_end = std::min(source_.size(), line_end + 1);
+        }
+      }
+      emit_text(text_begin, text_end);
 
-    // 安装依赖项（顺序执行，因为可能有依赖关系）
-    for (const auto &dep : lib_info->dependencies) {
-      std::cout << "Installing dependency: " << dep << "\n";
-      add_third_party_library(project_path, dep);
+      switch (sigil) {
+      case '!':
+        break;
+      case '#':
+      case '^':
+        open.emplace_back(code_.size(), name);
+        code_.push_back({sigil == '#' ? Op::Kind::SECTION : Op::Kind::INVERTED,
+                         symbol(name), 0});
+        break;
+      case '>':
+        code_.push_back({Op::Kind::PARTIAL, symbol(name), 0});
+        break;
+      case '/':
+        if (open.empty() || open.back().second != name) {
+          fail(tag_begin, "unexpected {{/" + std::string(name) + "}}");
+        }
+        code_[open.back().first].b = static_cast<uint32_t>(code_.size());
+        open.pop_back();
+        break;
+      default:
+        code_.push_back({Op::Kind::VAR, symbol(name), 0});
+      }
+      text_begin = pos = tag_end;
+    }
+    if (!open.empty()) {
+      fail(source_.size(),
+           "unclosed section {{#" + std::string(open.back().second) + "}}");
     }
+    emit_text(text_begin, source_.size());
+  }
 
-    std::cout << lib_info->name << " added successfully!\n";
-    std::cout << "See docs/" << lib_info->name
-              << "_GUIDE.md for usage instructions\n";
+  // 渲染插入的模板，定义在TemplateStore之后
+  static std::string render_partial(std::string_view name,
+                                    const TemplateValues &values);
+
+  // 执行指令[begin, end)；out为空时只计算输出长度
+  size_t run(size_t begin, size_t end, const TemplateValues &values,
+             const std::vector<const TemplateValues::Value *> &bound,
+             const std::string *item, std::string *out) const {
+    size_t size = 0;
+    auto put = [&size, out](std::string_view text) {
+      size += text.size();
+      if (out) {
+        out->append(text);
+      }
+    };
+    for (size_t i = begin; i < end; i++) {
+      const Op &op = code_[i];
+      switch (op.kind) {
+      case Op::Kind::TEXT:
+        put(source_.substr(op.a, op.b));
+        break;
+      case Op::Kind::VAR:
+        if (op.a == kCurrentItem) {
+          if (item) {
+            put(*item);
+          }
+        } else if (bound[op.a] &&
+                   bound[op.a]->kind == TemplateValues::Value::Kind::TEXT) {
+          put(bound[op.a]->text);
+        }
+        break;
+      case Op::Kind::SECTION:
+      case Op::Kind::INVERTED: {
+        const TemplateValues::Value *value =
+            op.a == kCurrentItem ? nullptr : bound[op.a];
+        const bool truthy =
+            op.a == kCurrentItem ? item && !item->empty()
+                                 : value && value->truthy();
+        if ((op.kind == Op::Kind::SECTION) != truthy) {
+          // 不展开
+        } else if (op.kind == Op::Kind::SECTION && value &&
+                   value->kind == TemplateValues::Value::Kind::LIST) {
+          for (const auto &element : value->items) {
+            size += run(i + 1, op.b, values, bound, &element, out);
+          }
+        } else {
+          size += run(i + 1, op.b, values, bound, item, out);
+        }
+        i = op.b - 1;
+        break;
+      }
+      case Op::Kind::PARTIAL:
+        put(render_partial(symbols_[op.a], values));
+        break;
+      }
+    }
+    return size;
   }
 };
 
-// 初始化静态成员
-std::unique_ptr<ILibraryInfoProvider> LibraryService::provider_ = nullptr;
-
-// 项目生成服务
-class ProjectGenerator {
+// 项目模板：用户模板目录中的同名文件优先，否则使用内置模板。
+// 每个模板只解析一次，之后的渲染直接使用缓存的指令列表
+class TemplateStore {
 public:
-  // 生成项目文件（多线程版本）
-  static void generate_project_files(const fs::path &project_path,
-                                     const std::string &project_name,
-                                     const CompilerConfig &compiler,
-                                     const DebuggerConfig &debugger) {
-    const fs::path vscode_dir = project_path / ".vscode";
-    Utils::safe_create_directory(vscode_dir);
-
-    // 并行生成配置文件
-    std::vector<std::future<void>> futures;
+  static void configure(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!dir.empty()) {
+      dir_override_ = dir;
+    }
+    cache_.clear();
+  }
 
-    futures.push_back(std::async(std::launch::async, [&]() {
-      generate_c_cpp_properties(vscode_dir, compiler);
-    }));
+  // 模板目录：--template-dir > SLN2CODE_TEMPLATE_DIR > 用户配置目录
+  static fs::path template_dir() {
+    if (!dir_override_.empty()) {
+      return dir_override_;
+    }
+    if (const char *dir = std::getenv("SLN2CODE_TEMPLATE_DIR"); dir && *dir) {
+      return dir;
+    }
+#ifdef _WIN32
+    if (const char *dir = std::getenv("APPDATA"); dir && *dir) {
+      return fs::path(dir) / "SLN2Code" / "templates";
+    }
+#else
+    if (const char *dir = std::getenv("XDG_CONFIG_HOME"); dir && *dir) {
+      return fs::path(dir) / "sln2code" / "templates";
+    }
+    if (const char *home = std::getenv("HOME"); home && *home) {
+      return fs::path(home) / ".config" / "sln2code" / "templates";
+    }
+#endif
+    return {};
+  }
 
-    futures.push_back(std::async(std::launch::async, [&]() {
-      generate_tasks_json(vscode_dir, project_name, compiler);
-    }));
+  static const Template &get(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = cache_.find(name);
+    if (it != cache_.end()) {
+      return *it->second;
+    }
+    return *cache_.emplace(std::string(name), load(name)).first->second;
+  }
 
-    futures.push_back(std::async(std::launch::async, [&]() {
-      generate_launch_json(vscode_dir, project_name, compiler, debugger);
-    }));
+private:
+  static std::mutex mtx_;
+  static fs::path dir_override_;
+  static std::map<std::string, std::unique_ptr<Template>, std::less<>> cache_;
+
+  static std::unique_ptr<Template> load(std::string_view name) {
+    const fs::path dir = template_dir();
+    std::error_code ec;
+    if (!dir.empty()) {
+      const fs::path path = dir / std::string(name);
+      if (fs::is_regular_file(path, ec)) {
+        try {
+          return Template::load(path);
+        } catch (const std::exception &e) {
+          std::cerr << "Ignoring template " << path.string() << ": "
+                    << e.what() << std::endl;
+        }
+      }
+    }
+    const std::string_view *builtin =
+        Constants::PROJECT_TEMPLATES.find(name);
+    if (!builtin) {
+      throw std::runtime_error("Unknown template: " + std::string(name));
+    }
+    return std::make_unique<Template>(*builtin);
+  }
+};
 
-    futures.push_back(std::async(
-        std::launch::async, [&]() { generate_settings_json(vscode_dir); }));
+std::mutex TemplateStore::mtx_;
+fs::path TemplateStore::dir_override_;
+std::map<std::string, std::unique_ptr<Template>, std::less<>>
+    TemplateStore::cache_;
+
+inline std::string Template::render_partial(std::string_view name,
+                                            const TemplateValues &values) {
+  // 限制嵌套深度，防止模板互相插入导致无限递归
+  thread_local int depth = 0;
+  if (depth >= 8) {
+    throw std::runtime_error("template partials nested too deeply: " +
+                             std::string(name));
+  }
+  depth++;
+  try {
+    std::string text = TemplateStore::get(name).render(values);
+    depth--;
+    return text;
+  } catch (...) {
+    depth--;
+    throw;
+  }
+}
 
-    futures.push_back(std::async(std::launch::async, [&]() {
-      generate_cmake_file(project_path, project_name, compiler);
-    }));
+// 项目生成服务
+class ProjectGenerator {
+public:
+  // 一次生成的结果
+  struct Summary {
+    size_t created = 0;
+    size_t updated = 0;
+    size_t unchanged = 0;
+    size_t failed = 0;
+    std::string details; // 有变化的文件，每行一个
+
+    void print() const {
+      std::cout << "\nProject files: " << created << " created, " << updated
+                << " updated, " << unchanged << " unchanged";
+      if (failed > 0) {
+        std::cout << ", " << failed << " failed";
+      }
+      std::cout << "\n" << details;
+    }
+  };
 
-    futures.push_back(std::async(std::launch::async, [&]() {
-      generate_main_cpp(project_path, project_name);
-    }));
+  // 生成项目文件（多线程版本）；启用工作区时生成多目标的CMake工程
+  static Summary generate_project_files(const fs::path &project_path,
+                                        const std::string &project_name,
+                                        const CompilerConfig &compiler,
+                                        const DebuggerConfig &debugger,
+                                        const WorkspaceConfig &workspace = {}) {
+    const fs::path vscode_dir = project_path / ".vscode";
+    Utils::safe_create_directory(vscode_dir);
+    Utils::safe_create_directory(project_path / "cmake");
+
+    // 所有模板共用同一组值，用户模板可以引用其中任意一项
+    const std::vector<std::string> apps =
+        ProjectStructureService::workspace_apps(project_name, workspace);
+    TemplateValues values =
+        project_values(project_name, compiler, debugger, workspace, apps);
+    // 已安装库的主要头文件作为预编译头
+    auto pch = LibraryService::precompiled_headers(project_path);
+    values.set("pch_include_dirs", std::move(pch.include_dirs))
+        .set("pch_headers", std::move(pch.headers));
+
+    // 生成的文件、对应的模板和渲染用的值
+    struct Output {
+      fs::path path;
+      std::string_view name;
+      const TemplateValues *values;
+    };
+    std::vector<Output> outputs = {
+        {vscode_dir / "c_cpp_properties.json", "c_cpp_properties.json",
+         &values},
+        {vscode_dir / "launch.json", "launch.json", &values},
+        {vscode_dir / "settings.json", "settings.json", &values},
+        {project_path / ".gitignore", ".gitignore", &values},
+        {project_path / "cmake" / "BuildProfiles.cmake",
+         "cmake/BuildProfiles.cmake", &values},
+        {project_path / "cmake" / "CompilerCache.cmake",
+         "cmake/CompilerCache.cmake", &values},
+        {project_path / "cmake" / "PrecompiledHeaders.cmake",
+         "cmake/PrecompiledHeaders.cmake", &values},
+    };
+    std::vector<TemplateValues> app_values;
+    if (workspace.enabled) {
+      const fs::path core = project_path / "core";
+      Utils::safe_create_directory(core / "include" / project_name);
+      Utils::safe_create_directory(core / "src");
+      Utils::safe_create_directory(project_path / "tests");
+      Utils::safe_create_directory(project_path / "bench");
+      outputs.insert(
+          outputs.end(),
+          {{vscode_dir / "tasks.json", "workspace/tasks.json", &values},
+           {project_path / "CMakeLists.txt", "workspace/CMakeLists.txt",
+            &values},
+           {core / "include" / project_name / "core.hpp", "workspace/core.hpp",
+            &values},
+           {core / "src" / "core.cpp", "workspace/core.cpp", &values},
+           {project_path / "tests" / "test_core.cpp", "workspace/test.cpp",
+            &values},
+           {project_path / "bench" / "bench_core.cpp", "workspace/bench.cpp",
+            &values}});
+      // 每个程序单独渲染，app_name为程序名
+      app_values.reserve(apps.size());
+      for (const auto &app : apps) {
+        const fs::path app_dir = project_path / "apps" / app;
+        Utils::safe_create_directory(app_dir);
+        app_values.push_back(values);
+        app_values.back().set("app_name", app);
+        outputs.push_back(
+            {app_dir / "main.cpp", "workspace/app.cpp", &app_values.back()});
+      }
+    } else {
+      Utils::safe_create_directory(project_path / "src");
+      outputs.insert(
+          outputs.end(),
+          {{vscode_dir / "tasks.json", "tasks.json", &values},
+           {project_path / "CMakeLists.txt", "CMakeLists.txt", &values},
+           {project_path / "src" / "main.cpp", "main.cpp", &values}});
+    }
 
-    futures.push_back(std::async(std::launch::async,
-                                 [&]() { generate_gitignore(project_path); }));
+    // 并行渲染，只写入内容有变化的文件
+    auto &scheduler = TaskScheduler::instance();
+    std::vector<TaskScheduler::Future<Utils::WriteResult>> futures;
+    for (const auto &output : outputs) {
+      futures.push_back(scheduler.submit([&output]() {
+        try {
+          return Utils::write_if_changed(
+              output.path,
+              TemplateStore::get(output.name).render(*output.values));
+        } catch (const std::exception &e) {
+          std::cerr << "Can't render " << output.path.string() << ": "
+                    << e.what() << std::endl;
+          return Utils::WriteResult::FAILED;
+        }
+      }));
+    }
 
-    // 等待所有任务完成
-    for (auto &future : futures) {
-      future.get();
+    // 等待所有任务完成并汇总
+    Summary summary;
+    std::ostringstream details;
+    for (size_t i = 0; i < futures.size(); i++) {
+      const char *label = nullptr;
+      switch (futures[i].get()) {
+      case Utils::WriteResult::CREATED:
+        summary.created++;
+        label = "created";
+        break;
+      case Utils::WriteResult::UPDATED:
+        summary.updated++;
+        label = "updated";
+        break;
+      case Utils::WriteResult::FAILED:
+        summary.failed++;
+        label = "failed";
+        break;
+      default:
+        summary.unchanged++;
+      }
+      if (label) {
+        details << "  " << std::left << std::setw(9) << label
+                << outputs[i].path.lexically_relative(project_path)
+                       .generic_string()
+                << "\n";
+      }
     }
+    summary.details = details.str();
+    return summary;
   }
 
 private:
-  // 生成c_cpp_properties.json
-  static void generate_c_cpp_properties(const fs::path &vscode_dir,
-                                        const CompilerConfig &compiler) {
-    std::string intelliSenseMode = get_intellisense_mode(compiler.type);
-    std::string compilerPath = Utils::clean_path(compiler.path);
+  // 模板可用的值
+  static TemplateValues project_values(const std::string &project_name,
+                                       const CompilerConfig &compiler,
+                                       const DebuggerConfig &debugger,
+                                       const WorkspaceConfig &workspace,
+                                       const std::vector<std::string> &apps) {
+    const bool msvc = compiler.type == CompilerType::MSVC;
+    std::string debuggerType;
 
-    std::string content = R"({
-    "configurations": [
-        {
-            "name": "Win32",
-            "includePath": [
-                "${workspaceFolder}/**",
-                "${workspaceFolder}/include"
-            ],
-            "defines": [
-                "_DEBUG",
-                "UNICODE",
-                "_UNICODE"
-            ],
-            "compilerPath": ")" +
-                          compilerPath + R"(",
-            "cStandard": ")" +
-                          compiler.cStandard + R"(",
-            "cppStandard": ")" +
-                          compiler.cppStandard + R"(",
-            "intelliSenseMode": ")" +
-                          intelliSenseMode + R"("
-        },
-        {
-            "name": "Linux",
-            "includePath": [
-                "${workspaceFolder}/**",
-                "${workspaceFolder}/include"
-            ],
-            "defines": [],
-            "compilerPath": ")" +
-                          compilerPath + R"(",
-            "cStandard": ")" +
-                          compiler.cStandard + R"(",
-            "cppStandard": ")" +
-                          compiler.cppStandard + R"(",
-            "intelliSenseMode": ")" +
-                          intelliSenseMode + R"("
-        }
-    ],
-    "version": 4
-})";
+    switch (debugger.type) {
+    case DebuggerType::GDB:
+      debuggerType = "gdb";
+      break;
+    case DebuggerType::LLDB:
+      debuggerType = "lldb";
+      break;
+    case DebuggerType::CPPVSDBG:
+      debuggerType = "cppvsdbg";
+      break;
+    default:
+      debuggerType = "cppdbg";
+    }
 
-    Utils::safe_write_file(vscode_dir / "c_cpp_properties.json", content);
+    TemplateValues values;
+    values.set("project_name", project_name)
+        .set("compiler_name", compiler.name)
+        .set("compiler_path", Utils::clean_path(compiler.path))
+        .set("cpp_standard", compiler.cppStandard)
+        .set("cpp_standard_number", compiler.cppStandard.substr(2))
+        .set("c_standard", compiler.cStandard)
+        .set("c_standard_number", compiler.cStandard.substr(1))
+        .set("intellisense_mode", get_intellisense_mode(compiler.type))
+        .set("msvc", msvc)
+        .set("output_ext", msvc ? ".exe" : "")
+        .set("problem_matcher", msvc ? "$msCompile" : "$gcc")
+        .set("has_extra_args", !compiler.extraArgs.empty())
+        .set("extra_args", compiler.extraArgs)
+        .set("debugger_name", debugger.name)
+        .set("debugger_type", debuggerType)
+        .set("debugger_path", Utils::clean_path(debugger.path))
+        .set("workspace", workspace.enabled)
+        .set("include_dir", workspace.enabled ? "core/include" : "include")
+        .set("program_name", workspace.enabled ? apps.front() : project_name);
+
+    // CMake需要C++编译器驱动；选择了C编译器时让CMake自行查找
+    const bool cxx_driver = compiler.type == CompilerType::GXX ||
+                            compiler.type == CompilerType::CLANGXX || msvc;
+    values.set("cmake_cxx_compiler",
+               cxx_driver ? Utils::clean_path(compiler.path) : "");
+
+    // 找到CMake时通过它增量并行构建，否则任务直接调用编译器；工作区总是
+    // 使用CMake
+    const BuildToolConfig &tools = compiler.build_tools;
+    std::string cmake = "cmake";
+    std::string ctest = "ctest";
+    if (!tools.cmake.empty()) {
+      const fs::path cmake_path(Utils::clean_path(tools.cmake));
+      cmake = cmake_path.generic_string();
+      ctest = (cmake_path.parent_path() /
+               ("ctest" + cmake_path.extension().string()))
+                  .generic_string();
+    }
+    values.set("use_cmake", workspace.enabled || !tools.cmake.empty())
+        .set("cmake", cmake)
+        .set("ctest", ctest)
+        .set("cmake_generator", tools.ninja.empty() ? "" : "Ninja");
+
+    // 编译器缓存：检测到时记录工具和所在目录，否则由CMake在配置时查找
+    const CompilerCacheConfig &cache = compiler.cache;
+    const std::string cache_path = Utils::clean_path(cache.path);
+    values
+        .set("compiler_cache", cache.name == "none"   ? std::string("OFF")
+                               : cache.name == "auto" ? std::string("AUTO")
+                                                      : cache.name)
+        .set("compiler_cache_path", cache_path)
+        .set("compiler_cache_hint",
+             fs::path(cache_path).parent_path().generic_string())
+        .set("compiler_cache_dir", Utils::clean_path(cache.dir))
+        .set("compiler_cache_dir_env",
+             cache.name == "sccache" ? "SCCACHE_DIR" : "CCACHE_DIR")
+        .set("compiler_cache_max_size", cache.max_size);
+
+    if (workspace.enabled) {
+      // 核心库的命名空间和CMake选项前缀须是合法标识符
+      std::string identifier = project_name;
+      std::replace(identifier.begin(), identifier.end(), '-', '_');
+      // 关键字、std、main和以下划线开头的全局名字都不能用作命名空间
+      if (identifier.empty() ||
+          std::isdigit(static_cast<unsigned char>(identifier[0])) ||
+          identifier[0] == '_' || identifier == "std" || identifier == "main" ||
+          std::find(std::begin(Constants::CPP_KEYWORDS),
+                    std::end(Constants::CPP_KEYWORDS),
+                    identifier) != std::end(Constants::CPP_KEYWORDS)) {
+        identifier = "ns_" + identifier;
+      }
+      std::string option_prefix = identifier;
+      std::transform(option_prefix.begin(), option_prefix.end(),
+                     option_prefix.begin(),
+                     [](unsigned char c) { return std::toupper(c); });
+
+      // 可单独构建的目标
+      std::vector<std::string> targets = {project_name + "_core"};
+      targets.insert(targets.end(), apps.begin(), apps.end());
+      targets.push_back(project_name + "_tests");
+      targets.push_back(project_name + "_bench");
+
+      values.set("namespace", identifier)
+          .set("option_prefix", option_prefix)
+          .set("apps", apps)
+          .set("targets", targets);
+    }
+    return values;
   }
 
   static std::string get_intellisense_mode(CompilerType type) {
@@ -1896,226 +10249,6 @@ private:
       return platform + "-gcc-" + architecture;
     }
   }
-
-  // 生成tasks.json
-  static void generate_tasks_json(const fs::path &vscode_dir,
-                                  const std::string &project_name,
-                                  const CompilerConfig &compiler) {
-    std::string output_ext =
-        (compiler.type == CompilerType::MSVC) ? ".exe" : "";
-    std::string compilerPath = Utils::clean_path(compiler.path);
-
-    std::string args;
-    if (compiler.type == CompilerType::MSVC) {
-      args =
-          R"(                "/std:)" + compiler.cppStandard.substr(2) + R"(",
-                "/I${workspaceFolder}/include",)";
-    } else {
-      args = R"(                "-std=)" + compiler.cppStandard + R"(",
-                "-I${workspaceFolder}/include",)";
-    }
-
-    // 添加额外编译选项
-    for (const auto &arg : compiler.extraArgs) {
-      args += "\n                \"" + arg + "\",";
-    }
-
-    std::string problemMatcher =
-        (compiler.type == CompilerType::MSVC) ? R"("$msCompile")" : R"("$gcc")";
-
-    std::string content = R"({
-    "version": "2.0.0",
-    "tasks": [
-        {
-            "label": "Build",
-            "type": "shell",
-            "command": ")" +
-                          compilerPath + R"(",
-            "args": [
-)" + args + R"(
-                "${workspaceFolder}/src/*.cpp",
-                "-o",
-                "${workspaceFolder}/build/bin/Debug/)" +
-                          project_name + output_ext + R"("
-            ],
-            "group": {
-                "kind": "build",
-                "isDefault": true
-            },
-            "problemMatcher": [)" +
-                          problemMatcher + R"(],
-            "detail": "Built with )" +
-                          compiler.name + R"("
-        },
-        {
-            "label": "Clean",
-            "type": "shell",
-            "command": "rm",
-            "args": [
-                "-rf",
-                "${workspaceFolder}/build/bin/Debug/*"
-            ]
-        }
-    ]
-})";
-
-    Utils::safe_write_file(vscode_dir / "tasks.json", content);
-  }
-  // 生成launch.json
-  static void generate_launch_json(const fs::path &vscode_dir,
-                                   const std::string &project_name,
-                                   const CompilerConfig &compiler,
-                                   const DebuggerConfig &debugger) {
-    std::string output_ext =
-        (compiler.type == CompilerType::MSVC) ? ".exe" : "";
-    std::string debuggerPath = Utils::clean_path(debugger.path);
-    std::string debuggerType;
-
-    switch (debugger.type) {
-    case DebuggerType::GDB:
-      debuggerType = "gdb";
-      break;
-    case DebuggerType::LLDB:
-      debuggerType = "lldb";
-      break;
-    case DebuggerType::CPPVSDBG:
-      debuggerType = "cppvsdbg";
-      break;
-    default:
-      debuggerType = "cppdbg";
-    }
-
-    std::string content = R"({
-    "version": "0.2.0",
-    "configurations": [
-        {
-            "name": "Debug Launch",
-            "type": "cppdbg",
-            "request": "launch",
-            "program": "${workspaceFolder}/build/bin/Debug/)" +
-                          project_name + output_ext + R"(",
-            "args": [],
-            "stopAtEntry": false,
-            "cwd": "${workspaceFolder}",
-            "environment": [],
-            "externalConsole": true,
-            "MIMode": ")" +
-                          debuggerType + R"(",
-            "miDebuggerPath": ")" +
-                          debuggerPath + R"(",
-            "setupCommands": [
-                {
-                    "description": "Enable pretty-printing for gdb",
-                    "text": "-enable-pretty-printing",
-                    "ignoreFailures": true
-                }
-            ],
-            "preLaunchTask": "Build"
-        }
-    ]
-})";
-
-    Utils::safe_write_file(vscode_dir / "launch.json", content);
-  }
-
-  // 生成settings.json
-  static void generate_settings_json(const fs::path &vscode_dir) {
-    std::string content = R"({
-    "files.associations": {
-        "*.h": "c",
-        "*.hpp": "cpp",
-        "*.ipp": "cpp"
-    },
-    "editor.formatOnSave": true,
-    "C_Cpp.default.configurationProvider": "ms-vscode.cpptools",
-    "explorer.confirmDragAndDrop": false
-})";
-
-    Utils::safe_write_file(vscode_dir / "settings.json", content);
-  }
-
-  // 生成CMakeLists.txt
-  static void generate_cmake_file(const fs::path &project_path,
-                                  const std::string &project_name,
-                                  const CompilerConfig &compiler) {
-    std::string content = "cmake_minimum_required(VERSION 3.20)\n"
-                          "project(" +
-                          project_name +
-                          " VERSION 1.0 LANGUAGES CXX)\n\n"
-                          "set(CMAKE_CXX_STANDARD " +
-                          compiler.cppStandard.substr(2) +
-                          ")\n"
-                          "set(CMAKE_C_STANDARD " +
-                          compiler.cStandard.substr(1) +
-                          ")\n\n"
-                          "include(FetchContent)\n"
-                          "include_directories(include)\n"
-                          "add_executable(" +
-                          project_name +
-                          " src/main.cpp)\n"
-                          "target_include_directories(" +
-                          project_name +
-                          " PUBLIC include)\n"
-                          "install(TARGETS " +
-                          project_name +
-                          " DESTINATION bin)\n"
-                          "install(DIRECTORY include/ DESTINATION include)\n";
-
-    // 添加编译器特定选项
-    if (!compiler.extraArgs.empty()) {
-      content += "\n# Additional compiler flags\n";
-      content += "target_compile_options(" + project_name + " PRIVATE";
-      for (const auto &arg : compiler.extraArgs) {
-        content += " " + arg;
-      }
-      content += ")\n";
-    }
-
-    Utils::safe_write_file(project_path / "CMakeLists.txt", content);
-  }
-
-  // 生成main.cpp
-  static void generate_main_cpp(const fs::path &project_path,
-                                const std::string &project_name) {
-    const fs::path src_dir = project_path / "src";
-    Utils::safe_create_directory(src_dir);
-
-    std::string content = R"(#include <iostream>
-
-int main() {
-    std::cout << "Hello, )" +
-                          project_name + R"(!\n";
-    std::cout << "Project created successfully!\n";
-    return 0;
-}
-)";
-
-    Utils::safe_write_file(src_dir / "main.cpp", content);
-  }
-
-  // 生成.gitignore
-  static void generate_gitignore(const fs::path &project_path) {
-    std::string content = R"(# Build artifacts
-build/
-*.exe
-*.out
-*.o
-*.obj
-
-# Editor files
-.vscode/
-!.vscode/tasks.json
-!.vscode/launch.json
-!.vscode/c_cpp_properties.json
-!.vscode/settings.json
-
-# System files
-.DS_Store
-Thumbs.db
-)";
-
-    Utils::safe_write_file(project_path / ".gitignore", content);
-  }
 };
 void Logo() {
   std::cout << "  ____  _     _   _ ____   ____          _      " << "\n"
@@ -2131,9 +10264,22 @@ public:
     std::string project_name = Constants::DEFAULT_PROJECT_NAME;
     std::string base_path = fs::current_path().string();
     std::vector<std::string> libraries_to_install;
-    std::string library_mirror_url;
+    std::vector<std::string> library_mirrors;
     CompilerConfig compiler;
     DebuggerConfig debugger;
+    unsigned download_jobs = 0;
+    unsigned cpu_jobs = 0;
+    bool use_cache = true;
+    std::string cache_dir;
+    uint64_t cache_max_megabytes = 0;
+    std::optional<std::chrono::seconds> metadata_ttl;
+    bool offline = false;
+    ExtractedStore::LinkMode link_mode = ExtractedStore::LinkMode::NONE;
+    bool selective_extract = false;
+    std::string template_dir;
+    std::string manifest;
+    WorkspaceConfig workspace;
+    CompilerCacheConfig compiler_cache;
     bool show_version = false;
     bool show_help = false;
   };
@@ -2165,17 +10311,24 @@ public:
           throw std::runtime_error("Missing library name after " + arg);
         }
       } else if (arg == "--library-mirror" || arg == "-lm") {
+        // 可重复指定或用逗号分隔多个镜像
         if (i + 1 < argc) {
-          options.library_mirror_url = argv[++i];
+          std::istringstream mirrors(argv[++i]);
+          std::string mirror;
+          while (std::getline(mirrors, mirror, ',')) {
+            mirror = Utils::trim(mirror);
+            if (!mirror.empty()) {
+              options.library_mirrors.push_back(mirror);
+            }
+          }
         } else {
           throw std::runtime_error("Missing mirror URL after " + arg);
         }
       } else if (arg == "-c" || arg == "--compiler") {
         if (i + 1 < argc) {
           std::string compiler_name = argv[++i];
-          auto it = Constants::COMPILER_TYPE_MAP.find(compiler_name);
-          if (it != Constants::COMPILER_TYPE_MAP.end()) {
-            options.compiler.type = it->second;
+          if (auto type = Constants::COMPILER_TYPE_MAP.find(compiler_name)) {
+            options.compiler.type = *type;
             options.compiler.name = compiler_name;
           }
         } else {
@@ -2202,9 +10355,8 @@ public:
       } else if (arg == "-d" || arg == "--debugger") {
         if (i + 1 < argc) {
           std::string debugger_name = argv[++i];
-          auto it = Constants::DEBUGGER_TYPE_MAP.find(debugger_name);
-          if (it != Constants::DEBUGGER_TYPE_MAP.end()) {
-            options.debugger.type = it->second;
+          if (auto type = Constants::DEBUGGER_TYPE_MAP.find(debugger_name)) {
+            options.debugger.type = *type;
             options.debugger.name = debugger_name;
           }
         } else {
@@ -2227,6 +10379,116 @@ public:
         } else {
           throw std::runtime_error("Missing extra arguments after " + arg);
         }
+      } else if (arg == "-jd" || arg == "--download-jobs") {
+        if (i + 1 < argc) {
+          options.download_jobs =
+              static_cast<unsigned>(parse_positive_count(argv[++i], arg));
+        } else {
+          throw std::runtime_error("Missing job count after " + arg);
+        }
+      } else if (arg == "-jc" || arg == "--cpu-jobs") {
+        if (i + 1 < argc) {
+          options.cpu_jobs =
+              static_cast<unsigned>(parse_positive_count(argv[++i], arg));
+        } else {
+          throw std::runtime_error("Missing job count after " + arg);
+        }
+      } else if (arg == "--no-cache") {
+        options.use_cache = false;
+      } else if (arg == "--cache-dir") {
+        if (i + 1 < argc) {
+          options.cache_dir = Utils::clean_path(argv[++i]);
+        } else {
+          throw std::runtime_error("Missing cache directory after " + arg);
+        }
+      } else if (arg == "--cache-max-size") {
+        if (i + 1 < argc) {
+          // 换算为字节时不能溢出
+          options.cache_max_megabytes = parse_positive_count(
+              argv[++i], arg, std::numeric_limits<uint64_t>::max() >> 20);
+        } else {
+          throw std::runtime_error("Missing cache size after " + arg);
+        }
+      } else if (arg == "--metadata-ttl") {
+        if (i + 1 < argc) {
+          std::string value = argv[++i];
+          try {
+            long long seconds = std::stoll(value);
+            if (seconds < 0) {
+              throw std::out_of_range(value);
+            }
+            options.metadata_ttl = std::chrono::seconds(seconds);
+          } catch (...) {
+            throw std::runtime_error("Invalid number after " + arg + ": " +
+                                     value);
+          }
+        } else {
+          throw std::runtime_error("Missing TTL after " + arg);
+        }
+      } else if (arg == "--offline") {
+        options.offline = true;
+      } else if (arg == "--manifest") {
+        if (i + 1 < argc) {
+          options.manifest = Utils::clean_path(argv[++i]);
+        } else {
+          throw std::runtime_error("Missing manifest path after " + arg);
+        }
+      } else if (arg == "--compiler-cache") {
+        if (i + 1 < argc) {
+          std::string tool = argv[++i];
+          if (tool != "auto" && tool != "ccache" && tool != "sccache" &&
+              tool != "none") {
+            throw std::runtime_error("Unknown compiler cache: " + tool);
+          }
+          options.compiler_cache.name = tool;
+        } else {
+          throw std::runtime_error("Missing compiler cache after " + arg);
+        }
+      } else if (arg == "--compiler-cache-dir") {
+        if (i + 1 < argc) {
+          options.compiler_cache.dir = Utils::clean_path(argv[++i]);
+        } else {
+          throw std::runtime_error("Missing directory after " + arg);
+        }
+      } else if (arg == "--compiler-cache-size") {
+        if (i + 1 < argc) {
+          options.compiler_cache.max_size = argv[++i];
+          if (!CompilerService::valid_cache_size(
+                  options.compiler_cache.max_size)) {
+            throw std::runtime_error("Invalid cache size after " + arg + ": " +
+                                     options.compiler_cache.max_size);
+          }
+        } else {
+          throw std::runtime_error("Missing size after " + arg);
+        }
+      } else if (arg == "--workspace") {
+        options.workspace.enabled = true;
+      } else if (arg == "--app") {
+        if (i + 1 < argc) {
+          options.workspace.enabled = true;
+          options.workspace.apps.push_back(Utils::get_valid_name(argv[++i]));
+        } else {
+          throw std::runtime_error("Missing application name after " + arg);
+        }
+      } else if (arg == "--template-dir") {
+        if (i + 1 < argc) {
+          options.template_dir = Utils::clean_path(argv[++i]);
+        } else {
+          throw std::runtime_error("Missing template directory after " + arg);
+        }
+      } else if (arg == "--selective-extract") {
+        options.selective_extract = true;
+      } else if (arg == "--link-mode") {
+        if (i + 1 < argc) {
+          auto mode = ExtractedStore::parse_link_mode(argv[++i]);
+          if (!mode) {
+            throw std::runtime_error("Unknown link mode: " +
+                                     std::string(argv[i]));
+          }
+          options.link_mode = *mode;
+        } else {
+          throw std::runtime_error("Missing link mode after " + arg);
+        }
       } else if (arg == "--help" || arg == "-h") {
         options.show_help = true;
       } else {
@@ -2237,6 +10499,19 @@ public:
     return options;
   }
 
+  // 整个参数必须是不超过max的正整数，"4abc"、"+4"、" 4"均不接受
+  static uint64_t
+  parse_positive_count(const std::string &value, const std::string &arg,
+                       uint64_t max = std::numeric_limits<unsigned>::max()) {
+    uint64_t count = 0;
+    const char *end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, count);
+    if (ec == std::errc() && ptr == end && count > 0 && count <= max) {
+      return count;
+    }
+    throw std::runtime_error("Invalid number after " + arg + ": " + value);
+  }
+
   static void print_help(const std::string &program_name) {
     std::cout
         << "Usage: " << program_name << " [options]\n"
@@ -2244,7 +10519,8 @@ public:
         << "  -n, --name NAME           Set project name\n"
         << "  -p, --path PATH           Set project path\n"
         << "  -I, --install LIB         Install third-party library\n"
-        << "  -lm, --library-mirror URL Use custom library mirror\n"
+        << "  -lm, --library-mirror URL Use custom library mirror (repeatable "
+           "or comma-separated; requests are raced across mirrors)\n"
         << "  -c, --compiler COMPILER    Set compiler (gcc, clang, cl)\n"
         << "  -cp, --compiler-path PATH   Set compiler path\n"
         << "  -cppstd, --cpp-standard STD     Set C++ standard (c++98 c++11 "
@@ -2253,6 +10529,42 @@ public:
         << "  -d, --debugger DEBUGGER    Set debugger (gdb, lldb)\n"
         << "  -dp, --debugger-path PATH   Set debugger path\n"
         << "  -ea, --extra-args ARGS      Set additional compiler flags\n"
+        << "  -jd, --download-jobs N      Max concurrent library downloads "
+           "(default 4)\n"
+        << "  -jc, --cpu-jobs N           Worker threads for generation, "
+           "hashing and extraction (default: CPU cores)\n"
+        << "  --cache-dir DIR             Shared archive cache directory\n"
+        << "  --cache-max-size MB         Size cap of the archive cache and, "
+           "separately, of\n"
+        << "                              extracted libraries (default 4096)\n"
+        << "  --no-cache                  Always download archives\n"
+        << "  --metadata-ttl SECONDS      Reuse cached mirror metadata without "
+           "revalidation (default 86400)\n"
+        << "  --offline                   Use cached mirror metadata only, "
+           "even if stale\n"
+        << "  --link-mode MODE            Share extracted libraries across "
+           "projects\n"
+        << "                              (none auto reflink hardlink "
+           "symlink copy)\n"
+        << "  --selective-extract         Only extract the include/lib "
+           "subtrees of libraries\n"
+        << "  --manifest FILE             Create every project listed in a "
+           "JSON manifest\n"
+        << "                              concurrently (non-interactive)\n"
+        << "  --template-dir DIR          Override generated files with "
+           "templates from DIR\n"
+        << "  --compiler-cache TOOL       Compiler cache for generated "
+           "projects\n"
+        << "                              (auto ccache sccache none, "
+           "default auto)\n"
+        << "  --compiler-cache-dir DIR    Cache directory used by generated "
+           "projects\n"
+        << "  --compiler-cache-size SIZE  Cache size limit, e.g. 5G\n"
+        << "  --workspace                 Generate a multi-target CMake "
+           "workspace (core\n"
+        << "                              library, apps, tests, benches)\n"
+        << "  --app NAME                  Add an application to the workspace "
+           "(repeatable)\n"
         << "  -v, --version             Output the version of the program\n"
         << "  -h, --help                Show this help message\n";
   }
@@ -2269,6 +10581,341 @@ public:
   }
 };
 
+// 批量生成：按清单并发创建多个项目。所有项目共享任务调度器、库下载（按摘要
+// 去重）、压缩包缓存和模板缓存，总耗时接近最慢的单个项目；结束后输出每个
+// 项目的结果。批量模式不做任何交互，未指定的编译器和调试器路径自动查找
+class BatchService {
+public:
+  // 清单中的一个项目；未给出的字段取默认值（命令行选项和清单的defaults）
+  struct ProjectSpec {
+    std::string name;
+    fs::path base_path;
+    CompilerConfig compiler;
+    DebuggerConfig debugger;
+    std::vector<std::string> libraries;
+    WorkspaceConfig workspace;
+  };
+
+  struct ProjectResult {
+    std::string name;
+    fs::path path;
+    bool ok = false;
+    std::string error;
+    LibraryService::InstallReport libraries;
+    ProjectGenerator::Summary files;
+    double seconds = 0;
+  };
+
+  // 读取JSON清单：{"defaults": {...}, "projects": [{...}, ...]}，或直接是
+  // 项目数组。相对路径相对于清单所在目录
+  static std::vector<ProjectSpec> load_manifest(const fs::path &manifest,
+                                                const ProjectSpec &defaults) {
+    std::ifstream file(manifest, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Can't open manifest: " + manifest.string());
+    }
+    std::string text((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+    std::string error;
+    auto doc = JsonDocument::parse(std::move(text), &error);
+    if (!doc) {
+      throw std::runtime_error("Invalid manifest " + manifest.string() + ": " +
+                               error);
+    }
+
+    const fs::path manifest_dir = fs::absolute(manifest).parent_path();
+    JsonValue root = doc->root();
+    JsonValue projects = root.is_array() ? root : root["projects"];
+    if (!projects.is_array() || projects.size() == 0) {
+      throw std::runtime_error("Manifest lists no projects: " +
+                               manifest.string());
+    }
+
+    ProjectSpec base = defaults;
+    if (root.is_object()) {
+      apply(root["defaults"], manifest_dir, base);
+    }
+
+    std::vector<ProjectSpec> specs;
+    std::set<std::string> targets;
+    projects.for_each_element([&](JsonValue project) {
+      ProjectSpec spec = base;
+      spec.name.clear();
+      apply(project, manifest_dir, spec);
+      if (spec.name.empty()) {
+        throw std::runtime_error("Manifest project #" +
+                                 std::to_string(specs.size() + 1) +
+                                 " has no name");
+      }
+      const std::string target =
+          (spec.base_path / spec.name).lexically_normal().generic_string();
+      if (!targets.insert(target).second) {
+        throw std::runtime_error("Manifest lists " + target + " twice");
+      }
+      specs.push_back(std::move(spec));
+    });
+    return specs;
+  }
+
+  // 并发创建清单中的全部项目，全部成功时返回0
+  static int run(const fs::path &manifest, const ProjectSpec &defaults) {
+    const auto specs = load_manifest(manifest, defaults);
+    std::cout << "Creating " << specs.size() << " projects from "
+              << manifest.string() << "\n";
+
+    // 项目任务大部分时间在等待下载，放在阻塞线程上；
+    // 生成、校验和解压仍由它们提交到CPU工作线程
+    const auto start = std::chrono::steady_clock::now();
+    auto &scheduler = TaskScheduler::instance();
+    std::vector<TaskScheduler::Future<ProjectResult>> futures;
+    for (const auto &spec : specs) {
+      futures.push_back(
+          scheduler.submit_blocking([&spec] { return create(spec); }));
+    }
+    std::vector<ProjectResult> results;
+    for (auto &future : futures) {
+      results.push_back(future.get());
+    }
+
+    print_report(results, std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+    return std::all_of(results.begin(), results.end(),
+                       [](const ProjectResult &r) { return r.ok; })
+               ? 0
+               : 1;
+  }
+
+private:
+  // 字符串列表可以是数组，也可以是以sep分隔的字符串
+  static std::vector<std::string> list(JsonValue value, char sep) {
+    std::vector<std::string> items;
+    auto add = [&items](std::string item) {
+      item = Utils::trim(item);
+      if (!item.empty()) {
+        items.push_back(std::move(item));
+      }
+    };
+    if (value.is_array()) {
+      value.for_each_element(
+          [&](JsonValue item) { add(std::string(item.as_string())); });
+    } else if (sep == ' ') {
+      std::istringstream stream{std::string(value.as_string())};
+      std::string item;
+      while (stream >> item) {
+        add(item);
+      }
+    } else {
+      std::istringstream stream{std::string(value.as_string())};
+      std::string item;
+      while (std::getline(stream, item, sep)) {
+        add(item);
+      }
+    }
+    return items;
+  }
+
+  // 把清单对象中出现的字段覆盖到spec上
+  static void apply(JsonValue value, const fs::path &manifest_dir,
+                    ProjectSpec &spec) {
+    if (!value.is_object()) {
+      return;
+    }
+    auto text = [&value](std::string_view key) -> std::optional<std::string> {
+      JsonValue field = value[key];
+      if (!field.is_string()) {
+        return std::nullopt;
+      }
+      return std::string(field.as_string());
+    };
+
+    if (auto name = text("name")) {
+      spec.name = Utils::get_valid_name(*name);
+    }
+    if (auto path = text("path")) {
+      fs::path base(Utils::clean_path(*path));
+      spec.base_path = base.is_absolute() ? base : manifest_dir / base;
+    }
+    if (auto compiler = text("compiler")) {
+      auto type = Constants::COMPILER_TYPE_MAP.find(*compiler);
+      if (!type) {
+        throw std::runtime_error("Unknown compiler in manifest: " + *compiler);
+      }
+      spec.compiler.type = *type;
+      spec.compiler.name = *compiler;
+      spec.compiler.path.clear();
+    }
+    if (auto path = text("compilerPath")) {
+      spec.compiler.path = Utils::clean_path(*path);
+    }
+    if (auto standard = text("cppStandard")) {
+      spec.compiler.cppStandard = *standard;
+    }
+    if (auto standard = text("cStandard")) {
+      spec.compiler.cStandard = *standard;
+    }
+    if (value["extraArgs"].valid()) {
+      spec.compiler.extraArgs = list(value["extraArgs"], ' ');
+    }
+    if (auto tool = text("compilerCache")) {
+      if (*tool != "auto" && *tool != "ccache" && *tool != "sccache" &&
+          *tool != "none") {
+        throw std::runtime_error("Unknown compiler cache in manifest: " +
+                                 *tool);
+      }
+      spec.compiler.cache.name = *tool;
+      spec.compiler.cache.path.clear();
+    }
+    if (auto dir = text("compilerCacheDir")) {
+      fs::path cache_dir(Utils::clean_path(*dir));
+      spec.compiler.cache.dir =
+          (cache_dir.is_absolute() ? cache_dir : manifest_dir / cache_dir)
+              .generic_string();
+    }
+    if (auto size = text("compilerCacheSize")) {
+      if (!CompilerService::valid_cache_size(*size)) {
+        throw std::runtime_error("Invalid compilerCacheSize in manifest: " +
+                                 *size);
+      }
+      spec.compiler.cache.max_size = *size;
+    }
+    if (auto debugger = text("debugger")) {
+      auto type = Constants::DEBUGGER_TYPE_MAP.find(*debugger);
+      if (!type) {
+        throw std::runtime_error("Unknown debugger in manifest: " + *debugger);
+      }
+      spec.debugger.type = *type;
+      spec.debugger.name = *debugger;
+      spec.debugger.path.clear();
+    }
+    if (auto path = text("debuggerPath")) {
+      spec.debugger.path = Utils::clean_path(*path);
+    }
+    if (value["libraries"].valid()) {
+      spec.libraries = list(value["libraries"], ',');
+    }
+    if (value["workspace"].valid()) {
+      spec.workspace.enabled = value["workspace"].as_bool();
+    }
+    if (value["apps"].valid()) {
+      spec.workspace.apps.clear();
+      for (const auto &app : list(value["apps"], ',')) {
+        spec.workspace.apps.push_back(Utils::get_valid_name(app));
+      }
+      spec.workspace.enabled = !spec.workspace.apps.empty();
+    }
+  }
+
+  static ProjectResult create(ProjectSpec spec) {
+    const auto start = std::chrono::steady_clock::now();
+    ProjectResult result;
+    result.name = spec.name;
+    result.path = spec.base_path / spec.name;
+    try {
+      spec.workspace.apps =
+          ProjectStructureService::check_apps(spec.name, spec.workspace.apps);
+      // 与交互模式的默认选择一致
+      CompilerConfig &compiler = spec.compiler;
+      if (compiler.name.empty()) {
+        compiler.type = CompilerType::GXX;
+        compiler.name = "g++";
+      }
+      if (compiler.path.empty()) {
+        compiler.path = CompilerService::locate_compiler(compiler);
+      }
+      if (compiler.path.empty()) {
+        compiler.path = compiler.name; // 构建时从PATH查找
+      }
+      if (compiler.cppStandard.empty()) {
+        compiler.cppStandard = "c++17";
+      }
+      if (compiler.cStandard.empty()) {
+        compiler.cStandard = "c17";
+      }
+      if (compiler.cache.path.empty()) {
+        CompilerService::detect_compiler_cache(compiler.cache);
+      }
+      CompilerService::detect_build_tools(compiler.build_tools);
+      DebuggerConfig &debugger = spec.debugger;
+      if (debugger.name.empty()) {
+        debugger.type = DebuggerType::GDB;
+        debugger.name = "gdb";
+      }
+      if (debugger.path.empty()) {
+        debugger.path = DebuggerService::locate_debugger(debugger);
+      }
+
+      if (!ProjectStructureService::create_directory_recursive(
+              spec.base_path,
+              ProjectStructureService::get_project_structure(
+                  spec.name, spec.workspace))) {
+        throw std::runtime_error("failed to create project directories");
+      }
+      if (!spec.libraries.empty()) {
+        result.libraries =
+            LibraryService::install_libraries(result.path, spec.libraries);
+      }
+      result.files = ProjectGenerator::generate_project_files(
+          result.path, spec.name, compiler, debugger, spec.workspace);
+      result.ok = result.libraries.failed.empty() && result.files.failed == 0;
+    } catch (const std::exception &e) {
+      result.error = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    return result;
+  }
+
+  static void print_report(const std::vector<ProjectResult> &results,
+                           double seconds) {
+    size_t name_width = 4;
+    size_t failed = 0;
+    for (const auto &result : results) {
+      name_width = std::max(name_width, result.name.size());
+      failed += result.ok ? 0 : 1;
+    }
+
+    std::cout << "\n=== Batch Report ===\n"
+              << std::left << std::setw(8) << "STATUS"
+              << std::setw(static_cast<int>(name_width) + 2) << "NAME"
+              << std::setw(9) << "TIME"
+              << "RESULT\n";
+    for (const auto &result : results) {
+      std::ostringstream time;
+      time << std::fixed << std::setprecision(2) << result.seconds << "s";
+      std::cout << std::left << std::setw(8) << (result.ok ? "ok" : "FAILED")
+                << std::setw(static_cast<int>(name_width) + 2) << result.name
+                << std::setw(9) << time.str();
+      if (!result.error.empty()) {
+        std::cout << "error: " << result.error << "\n";
+        continue;
+      }
+      std::cout << "files " << result.files.created << " created, "
+                << result.files.updated << " updated, "
+                << result.files.unchanged << " unchanged";
+      if (result.files.failed > 0) {
+        std::cout << ", " << result.files.failed << " failed";
+      }
+      if (!result.libraries.installed.empty() ||
+          !result.libraries.failed.empty()) {
+        std::cout << "; libraries " << result.libraries.installed.size()
+                  << " installed";
+      }
+      if (!result.libraries.failed.empty()) {
+        std::cout << ", failed:";
+        for (const auto &name : result.libraries.failed) {
+          std::cout << " " << name;
+        }
+      }
+      std::cout << "\n";
+    }
+    std::cout << results.size() - failed << " of " << results.size()
+              << " projects created in " << std::fixed << std::setprecision(2)
+              << seconds << "s\n";
+  }
+};
+
 int main(int argc, char *argv[]) {
   try {
     // 解析命令行参数
@@ -2284,17 +10931,39 @@ int main(int argc, char *argv[]) {
       return 0;
     }
 
+    // 缓存配置需在提供者首次访问元数据之前完成
+    ArchiveCache::configure(options.use_cache, options.cache_dir,
+                            options.cache_max_megabytes);
+    MetadataCache::configure(options.metadata_ttl, options.offline);
+    TemplateStore::configure(options.template_dir);
+    // 调度器线程数需在首个任务提交之前确定
+    LibraryService::set_concurrency(options.download_jobs, options.cpu_jobs);
+    ExtractedStore::set_link_mode(options.link_mode);
+    LibraryService::set_selective_extraction(options.selective_extract);
+
     // 配置库信息提供者
-    if (!options.library_mirror_url.empty()) {
-      LibraryService::set_provider(
-          std::make_unique<RemoteLibraryProvider>(options.library_mirror_url));
-      std::cout << "Using library mirror: " << options.library_mirror_url
-                << "\n";
+    if (!options.library_mirrors.empty()) {
+      auto provider =
+          std::make_unique<RemoteLibraryProvider>(options.library_mirrors);
+      std::cout << "Using " << provider->get_provider_name() << "\n";
+      LibraryService::set_provider(std::move(provider));
     } else {
       // 使用默认提供者
       LibraryService::set_provider(std::make_unique<BuiltinLibraryProvider>());
     }
 
+    // 批量模式：命令行中的编译器、调试器、路径和库作为清单的默认值
+    if (!options.manifest.empty()) {
+      BatchService::ProjectSpec defaults;
+      defaults.base_path = options.base_path;
+      defaults.compiler = options.compiler;
+      defaults.compiler.cache = options.compiler_cache;
+      defaults.debugger = options.debugger;
+      defaults.libraries = options.libraries_to_install;
+      defaults.workspace = options.workspace;
+      return BatchService::run(options.manifest, defaults);
+    }
+
     // 交互式输入（如果没有通过命令行指定）
     if (options.project_name == Constants::DEFAULT_PROJECT_NAME) {
       Logo();
@@ -2322,6 +10991,9 @@ int main(int argc, char *argv[]) {
       }
     }
 
+    options.workspace.apps = ProjectStructureService::check_apps(
+        options.project_name, options.workspace.apps);
+
     // 获取完整的项目路径
     const fs::path project_full_path =
         fs::path(options.base_path) / options.project_name;
@@ -2352,6 +11024,30 @@ int main(int argc, char *argv[]) {
                 << options.compiler.path << ")\n";
     }
 
+    // 查找编译器缓存
+    options.compiler.cache = options.compiler_cache;
+    CompilerService::detect_compiler_cache(options.compiler.cache);
+    if (!options.compiler.cache.path.empty()) {
+      std::cout << "Compiler cache: " << options.compiler.cache.name << " ("
+                << options.compiler.cache.path << ")\n";
+    } else if (options.compiler.cache.name != "none") {
+      std::cout << "Compiler cache: not found (CMake looks again when "
+                   "configuring)\n";
+    }
+
+    // 查找CMake和Ninja，决定构建任务的形式
+    CompilerService::detect_build_tools(options.compiler.build_tools);
+    const BuildToolConfig &build_tools = options.compiler.build_tools;
+    if (build_tools.cmake.empty()) {
+      std::cout << "Build: direct compiler call (CMake not found)\n";
+    } else if (build_tools.ninja.empty()) {
+      std::cout << "Build: CMake (" << build_tools.cmake
+                << "), Ninja not found\n";
+    } else {
+      std::cout << "Build: CMake (" << build_tools.cmake << ") + Ninja ("
+                << build_tools.ninja << ")\n";
+    }
+
     // 获取调试器配置（如果没有通过命令行指定）
     if (options.debugger.name.empty()) {
       options.debugger = DebuggerService::get_debugger_config();
@@ -2365,7 +11061,8 @@ int main(int argc, char *argv[]) {
 
     // 创建项目目录结构
     DirectoryNode project_structure =
-        ProjectStructureService::get_project_structure(options.project_name);
+        ProjectStructureService::get_project_structure(options.project_name,
+                                                       options.workspace);
     bool success = ProjectStructureService::create_directory_recursive(
         options.base_path, project_structure);
 
@@ -2376,9 +11073,8 @@ int main(int argc, char *argv[]) {
 
     // 处理命令行指定的库安装
     if (!options.libraries_to_install.empty()) {
-      for (const auto &lib_name : options.libraries_to_install) {
-        LibraryService::add_third_party_library(project_full_path, lib_name);
-      }
+      LibraryService::install_libraries(project_full_path,
+                                        options.libraries_to_install);
     } else {
       LibraryService::offer_library_installation(project_full_path);
     }
@@ -2386,7 +11082,8 @@ int main(int argc, char *argv[]) {
     // 生成基础文件
     ProjectGenerator::generate_project_files(
         project_full_path, options.project_name, options.compiler,
-        options.debugger);
+        options.debugger, options.workspace)
+        .print();
 
     std::cout << "\nProject \"" << options.project_name
               << "\" created successfully!\n";
@@ -0,0 +1,184 @@
+// HttpClient的libcurl传输路径（https使用的路径）的测试：本地回环服务器不支持
+// TLS，因此让http也经libcurl传输，验证连接复用、重定向、批量请求和取消
+#define main sln2code_main
+#include "main.cpp"
+#undef main
+
+#include "loopback_server.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+const std::string kBlob = make_blob(256 * 1024);
+const std::string kLarge = make_blob(9 * 1024 * 1024 + 777, 5);
+const std::string kChunked = make_blob(100, 2);
+std::atomic<unsigned> range_requests{0};
+
+void handle(const LoopbackRequest &request, LoopbackReply &reply) {
+  const std::string &target = request.target;
+  if (target == "/hello") {
+    reply.body = "hello";
+  } else if (target == "/redirect") {
+    reply.status = 302;
+    reply.headers.push_back({"Location", "/hello"});
+    reply.body = "moved";
+  } else if (target == "/chunked") {
+    reply.chunked = true;
+    reply.body = kChunked;
+  } else if (target == "/blob") {
+    reply.body = kBlob;
+  } else if (target == "/large" || target == "/throttled") {
+    if (!request.header("range").empty()) {
+      range_requests++;
+    }
+    LoopbackServer::serve(kLarge, request, reply);
+    if (target == "/throttled") {
+      reply.rate = 8 * 1024 * 1024;
+    }
+  } else if (target == "/changing") {
+    // 只有探测请求得到206，之后的分段得到200（文件已变化）
+    LoopbackServer::serve(kLarge, request, reply,
+                          request.header("range") == "bytes=0-0");
+  } else if (target == "/slow") {
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    reply.body = "late";
+  } else if (target.rfind("/item/", 0) == 0) {
+    reply.body = "item " + target.substr(6);
+  } else {
+    reply.status = 404;
+    reply.body = "not found";
+  }
+}
+
+void test_get_and_reuse() {
+  LoopbackServer server(handle);
+  for (int i = 0; i < 3; i++) {
+    auto response = HttpClient::instance().get(server.url("/hello"));
+    CHECK(response.ok());
+    CHECK(response.body == "hello");
+  }
+  auto missing = HttpClient::instance().get(server.url("/missing"));
+  CHECK(missing.error.empty());
+  CHECK(missing.status == 404);
+  CHECK(missing.body == "not found");
+  // multi句柄的连接池在请求之间复用同一连接
+  CHECK(server.requests() == 4);
+  CHECK(server.connections() == 1);
+}
+
+void test_redirect_and_chunked() {
+  LoopbackServer server(handle);
+  auto response = HttpClient::instance().get(server.url("/redirect"));
+  CHECK(response.ok());
+  CHECK(response.body == "hello");
+  CHECK(response.final_url == server.url("/hello"));
+
+  auto chunked = HttpClient::instance().get(server.url("/chunked"));
+  CHECK(chunked.body == kChunked);
+  CHECK(server.connections() == 1);
+}
+
+void test_download(const fs::path &dir) {
+  LoopbackServer server(handle);
+  auto response = HttpClient::instance().download(
+      server.url("/blob"), dir / "blob.bin", {}, [](uint64_t, uint64_t) {});
+  CHECK(response.ok());
+  CHECK(read_file(dir / "blob.bin") == kBlob);
+
+  write_file(dir / "missing.bin", "stale");
+  auto missing = HttpClient::instance().download(
+      server.url("/missing"), dir / "missing.bin", {},
+      [](uint64_t, uint64_t) {});
+  CHECK(missing.status == 404);
+  CHECK(!fs::exists(dir / "missing.bin"));
+
+  // 大文件按Range分段下载：探测请求加上各段
+  auto large = HttpClient::instance().download_segmented(
+      server.url("/large"), dir / "large.bin", [](uint64_t, uint64_t) {}, 4);
+  CHECK(large.ok());
+  CHECK(read_file(dir / "large.bin") == kLarge);
+  CHECK(range_requests > 4);
+
+  // 分段得到200时不拼接混合内容，并清理部分文件
+  auto changed = HttpClient::instance().download_segmented(
+      server.url("/changing"), dir / "changed.bin", [](uint64_t, uint64_t) {},
+      4);
+  CHECK(!changed.ok());
+  CHECK(!fs::exists(dir / "changed.bin"));
+  CHECK(!fs::exists(dir / "changed.bin.part"));
+  CHECK(!fs::exists(dir / "changed.bin.part.state"));
+}
+
+// https的分段下载同样经libcurl：各段并发传输，单个连接限速时明显更快
+void test_segmented_throughput(const fs::path &dir) {
+  LoopbackServer server(handle);
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  auto single = HttpClient::instance().download(
+      server.url("/throttled"), dir / "single.bin", {},
+      [](uint64_t, uint64_t) {});
+  const auto single_time = Clock::now() - start;
+  start = Clock::now();
+  auto segmented = HttpClient::instance().download_segmented(
+      server.url("/throttled"), dir / "parallel.bin",
+      [](uint64_t, uint64_t) {}, 4);
+  const auto segmented_time = Clock::now() - start;
+  CHECK(single.ok());
+  CHECK(segmented.ok());
+  CHECK(read_file(dir / "parallel.bin") == kLarge);
+  CHECK(segmented_time < single_time * 6 / 10);
+}
+
+void test_get_many() {
+  LoopbackServer server(handle);
+  std::vector<std::string> urls;
+  for (int i = 0; i < 6; i++) {
+    urls.push_back(server.url("/item/" + std::to_string(i)));
+  }
+  urls.push_back(server.url("/redirect"));
+  auto responses = HttpClient::instance().get_many(urls);
+  CHECK(responses.size() == urls.size());
+  for (int i = 0; i < 6; i++) {
+    CHECK(responses[i].ok());
+    CHECK(responses[i].body == "item " + std::to_string(i));
+  }
+  CHECK(responses[6].body == "hello");
+  // 批量中的重定向回退为普通请求：/redirect再加上跟随的/hello
+  CHECK(server.requests() == 9);
+}
+
+void test_cancel() {
+  LoopbackServer server(handle);
+  auto token = std::make_shared<CancellationToken>();
+  std::thread canceller([token] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    token->cancel();
+  });
+  auto start = std::chrono::steady_clock::now();
+  HttpClient::Response response;
+  {
+    CancellationToken::Scope scope(token);
+    response = HttpClient::instance().get(server.url("/slow"));
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  canceller.join();
+  CHECK(response.error == "cancelled");
+  CHECK(elapsed < std::chrono::milliseconds(1500));
+}
+
+} // namespace
+
+int main() {
+  HttpClient::use_libcurl_for_http(true);
+  TempDir dir("sln2code-curl-test");
+  test_get_and_reuse();
+  test_redirect_and_chunked();
+  test_download(dir.path());
+  test_segmented_throughput(dir.path());
+  test_get_many();
+  test_cancel();
+  if (test_failures() == 0) {
+    std::cout << "curl_transport_test: all checks passed" << std::endl;
+  }
+  return test_failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+// HttpClient与SafeCommandExecutor下载路径的测试：使用本地回环HTTP/1.1服务器，
+// 未链接libcurl时https回退到curl命令，通过PATH中的假curl验证
+#define main sln2code_main
+#include "main.cpp"
+#undef main
+
+#include "loopback_server.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+const std::string kBlob = make_blob(256 * 1024);
+const std::string kChunked = make_blob(100, 2);
+
+void handle(const LoopbackRequest &request, LoopbackReply &reply,
+            unsigned port) {
+  const std::string &target = request.target;
+  if (target == "/hello") {
+    reply.body = "hello";
+  } else if (target == "/redirect") {
+    reply.status = 302;
+    reply.headers.push_back({"Location", "/hello"});
+    reply.body = "moved";
+  } else if (target == "/redirect-twice") {
+    reply.status = 301;
+    reply.headers.push_back(
+        {"Location", "http://127.0.0.1:" + std::to_string(port) + "/redirect"});
+  } else if (target == "/chunked") {
+    reply.chunked = true;
+    reply.body = kChunked;
+  } else if (target == "/blob") {
+    reply.body = kBlob;
+  } else if (target.rfind("/item/", 0) == 0) {
+    reply.body = "item " + target.substr(6);
+  } else if (target == "/secure") {
+    reply.status = 302;
+    reply.headers.push_back({"Location", "https://127.0.0.1:" +
+                                             std::to_string(port) +
+                                             "/secure-file"});
+  } else {
+    reply.status = 404;
+    reply.body = "not found";
+  }
+}
+
+// 每个用例使用新的服务器，连接数不受连接池中已有连接影响
+struct Fixture {
+  std::unique_ptr<LoopbackServer> server;
+  Fixture() {
+    auto *self = this;
+    server = std::make_unique<LoopbackServer>(
+        [self](const LoopbackRequest &request, LoopbackReply &reply) {
+          handle(request, reply, self->server->port());
+        });
+  }
+};
+
+void test_get() {
+  Fixture f;
+  auto response = HttpClient::instance().get(f.server->url("/hello"));
+  CHECK(response.ok());
+  CHECK(response.status == 200);
+  CHECK(response.body == "hello");
+
+  auto missing = HttpClient::instance().get(f.server->url("/missing"));
+  CHECK(missing.error.empty());
+  CHECK(missing.status == 404);
+  CHECK(!missing.ok());
+
+  // 控制字符会被拼进请求行
+  CHECK(!HttpClient::Url::parse(f.server->url("/a\r\nX-Injected: 1")));
+  CHECK(!HttpClient::Url::parse(f.server->url("/a b")));
+  CHECK(!HttpClient::instance().get(f.server->url("/hello\r\n")).error.empty());
+  CHECK(f.server->requests() == 2);
+}
+
+void test_keep_alive_reuse() {
+  Fixture f;
+  for (int i = 0; i < 3; i++) {
+    auto response = HttpClient::instance().get(f.server->url("/hello"));
+    CHECK(response.body == "hello");
+  }
+  CHECK(f.server->requests() == 3);
+  CHECK(f.server->connections() == 1);
+}
+
+void test_redirects() {
+  Fixture f;
+  auto response = HttpClient::instance().get(f.server->url("/redirect-twice"));
+  CHECK(response.ok());
+  CHECK(response.body == "hello");
+  CHECK(response.final_url == f.server->url("/hello"));
+}
+
+void test_chunked() {
+  Fixture f;
+  auto response = HttpClient::instance().get(f.server->url("/chunked"));
+  CHECK(response.ok());
+  CHECK(response.body == kChunked);
+  // 分块响应之后连接仍可复用
+  CHECK(HttpClient::instance().get(f.server->url("/hello")).body == "hello");
+  CHECK(f.server->connections() == 1);
+}
+
+void test_download(const fs::path &dir) {
+  Fixture f;
+  const fs::path output = dir / "blob.bin";
+  uint64_t last = 0;
+  auto response = HttpClient::instance().download(
+      f.server->url("/blob"), output, {},
+      [&last](uint64_t received, uint64_t) { last = received; });
+  CHECK(response.ok());
+  CHECK(last == kBlob.size());
+  CHECK(read_file(output) == kBlob);
+
+  auto chunked = HttpClient::instance().download(
+      f.server->url("/chunked"), dir / "chunked.bin", {},
+      [](uint64_t, uint64_t) {});
+  CHECK(chunked.ok());
+  CHECK(read_file(dir / "chunked.bin") == kChunked);
+
+  // 错误状态码：不写入错误页面，已有的输出文件被删除
+  write_file(dir / "missing.bin", "stale");
+  auto missing = HttpClient::instance().download(
+      f.server->url("/missing"), dir / "missing.bin", {},
+      [](uint64_t, uint64_t) {});
+  CHECK(missing.status == 404);
+  CHECK(!fs::exists(dir / "missing.bin"));
+  // 错误页面被读完，连接仍可复用
+  CHECK(HttpClient::instance().get(f.server->url("/hello")).body == "hello");
+  CHECK(f.server->connections() == 1);
+}
+
+void test_pipelining() {
+  Fixture f;
+  std::vector<std::string> urls;
+  for (int i = 0; i < 6; i++) {
+    urls.push_back(f.server->url("/item/" + std::to_string(i)));
+  }
+  // 批量中的重定向回退为普通请求
+  urls.push_back(f.server->url("/redirect"));
+  urls.push_back("ftp://127.0.0.1/unsupported");
+
+  auto responses = HttpClient::instance().get_many(urls);
+  CHECK(responses.size() == urls.size());
+  for (int i = 0; i < 6; i++) {
+    CHECK(responses[i].ok());
+    CHECK(responses[i].body == "item " + std::to_string(i));
+  }
+  CHECK(responses[6].ok());
+  CHECK(responses[6].body == "hello");
+  CHECK(!responses[7].error.empty());
+  CHECK(f.server->connections() == 1);
+  CHECK(f.server->pipelined() > 0);
+}
+
+#ifndef SLN2CODE_HAVE_LIBCURL
+// 未链接libcurl时https交给curl命令；链接时https的路径见curl_transport_test
+
+// 假curl：记录URL，下载时写入-o指定的文件，否则输出响应头和内容
+void install_fake_curl(const fs::path &dir) {
+  const fs::path bin = dir / "bin";
+  fs::create_directories(bin);
+  write_file(bin / "curl", R"(#!/bin/sh
+out=""
+url=""
+resume=no
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -o) out="$2"; shift ;;
+    -C) resume=yes; shift ;;
+    -H|-D) shift ;;
+    -*) ;;
+    *) url="$1" ;;
+  esac
+  shift
+done
+if [ -n "$out" ]; then
+  printf 'fetched %s resume=%s' "$url" "$resume" > "$out"
+else
+  printf 'HTTP/1.1 200 OK\r\nETag: "curl"\r\n\r\nfetched %s' "$url"
+fi
+)");
+  fs::permissions(bin / "curl", fs::perms::owner_all);
+  std::string path = bin.string() + ":" + std::getenv("PATH");
+  setenv("PATH", path.c_str(), 1);
+}
+
+void test_https_falls_back_to_curl(const fs::path &dir) {
+  Fixture f;
+  install_fake_curl(dir);
+  const std::string https = "https://127.0.0.1:" +
+                            std::to_string(f.server->port()) + "/secure-file";
+
+  const fs::path output = dir / "secure.bin";
+  CHECK(SafeCommandExecutor::download_file(f.server->url("/secure"), output,
+                                           [](uint64_t, uint64_t) {}));
+  CHECK(read_file(output) == "fetched " + https + " resume=yes");
+
+  auto fetched = SafeCommandExecutor::fetch(f.server->url("/secure"));
+  CHECK(fetched.status == 200);
+  CHECK(fetched.etag == "\"curl\"");
+  CHECK(fetched.body == "fetched " + https);
+
+  // 直接的https地址不经过HttpClient
+  auto direct = SafeCommandExecutor::fetch(https);
+  CHECK(direct.body == "fetched " + https);
+
+  // http地址本身的错误不回退到curl
+  auto missing = SafeCommandExecutor::fetch(f.server->url("/missing"));
+  CHECK(missing.status == 404);
+  CHECK(missing.body == "not found");
+}
+#endif
+
+} // namespace
+
+int main() {
+  TempDir dir("sln2code-http-test");
+  test_get();
+  test_keep_alive_reuse();
+  test_redirects();
+  test_chunked();
+  test_download(dir.path());
+  test_pipelining();
+#ifndef SLN2CODE_HAVE_LIBCURL
+  test_https_falls_back_to_curl(dir.path());
+#endif
+  if (test_failures() == 0) {
+    std::cout << "http_client_test: all checks passed" << std::endl;
+  }
+  return test_failures() == 0 ? 0 : 1;
+}
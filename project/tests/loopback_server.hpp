@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+struct LoopbackRequest {
+  std::string method;
+  std::string target;
+  std::map<std::string, std::string> headers; // 键为小写
+
+  std::string header(const std::string &name) const {
+    auto it = headers.find(name);
+    return it == headers.end() ? std::string() : it->second;
+  }
+};
+
+struct LoopbackReply {
+  int status = 200;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+  bool chunked = false;
+  bool close = false;
+  // 只发送响应体的前truncate个字节后断开，模拟中断的传输
+  size_t truncate = std::string::npos;
+  // 每个连接的发送速率上限（字节/秒），0为不限速
+  uint64_t rate = 0;
+};
+
+// 测试用的本地HTTP/1.1服务器：监听127.0.0.1的随机端口，每个连接一个线程，
+// 支持keep-alive和流水线请求
+class LoopbackServer {
+public:
+  using Handler = std::function<void(const LoopbackRequest &, LoopbackReply &)>;
+
+  explicit LoopbackServer(Handler handler) : handler_(std::move(handler)) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (listen_fd_ < 0 ||
+        bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), len) != 0 ||
+        listen(listen_fd_, 16) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len) !=
+            0) {
+      std::abort();
+    }
+    port_ = ntohs(addr.sin_port);
+    acceptor_ = std::thread([this] { accept_loop(); });
+  }
+
+  ~LoopbackServer() {
+    stopping_ = true;
+    shutdown(listen_fd_, SHUT_RDWR);
+    acceptor_.join();
+    close(listen_fd_);
+    std::vector<std::thread> threads;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      for (int fd : clients_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+      threads.swap(threads_);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  LoopbackServer(const LoopbackServer &) = delete;
+  LoopbackServer &operator=(const LoopbackServer &) = delete;
+
+  unsigned port() const { return port_; }
+
+  std::string url(const std::string &target) const {
+    return "http://127.0.0.1:" + std::to_string(port_) + target;
+  }
+
+  unsigned connections() const { return connections_; }
+  unsigned requests() const { return requests_; }
+  // 解析请求时下一个请求已在缓冲区中的次数
+  unsigned pipelined() const { return pipelined_; }
+
+  // 按Range/If-Range返回content；honor_range为false时忽略Range，总是返回200
+  static void serve(const std::string &content, const LoopbackRequest &request,
+                    LoopbackReply &reply, bool honor_range = true) {
+    const std::string etag = "\"" + std::to_string(content.size()) + "\"";
+    reply.headers.push_back({"ETag", etag});
+    reply.headers.push_back({"Accept-Ranges", "bytes"});
+    std::string range = request.header("range");
+    std::string if_range = request.header("if-range");
+    if (!honor_range || range.rfind("bytes=", 0) != 0 ||
+        (!if_range.empty() && if_range != etag)) {
+      reply.status = 200;
+      reply.body = content;
+      return;
+    }
+    size_t dash = range.find('-');
+    uint64_t first = std::strtoull(range.c_str() + 6, nullptr, 10);
+    uint64_t last = dash + 1 < range.size()
+                        ? std::strtoull(range.c_str() + dash + 1, nullptr, 10)
+                        : content.size() - 1;
+    last = std::min<uint64_t>(last, content.size() - 1);
+    if (first > last) {
+      reply.status = 416;
+      reply.headers.push_back(
+          {"Content-Range", "bytes */" + std::to_string(content.size())});
+      return;
+    }
+    reply.status = 206;
+    reply.headers.push_back({"Content-Range",
+                             "bytes " + std::to_string(first) + "-" +
+                                 std::to_string(last) + "/" +
+                                 std::to_string(content.size())});
+    reply.body = content.substr(first, last - first + 1);
+  }
+
+private:
+  Handler handler_;
+  int listen_fd_ = -1;
+  unsigned port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::atomic<unsigned> connections_{0};
+  std::atomic<unsigned> requests_{0};
+  std::atomic<unsigned> pipelined_{0};
+  std::mutex mtx_;
+  std::vector<int> clients_;
+  std::vector<std::thread> threads_;
+  std::thread acceptor_;
+
+  void accept_loop() {
+    while (!stopping_) {
+      int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) {
+        if (errno == EINTR)
+          continue;
+        return;
+      }
+      connections_++;
+      std::lock_guard<std::mutex> lock(mtx_);
+      clients_.push_back(fd);
+      threads_.emplace_back([this, fd] { serve_connection(fd); });
+    }
+  }
+
+  void serve_connection(int fd) {
+    std::string buffer;
+    char chunk[16 * 1024];
+    bool open = true;
+    while (open) {
+      size_t end;
+      while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          open = false;
+          break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+      }
+      if (!open) {
+        break;
+      }
+      LoopbackRequest request = parse(buffer.substr(0, end));
+      buffer.erase(0, end + 4);
+      requests_++;
+      if (!buffer.empty()) {
+        pipelined_++;
+      }
+
+      LoopbackReply reply;
+      handler_(request, reply);
+      std::string connection = request.header("connection");
+      open = !reply.close && connection != "close" &&
+             reply.truncate == std::string::npos;
+      open = send_reply(fd, reply) && open;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      clients_.erase(std::find(clients_.begin(), clients_.end(), fd));
+    }
+    close(fd);
+  }
+
+  static LoopbackRequest parse(const std::string &head) {
+    LoopbackRequest request;
+    size_t eol = head.find("\r\n");
+    std::string line = head.substr(0, eol);
+    size_t space = line.find(' ');
+    request.method = line.substr(0, space);
+    request.target =
+        line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+    while (eol != std::string::npos) {
+      size_t start = eol + 2;
+      eol = head.find("\r\n", start);
+      line = head.substr(start, eol == std::string::npos ? std::string::npos
+                                                         : eol - start);
+      size_t colon = line.find(':');
+      if (colon == std::string::npos) {
+        continue;
+      }
+      std::string key = line.substr(0, colon);
+      std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+      std::string value = line.substr(colon + 1);
+      value.erase(0, value.find_first_not_of(" \t"));
+      request.headers[key] = value;
+    }
+    return request;
+  }
+
+  static bool send_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+      ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return false;
+      }
+      data += n;
+      size -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  // 按速率分片发送，模拟对单个连接限速的服务器
+  static bool send_throttled(int fd, const char *data, size_t size,
+                             uint64_t rate) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t slice = 16 * 1024;
+    for (size_t sent = 0; sent < size; sent += slice) {
+      if (!send_all(fd, data + sent, std::min(slice, size - sent))) {
+        return false;
+      }
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds((sent + slice) * 1000000 / rate));
+    }
+    return true;
+  }
+
+  static bool send_reply(int fd, const LoopbackReply &reply) {
+    std::string head = "HTTP/1.1 " + std::to_string(reply.status) + " " +
+                       (reply.status < 400 ? "OK" : "Error") + "\r\n";
+    for (const auto &header : reply.headers) {
+      head += header.first + ": " + header.second + "\r\n";
+    }
+    if (reply.chunked) {
+      head += "Transfer-Encoding: chunked\r\n";
+    } else {
+      head += "Content-Length: " + std::to_string(reply.body.size()) + "\r\n";
+    }
+    if (reply.close) {
+      head += "Connection: close\r\n";
+    }
+    head += "\r\n";
+    if (!send_all(fd, head.data(), head.size())) {
+      return false;
+    }
+
+    size_t size = std::min(reply.truncate, reply.body.size());
+    if (!reply.chunked) {
+      return reply.rate > 0 ? send_throttled(fd, reply.body.data(), size,
+                                             reply.rate)
+                            : send_all(fd, reply.body.data(), size);
+    }
+    // 每块最多7字节，确保跨越多个块
+    for (size_t pos = 0; pos < size; pos += 7) {
+      size_t n = std::min<size_t>(7, size - pos);
+      char length[16];
+      int len = std::snprintf(length, sizeof(length), "%zx\r\n", n);
+      if (!send_all(fd, length, static_cast<size_t>(len)) ||
+          !send_all(fd, reply.body.data() + pos, n) ||
+          !send_all(fd, "\r\n", 2)) {
+        return false;
+      }
+    }
+    if (size < reply.body.size()) {
+      return true;
+    }
+    return send_all(fd, "0\r\n\r\n", 5);
+  }
+};
@@ -0,0 +1,181 @@
+// HttpClient::download_segmented的测试：本地回环服务器按Range返回内容，
+// 验证拼接结果、单段失败后的重试、中断后的续传、服务器忽略Range时的回退，
+// 以及服务器对单个连接限速时分段下载的吞吐量
+#define main sln2code_main
+#include "main.cpp"
+#undef main
+
+#include "loopback_server.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// 超过分段阈值（8 MiB），且不是分段大小的整数倍
+const std::string kBlob = make_blob(9 * 1024 * 1024 + 12345, 3);
+
+struct RangeServer {
+  std::atomic<bool> honor_range{true};
+  std::atomic<bool> honor_segments{true}; // false：只有探测请求返回206
+  std::atomic<uint64_t> fail_from{UINT64_MAX}; // 从该偏移开始的分段被中断
+  // 第一个从该偏移之后开始的分段在响应体中途断开一次
+  std::atomic<uint64_t> fail_once_from{UINT64_MAX};
+  std::atomic<uint64_t> rate{0}; // 每个连接的速率上限
+  std::atomic<uint64_t> served{0};
+  LoopbackServer server{[this](const LoopbackRequest &request,
+                               LoopbackReply &reply) {
+    std::string range = request.header("range");
+    bool probe = range == "bytes=0-0";
+    uint64_t first =
+        range.empty() ? 0 : std::strtoull(range.c_str() + 6, nullptr, 10);
+    LoopbackServer::serve(kBlob, request, reply,
+                          honor_range && (probe || honor_segments));
+    reply.rate = rate;
+    uint64_t threshold = fail_once_from;
+    if (!probe && first >= fail_from) {
+      reply.truncate = 0;
+    } else if (!probe && first >= threshold &&
+               fail_once_from.compare_exchange_strong(threshold,
+                                                      UINT64_MAX)) {
+      reply.truncate = reply.body.size() / 2;
+      served += reply.truncate;
+    } else {
+      served += reply.body.size();
+    }
+  }};
+
+  std::string url() const { return server.url("/blob.bin"); }
+};
+
+std::string expected_sha(const fs::path &dir) {
+  write_file(dir / "expected.bin", kBlob);
+  return SHA256::hash_file(dir / "expected.bin");
+}
+
+void test_segmented(const fs::path &dir, const std::string &sha) {
+  RangeServer rs;
+  const fs::path output = dir / "segmented.bin";
+  auto response = HttpClient::instance().download_segmented(
+      rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+  CHECK(response.ok());
+  CHECK(fs::exists(output) && fs::file_size(output) == kBlob.size());
+  CHECK(SHA256::hash_file(output) == sha);
+  CHECK(!fs::exists(output.string() + ".part"));
+  CHECK(!fs::exists(output.string() + ".part.state"));
+  // 多个Range请求分布在多个连接上
+  CHECK(rs.server.requests() > 4);
+}
+
+void test_transient_segment_failure(const fs::path &dir,
+                                    const std::string &sha) {
+  RangeServer rs;
+  rs.fail_once_from = kBlob.size() / 3;
+  const fs::path output = dir / "retried.bin";
+  auto response = HttpClient::instance().download_segmented(
+      rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+  // 失败的段在同一次调用中单独重试，不需要重新运行
+  CHECK(response.ok());
+  CHECK(SHA256::hash_file(output) == sha);
+  CHECK(rs.fail_once_from == UINT64_MAX);
+  CHECK(!fs::exists(output.string() + ".part.state"));
+  // 重试从中断处继续：除探测的1字节外，每个字节只传输一次
+  CHECK(rs.served == kBlob.size() + 1);
+}
+
+void test_resume_after_interruption(const fs::path &dir,
+                                    const std::string &sha) {
+  RangeServer rs;
+  const fs::path output = dir / "resumed.bin";
+  rs.fail_from = kBlob.size() / 2;
+  auto first = HttpClient::instance().download_segmented(
+      rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+  CHECK(!first.ok());
+  CHECK(first.error.find("rerun to resume") != std::string::npos);
+  CHECK(!fs::exists(output));
+  CHECK(fs::exists(output.string() + ".part"));
+  CHECK(fs::exists(output.string() + ".part.state"));
+
+  // 第二次只下载中断的部分
+  rs.fail_from = UINT64_MAX;
+  rs.served = 0;
+  auto second = HttpClient::instance().download_segmented(
+      rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+  CHECK(second.ok());
+  CHECK(SHA256::hash_file(output) == sha);
+  CHECK(rs.served > 1);
+  CHECK(rs.served < kBlob.size() * 3 / 4);
+  CHECK(!fs::exists(output.string() + ".part.state"));
+}
+
+void test_server_ignores_range(const fs::path &dir, const std::string &sha) {
+  // 探测请求返回200：整体下载
+  {
+    RangeServer rs;
+    rs.honor_range = false;
+    const fs::path output = dir / "whole.bin";
+    auto response = HttpClient::instance().download_segmented(
+        rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+    CHECK(response.ok());
+    CHECK(SHA256::hash_file(output) == sha);
+    CHECK(!fs::exists(output.string() + ".part"));
+  }
+
+  // 探测之后的分段请求返回200：不拼接混合内容，并清理部分文件
+  {
+    RangeServer rs;
+    rs.honor_segments = false;
+    const fs::path output = dir / "changed.bin";
+    auto response = HttpClient::instance().download_segmented(
+        rs.url(), output, [](uint64_t, uint64_t) {}, 4);
+    CHECK(!response.ok());
+    CHECK(!fs::exists(output));
+    CHECK(!fs::exists(output.string() + ".part"));
+    CHECK(!fs::exists(output.string() + ".part.state"));
+  }
+}
+
+// 服务器对每个连接限速时，分段下载应明显快于单个连接
+void test_throughput_with_per_connection_limit(const fs::path &dir,
+                                               const std::string &sha) {
+  RangeServer rs;
+  rs.rate = 8 * 1024 * 1024;
+  using Clock = std::chrono::steady_clock;
+
+  auto start = Clock::now();
+  auto single = HttpClient::instance().download(
+      rs.url(), dir / "single.bin", {}, [](uint64_t, uint64_t) {});
+  const double single_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  start = Clock::now();
+  auto segmented = HttpClient::instance().download_segmented(
+      rs.url(), dir / "parallel.bin", [](uint64_t, uint64_t) {}, 4);
+  const double segmented_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  CHECK(single.ok());
+  CHECK(segmented.ok());
+  CHECK(SHA256::hash_file(dir / "single.bin") == sha);
+  CHECK(SHA256::hash_file(dir / "parallel.bin") == sha);
+  const double mib = kBlob.size() / (1024.0 * 1024.0);
+  std::cout << std::fixed << std::setprecision(1)
+            << "throughput with 8 MiB/s per connection: single stream "
+            << mib / single_seconds << " MiB/s, 4 segments "
+            << mib / segmented_seconds << " MiB/s" << std::endl;
+  CHECK(segmented_seconds < single_seconds * 0.6);
+}
+
+} // namespace
+
+int main() {
+  TempDir dir("sln2code-segmented-test");
+  const std::string sha = expected_sha(dir.path());
+  test_segmented(dir.path(), sha);
+  test_transient_segment_failure(dir.path(), sha);
+  test_resume_after_interruption(dir.path(), sha);
+  test_server_ignores_range(dir.path(), sha);
+  test_throughput_with_per_connection_limit(dir.path(), sha);
+  if (test_failures() == 0) {
+    std::cout << "segmented_download_test: all checks passed" << std::endl;
+  }
+  return test_failures() == 0 ? 0 : 1;
+}
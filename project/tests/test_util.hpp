@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+// 失败时记录位置并继续，main返回失败数
+inline int &test_failures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond     \
+                << std::endl;                                                  \
+      test_failures()++;                                                       \
+    }                                                                          \
+  } while (0)
+
+// 测试结束时删除的临时目录
+class TempDir {
+public:
+  explicit TempDir(const std::string &name)
+      : path_(std::filesystem::temp_directory_path() /
+              (name + "-" + std::to_string(getpid()))) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+
+  const std::filesystem::path &path() const { return path_; }
+
+private:
+  std::filesystem::path path_;
+};
+
+inline std::string read_file(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+inline void write_file(const std::filesystem::path &path,
+                       const std::string &content) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+// 可预测但不重复的测试数据
+inline std::string make_blob(size_t size, unsigned seed = 1) {
+  std::string blob(size, '\0');
+  uint32_t state = seed * 2654435761u + 1;
+  for (auto &c : blob) {
+    state = state * 1664525u + 1013904223u;
+    c = static_cast<char>(state >> 24);
+  }
+  return blob;
+}